@@ -0,0 +1,288 @@
+#==============================================================================
+# aakozi.py
+#
+#    Python bindings for libaakozi: the boomerang statistics in-process,
+#    on NumPy arrays.
+#
+#       import numpy as np
+#       import aakozi
+#
+#       engine = aakozi.Engine( x, y, threads=4, model='power', exponent=1.5 )
+#       results = engine.run( z, 50.0 )
+#       outliers = results[ results['pvalue'] < 0.01 ]
+#
+# notes:
+# o  The coordinates and the values are passed to the library in place,
+#    without a copy, when they are C-contiguous float64 arrays.  Other
+#    array-likes are converted first.
+#
+# o  The library is called through ctypes, which releases the GIL for the
+#    duration of each call, so other Python threads run while an engine
+#    computes.  Independent engines may run in different threads at the
+#    same time; the calls on one engine are serialized.
+#
+# o  The results are a NumPy structured array with the fields zhat, zeta,
+#    pvalue, pvalue_mc (NaN without simulations) and cnt, one record per
+#    observation.
+#
+# o  The library is found from the AAKOZI_LIBRARY environment variable,
+#    then next to this file, then on the system library path.
+#
+# author:
+#    Dr. Randal J. Barnes
+#    Department of Civil, Environmental, and Geo- Engineering
+#    University of Minnesota
+#
+# version:
+#    11 June 2017
+#==============================================================================
+import ctypes
+import ctypes.util
+import os
+import threading
+
+import numpy as np
+
+__all__ = [ 'Engine', 'boomerang', 'AakoziError', 'RESULT_DTYPE' ]
+
+# Manifest constants.
+ABI_VERSION = 1
+
+RESULT_DTYPE = np.dtype( [
+   ( 'zhat',      np.float64 ),
+   ( 'zeta',      np.float64 ),
+   ( 'pvalue',    np.float64 ),
+   ( 'pvalue_mc', np.float64 ),
+   ( 'cnt',       np.int32   ) ] )
+
+MODELS     = { 'linear': 0, 'power': 1, 'exponential': 2, 'spherical': 3, 'gaussian': 4 }
+GRIDS      = { 'off': 0, 'auto': 1, 'on': 2 }
+DUPLICATES = { 'average': 0, 'first': 1, 'group': 2 }
+
+# The options that shape the prepared geometry.
+GEOMETRIC  = ( 'angle', 'ratio', 'vertical', 'geographic', 'grid', 'single', 'duplicates', 'tolerance' )
+
+
+class AakoziError( RuntimeError ):
+   """An error status returned by libaakozi."""
+
+
+#------------------------------------------------------------------------------
+# Load
+#
+#    Load the library, and declare the C functions.
+#------------------------------------------------------------------------------
+def _Load():
+   names = []
+   if os.environ.get( 'AAKOZI_LIBRARY' ):
+      names.append( os.environ[ 'AAKOZI_LIBRARY' ] )
+
+   here = os.path.dirname( os.path.abspath( __file__ ) )
+   for name in ( 'libaakozi.so', 'libaakozi.dylib', 'aakozi.dll', 'libaakozi.dll' ):
+      names.append( os.path.join( here, name ) )
+
+   found = ctypes.util.find_library( 'aakozi' )
+   if found:
+      names.append( found )
+
+   lib = None
+   for name in names:
+      try:
+         lib = ctypes.CDLL( name )
+         break
+      except OSError:
+         continue
+   if lib is None:
+      raise ImportError( 'could not load libaakozi; set AAKOZI_LIBRARY to its path' )
+
+   c_int, c_double, c_uint64 = ctypes.c_int, ctypes.c_double, ctypes.c_uint64
+   p_double = ctypes.POINTER( c_double )
+   p_int    = ctypes.POINTER( c_int )
+   handle   = ctypes.c_void_p
+
+   signatures = {
+      'aakozi_abi_version':          ( c_int, [] ),
+      'aakozi_status_message':       ( ctypes.c_char_p, [ c_int ] ),
+      'aakozi_create':               ( handle, [] ),
+      'aakozi_destroy':              ( None, [ handle ] ),
+      'aakozi_set_threads':          ( c_int, [ handle, c_int ] ),
+      'aakozi_set_model':            ( c_int, [ handle, c_int, c_double, c_double, c_double ] ),
+      'aakozi_set_anisotropy':       ( c_int, [ handle, c_double, c_double, c_double ] ),
+      'aakozi_set_geographic':       ( c_int, [ handle, c_int ] ),
+      'aakozi_set_grid':             ( c_int, [ handle, c_int ] ),
+      'aakozi_set_single_precision': ( c_int, [ handle, c_int ] ),
+      'aakozi_set_duplicates':       ( c_int, [ handle, c_int, c_double ] ),
+      'aakozi_set_simulations':      ( c_int, [ handle, c_int, c_uint64 ] ),
+      'aakozi_prepare':              ( c_int, [ handle, p_double, p_double, p_double, c_int ] ),
+      'aakozi_size':                 ( c_int, [ handle ] ),
+      'aakozi_run':                  ( c_int, [ handle, p_double, c_double, p_double, p_double, p_double, p_double, p_int ] ),
+   }
+   for name, ( restype, argtypes ) in signatures.items():
+      function = getattr( lib, name )
+      function.restype  = restype
+      function.argtypes = argtypes
+
+   if lib.aakozi_abi_version() != ABI_VERSION:
+      raise ImportError( 'libaakozi has ABI version %d; expected %d' % ( lib.aakozi_abi_version(), ABI_VERSION ) )
+   return lib
+
+_lib = _Load()
+
+
+#------------------------------------------------------------------------------
+# Helpers
+#------------------------------------------------------------------------------
+def _Check( status ):
+   if status != 0:
+      raise AakoziError( _lib.aakozi_status_message( status ).decode() )
+
+def _Doubles( a, name, n=None ):
+   """A C-contiguous float64 view of a, without a copy if it is one already."""
+   a = np.ascontiguousarray( a, dtype=np.float64 )
+   if a.ndim != 1:
+      raise ValueError( '%s must be one-dimensional' % name )
+   if n is not None and a.shape[0] != n:
+      raise ValueError( '%s has %d entries; expected %d' % ( name, a.shape[0], n ) )
+   return a
+
+def _Pointer( a, ctype=ctypes.c_double ):
+   return None if a is None else a.ctypes.data_as( ctypes.POINTER( ctype ) )
+
+def _Choice( table, value, name ):
+   try:
+      return table[ value ]
+   except KeyError:
+      raise ValueError( '%s must be one of %s' % ( name, ', '.join( sorted( table ) ) ) )
+
+
+#==============================================================================
+# Engine
+#
+#    The engine prepared for one set of locations, to be run for any number
+#    of sets of values at them, at any radius.
+#
+# Arguments:
+#
+#    x, y          the coordinates; longitude and latitude in degrees if
+#                  geographic.
+#
+#    elev          the elevations of 3-D data, or None.
+#
+#    threads       the number of threads; 0 means all of them.
+#
+#    model         'linear', 'power', 'exponential', 'spherical' or
+#                  'gaussian', with its range, exponent and nugget.
+#
+#    angle, ratio, vertical
+#                  the anisotropy.
+#
+#    geographic    great-circle distances in kilometers.
+#
+#    grid          'off', or 'auto' (the same as 'on'): the FFT solver if the
+#                  data are gridded.
+#
+#    single        single precision coordinates and distances.
+#
+#    duplicates    'average', 'first' or 'group', with the tolerance: a
+#                  separation distance, with the anisotropy, or in
+#                  kilometers for geographic coordinates.
+#
+#    simulations   the simulated null realizations for pvalue_mc, and the
+#                  seed.
+#
+# The options may be changed with set_options, but the geometric ones
+# (angle, ratio, vertical, geographic, grid, single, duplicates, tolerance)
+# are fixed when the engine is prepared, in the constructor; set_options
+# raises ValueError on them afterwards.  Make a new Engine instead.
+#==============================================================================
+class Engine( object ):
+
+   def __init__( self, x, y, elev=None, **options ):
+      x = _Doubles( x, 'x' )
+      y = _Doubles( y, 'y', x.shape[0] )
+      elev = None if elev is None else _Doubles( elev, 'elev', x.shape[0] )
+
+      self._lock = threading.Lock()
+      self._prepared = False
+      self._handle = _lib.aakozi_create()
+      if not self._handle:
+         raise MemoryError( 'could not create the engine' )
+
+      self._options = dict( threads=0, model='linear', range=0.0, exponent=1.0, nugget=0.0,
+                            angle=0.0, ratio=1.0, vertical=1.0, geographic=False, grid='off',
+                            single=False, duplicates='average', tolerance=0.0,
+                            simulations=0, seed=20170611 )
+      self.set_options( **options )
+
+      with self._lock:
+         _Check( _lib.aakozi_prepare( self._handle, _Pointer( x ), _Pointer( y ), _Pointer( elev ), x.shape[0] ) )
+      self._prepared = True
+      self.size = x.shape[0]
+
+   def set_options( self, **options ):
+      unknown = set( options ) - set( self._options )
+      if unknown:
+         raise TypeError( 'unknown options: %s' % ', '.join( sorted( unknown ) ) )
+
+      fixed = set( options ) & set( GEOMETRIC ) if self._prepared else set()
+      if fixed:
+         raise ValueError( 'the engine is prepared; %s cannot be changed' % ', '.join( sorted( fixed ) ) )
+
+      o = dict( self._options, **options )
+      h = self._handle
+      with self._lock:
+         _Check( _lib.aakozi_set_threads( h, int( o['threads'] ) ) )
+         _Check( _lib.aakozi_set_model( h, _Choice( MODELS, o['model'], 'model' ), o['range'], o['exponent'], o['nugget'] ) )
+         _Check( _lib.aakozi_set_anisotropy( h, o['angle'], o['ratio'], o['vertical'] ) )
+         _Check( _lib.aakozi_set_geographic( h, int( bool( o['geographic'] ) ) ) )
+         _Check( _lib.aakozi_set_grid( h, _Choice( GRIDS, o['grid'], 'grid' ) ) )
+         _Check( _lib.aakozi_set_single_precision( h, int( bool( o['single'] ) ) ) )
+         _Check( _lib.aakozi_set_duplicates( h, _Choice( DUPLICATES, o['duplicates'], 'duplicates' ), o['tolerance'] ) )
+         _Check( _lib.aakozi_set_simulations( h, int( o['simulations'] ), int( o['seed'] ) ) )
+      self._options = o
+
+   def run( self, z, radius ):
+      """The boomerang statistics of the values z, as a RESULT_DTYPE array."""
+      z = _Doubles( z, 'z', self.size )
+
+      columns = { name: np.empty( self.size, dtype=RESULT_DTYPE[ name ] ) for name in RESULT_DTYPE.names }
+      with self._lock:
+         if not self._handle:
+            raise ValueError( 'the engine is closed' )
+         _Check( _lib.aakozi_run( self._handle, _Pointer( z ), float( radius ),
+                                  _Pointer( columns['zhat'] ), _Pointer( columns['zeta'] ),
+                                  _Pointer( columns['pvalue'] ), _Pointer( columns['pvalue_mc'] ),
+                                  _Pointer( columns['cnt'], ctypes.c_int ) ) )
+
+      results = np.empty( self.size, dtype=RESULT_DTYPE )
+      for name in RESULT_DTYPE.names:
+         results[ name ] = columns[ name ]
+      return results
+
+   def close( self ):
+      with self._lock:
+         if self._handle:
+            _lib.aakozi_destroy( self._handle )
+            self._handle = None
+
+   def __enter__( self ):
+      return self
+
+   def __exit__( self, *exc ):
+      self.close()
+
+   def __del__( self ):
+      if getattr( self, '_handle', None ):
+         _lib.aakozi_destroy( self._handle )
+         self._handle = None
+
+
+#------------------------------------------------------------------------------
+# boomerang
+#
+#    The boomerang statistics of one set of values, as Engine() computes
+#    them; the options are those of Engine.
+#------------------------------------------------------------------------------
+def boomerang( x, y, z, radius, elev=None, **options ):
+   with Engine( x, y, elev, **options ) as engine:
+      return engine.run( z, radius )
@@ -0,0 +1,101 @@
+#==============================================================================
+# test_aakozi.py
+#
+#    A smoke test of the Python bindings: Engine.run must give what the C
+#    interface gives, called directly, on the data of test/test_aakozi.cpp.
+#    The tests are skipped if libaakozi (or NumPy) is not available.
+#
+#       AAKOZI_LIBRARY=/path/to/libaakozi.so python -m unittest test_aakozi
+#
+# author:
+#    Dr. Randal J. Barnes
+#    Department of Civil, Environmental, and Geo- Engineering
+#    University of Minnesota
+#
+# version:
+#    11 June 2017
+#==============================================================================
+import ctypes
+import math
+import unittest
+
+try:
+   import numpy as np
+   import aakozi
+except ImportError:
+   aakozi = None
+
+
+#------------------------------------------------------------------------------
+# Data
+#
+#    TestData( 60, seed ) of test/test_data.cpp.
+#------------------------------------------------------------------------------
+def Data( n=60, seed=0 ):
+   x, y, z = [], [], []
+   for i in range( n ):
+      x.append( 100.0*math.sin( 1.3*i + seed ) + 3.0*i )
+      y.append( 100.0*math.cos( 2.1*i - seed ) - 2.0*i )
+      z.append( 50.0 + 0.1*x[-1] + 5.0*math.sin( 0.7*i + seed ) )
+   return np.array( x ), np.array( y ), np.array( z )
+
+
+#------------------------------------------------------------------------------
+# RunC
+#
+#    The results of the C interface called directly, with two threads.
+#------------------------------------------------------------------------------
+def RunC( x, y, z, radius, model=None ):
+   lib = aakozi._lib
+   n = x.shape[0]
+   columns = { name: np.empty( n, dtype=aakozi.RESULT_DTYPE[ name ] ) for name in aakozi.RESULT_DTYPE.names }
+
+   handle = lib.aakozi_create()
+   try:
+      aakozi._Check( lib.aakozi_set_threads( handle, 2 ) )
+      if model is not None:
+         aakozi._Check( lib.aakozi_set_model( handle, *model ) )
+      aakozi._Check( lib.aakozi_prepare( handle, aakozi._Pointer( x ), aakozi._Pointer( y ), None, n ) )
+      aakozi._Check( lib.aakozi_run( handle, aakozi._Pointer( z ), radius,
+                                     aakozi._Pointer( columns['zhat'] ), aakozi._Pointer( columns['zeta'] ),
+                                     aakozi._Pointer( columns['pvalue'] ), aakozi._Pointer( columns['pvalue_mc'] ),
+                                     aakozi._Pointer( columns['cnt'], ctypes.c_int ) ) )
+   finally:
+      lib.aakozi_destroy( handle )
+   return columns
+
+
+@unittest.skipIf( aakozi is None, 'libaakozi is not built' )
+class TestEngine( unittest.TestCase ):
+
+   def assertSame( self, results, columns ):
+      for name in ( 'zhat', 'zeta', 'pvalue', 'cnt' ):
+         self.assertTrue( np.array_equal( results[ name ], columns[ name ] ), name )
+      self.assertTrue( np.all( np.isnan( results['pvalue_mc'] ) ) )
+
+   def test_run( self ):
+      x, y, z = Data()
+      with aakozi.Engine( x, y, threads=2 ) as engine:
+         for radius in ( 30.0, 60.0 ):
+            self.assertSame( engine.run( z, radius ), RunC( x, y, z, radius ) )
+
+         engine.set_options( model='spherical', range=150.0, nugget=0.1 )
+         spherical = ( aakozi.MODELS['spherical'], 150.0, 1.0, 0.1 )
+         self.assertSame( engine.run( z, 40.0 ), RunC( x, y, z, 40.0, spherical ) )
+
+   def test_boomerang( self ):
+      x, y, z = Data( seed=1 )
+      self.assertSame( aakozi.boomerang( x, y, z, 30.0, threads=2 ), RunC( x, y, z, 30.0 ) )
+
+   def test_geometric_options( self ):
+      x, y, z = Data()
+      with aakozi.Engine( x, y, ratio=0.5 ) as engine:
+         for option in aakozi.GEOMETRIC:
+            with self.assertRaises( ValueError ):
+               engine.set_options( **{ option: engine._options[ option ] } )
+         engine.set_options( threads=1, simulations=10 )
+         self.assertEqual( engine.run( z, 30.0 ).shape, ( 60, ) )
+
+
+if __name__ == '__main__':
+   unittest.main()
@@ -0,0 +1,256 @@
+//=============================================================================
+// aakozi.cpp
+//
+//    The C interface of libaakozi, over BoomerangEngine.
+//
+// notes:
+// o  No C++ exception crosses the interface; each is turned into a status.
+//
+// o  The engine has no shared state beyond the thread pool, which is
+//    synchronized, so independent engines may run at the same time.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "aakozi.h"
+#include "engine.h"
+#include "variogram_models.h"
+
+#include <exception>
+#include <new>
+#include <vector>
+
+//=============================================================================
+// aakozi_engine
+//=============================================================================
+struct aakozi_engine
+{
+   BoomerangEngine engine;
+   EngineOptions   options;
+
+   int             model    = AAKOZI_MODEL_LINEAR;
+   double          range    = 0.0;
+   double          exponent = 1.0;
+   double          nugget   = 0.0;
+};
+
+namespace{
+   //--------------------------------------------------------------------------
+   // Run
+   //
+   //    Run the prepared engine with its variogram model.
+   //--------------------------------------------------------------------------
+   std::vector<Boomerang> Run( const aakozi_engine& e, const double* z, double radius )
+   {
+      switch( e.model )
+      {
+      case AAKOZI_MODEL_POWER:
+         return e.engine.Run( z, radius, e.options, PowerVariogram( e.exponent, e.nugget ) );
+      case AAKOZI_MODEL_EXPONENTIAL:
+         return e.engine.Run( z, radius, e.options, ExponentialVariogram( e.range, e.nugget ) );
+      case AAKOZI_MODEL_SPHERICAL:
+         return e.engine.Run( z, radius, e.options, SphericalVariogram( e.range, e.nugget ) );
+      case AAKOZI_MODEL_GAUSSIAN:
+         return e.engine.Run( z, radius, e.options, GaussianVariogram( e.range, e.nugget ) );
+      default:
+         return e.engine.Run( z, radius, e.options, LinearVariogram( e.nugget ) );
+      }
+   }
+}
+
+//=============================================================================
+// Informational
+//=============================================================================
+int aakozi_abi_version( void )
+{
+   return AAKOZI_ABI_VERSION;
+}
+
+const char* aakozi_status_message( int status )
+{
+   switch( status )
+   {
+      case AAKOZI_OK:                  return "ok";
+      case AAKOZI_INVALID_ARGUMENT:    return "invalid argument";
+      case AAKOZI_NOT_PREPARED:        return "the engine is not prepared";
+      case AAKOZI_OUT_OF_MEMORY:       return "out of memory";
+      case AAKOZI_FAILURE:             return "failure";
+   }
+   return "unknown status";
+}
+
+//=============================================================================
+// Creation and destruction
+//=============================================================================
+aakozi_engine* aakozi_create( void )
+{
+   return new (std::nothrow) aakozi_engine;
+}
+
+void aakozi_destroy( aakozi_engine* engine )
+{
+   delete engine;
+}
+
+//=============================================================================
+// Options
+//=============================================================================
+int aakozi_set_threads( aakozi_engine* engine, int threads )
+{
+   if( engine == nullptr || threads < 0 )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.threads = threads;
+   return AAKOZI_OK;
+}
+
+int aakozi_set_model( aakozi_engine* engine, int model, double range, double exponent, double nugget )
+{
+   if( engine == nullptr || model < AAKOZI_MODEL_LINEAR || model > AAKOZI_MODEL_GAUSSIAN || !( nugget >= 0 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+   if( model == AAKOZI_MODEL_POWER && !( exponent > 0 && exponent < 2 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+   if( model >= AAKOZI_MODEL_EXPONENTIAL && !( range > 0 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->model    = model;
+   engine->range    = range;
+   engine->exponent = exponent;
+   engine->nugget   = nugget;
+   return AAKOZI_OK;
+}
+
+int aakozi_set_anisotropy( aakozi_engine* engine, double angle, double ratio, double vertical )
+{
+   if( engine == nullptr || !( ratio > 0 && ratio <= 1 ) || !( vertical > 0 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.anisotropy.angle    = angle;
+   engine->options.anisotropy.ratio    = ratio;
+   engine->options.anisotropy.vertical = vertical;
+   return AAKOZI_OK;
+}
+
+int aakozi_set_geographic( aakozi_engine* engine, int geographic )
+{
+   if( engine == nullptr )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.geographic = ( geographic != 0 );
+   return AAKOZI_OK;
+}
+
+int aakozi_set_grid( aakozi_engine* engine, int grid )
+{
+   if( engine == nullptr || grid < AAKOZI_GRID_OFF || grid > AAKOZI_GRID_ON )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.grid_mode = ( grid == AAKOZI_GRID_OFF ? GRID_OFF : GRID_ON );
+   return AAKOZI_OK;
+}
+
+int aakozi_set_single_precision( aakozi_engine* engine, int single_precision )
+{
+   if( engine == nullptr )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.single_precision = ( single_precision != 0 );
+   return AAKOZI_OK;
+}
+
+int aakozi_set_duplicates( aakozi_engine* engine, int policy, double tolerance )
+{
+   if( engine == nullptr || policy < AAKOZI_DUPLICATES_AVERAGE || policy > AAKOZI_DUPLICATES_GROUP || !( tolerance >= 0 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.duplicates = ( policy == AAKOZI_DUPLICATES_GROUP ? DUPLICATES_GROUP : policy == AAKOZI_DUPLICATES_FIRST ? DUPLICATES_FIRST : DUPLICATES_AVERAGE );
+   engine->options.duplicate_tolerance = tolerance;
+   return AAKOZI_OK;
+}
+
+int aakozi_set_simulations( aakozi_engine* engine, int simulations, uint64_t seed )
+{
+   if( engine == nullptr || simulations < 0 )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   engine->options.simulations = simulations;
+   engine->options.seed        = seed;
+   return AAKOZI_OK;
+}
+
+//=============================================================================
+// aakozi_prepare
+//=============================================================================
+int aakozi_prepare( aakozi_engine* engine, const double* x, const double* y, const double* elev, int n )
+{
+   if( engine == nullptr || x == nullptr || y == nullptr || n < 2 )
+      return AAKOZI_INVALID_ARGUMENT;
+   if( elev != nullptr && engine->options.geographic )
+      return AAKOZI_INVALID_ARGUMENT;
+
+   try
+   {
+      engine->engine.Prepare( x, y, elev, n, engine->options );
+   }
+   catch( const std::bad_alloc& )
+   {
+      return AAKOZI_OUT_OF_MEMORY;
+   }
+   catch( ... )
+   {
+      return AAKOZI_FAILURE;
+   }
+   return AAKOZI_OK;
+}
+
+int aakozi_size( const aakozi_engine* engine )
+{
+   return ( engine != nullptr ? engine->engine.size() : 0 );
+}
+
+//=============================================================================
+// aakozi_run
+//=============================================================================
+int aakozi_run(
+   aakozi_engine* engine,
+   const double* z,
+   double radius,
+   double* zhat,
+   double* zeta,
+   double* pvalue,
+   double* pvalue_mc,
+   int* cnt )
+{
+   if( engine == nullptr || z == nullptr || !( radius > 0 ) )
+      return AAKOZI_INVALID_ARGUMENT;
+   if( !engine->engine.IsPrepared() )
+      return AAKOZI_NOT_PREPARED;
+
+   try
+   {
+      std::vector<Boomerang> results = Run( *engine, z, radius );
+
+      for( size_t i=0; i<results.size(); ++i )
+      {
+         if( zhat != nullptr )      zhat[i]      = results[i].zhat;
+         if( zeta != nullptr )      zeta[i]      = results[i].zeta;
+         if( pvalue != nullptr )    pvalue[i]    = results[i].pvalue;
+         if( pvalue_mc != nullptr ) pvalue_mc[i] = results[i].pvalue_mc;
+         if( cnt != nullptr )       cnt[i]       = results[i].cnt;
+      }
+   }
+   catch( const std::bad_alloc& )
+   {
+      return AAKOZI_OUT_OF_MEMORY;
+   }
+   catch( ... )
+   {
+      return AAKOZI_FAILURE;
+   }
+   return AAKOZI_OK;
+}
@@ -0,0 +1,146 @@
+//=============================================================================
+// aakozi.h
+//
+//    The C interface of libaakozi: the boomerang statistics in-process,
+//    for C, and for any language that can call C.
+//
+// notes:
+// o  An engine is prepared once for a set of locations, and then run for
+//    any number of sets of values at them, at any radius.
+//
+// o  The caller's arrays are read in place, and are not kept: they need
+//    only outlive the call they are passed to.  The results are written to
+//    arrays of n supplied by the caller; any of them may be NULL.
+//
+// o  Independent engines may be used from different threads at the same
+//    time.  One engine must be used from one thread at a time.
+//
+// o  The options are set on the engine, as int and double arguments, so
+//    that new options do not change the existing functions.  The
+//    geometric options (grid, single precision, anisotropy, geographic,
+//    duplicate tolerance) take effect at the next aakozi_prepare.
+//
+// o  Warnings are written to the standard error stream.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef AAKOZI_H
+#define AAKOZI_H
+
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(AAKOZI_BUILD)
+#define AAKOZI_API __declspec(dllexport)
+#elif defined(__GNUC__) && defined(AAKOZI_BUILD)
+#define AAKOZI_API __attribute__((visibility("default")))
+#else
+#define AAKOZI_API
+#endif
+
+// Incremented only when an existing function changes.
+#define AAKOZI_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//=============================================================================
+// Constants
+//=============================================================================
+enum
+{
+   AAKOZI_OK               = 0,
+   AAKOZI_INVALID_ARGUMENT = 1,
+   AAKOZI_NOT_PREPARED     = 2,
+   AAKOZI_OUT_OF_MEMORY    = 3,
+   AAKOZI_FAILURE          = 4
+};
+
+enum
+{
+   AAKOZI_MODEL_LINEAR      = 0,
+   AAKOZI_MODEL_POWER       = 1,
+   AAKOZI_MODEL_EXPONENTIAL = 2,
+   AAKOZI_MODEL_SPHERICAL   = 3,
+   AAKOZI_MODEL_GAUSSIAN    = 4
+};
+
+// The FFT solver is used if the locations are gridded; AAKOZI_GRID_AUTO
+// and AAKOZI_GRID_ON are the same.
+enum
+{
+   AAKOZI_GRID_OFF  = 0,
+   AAKOZI_GRID_AUTO = 1,
+   AAKOZI_GRID_ON   = 2
+};
+
+enum
+{
+   AAKOZI_DUPLICATES_AVERAGE = 0,
+   AAKOZI_DUPLICATES_FIRST   = 1,
+   AAKOZI_DUPLICATES_GROUP   = 2
+};
+
+typedef struct aakozi_engine aakozi_engine;
+
+//=============================================================================
+// Functions
+//
+//    Except for aakozi_create, aakozi_destroy, aakozi_size and the two
+//    informational functions, each returns AAKOZI_OK or an error code.
+//=============================================================================
+AAKOZI_API int aakozi_abi_version( void );
+AAKOZI_API const char* aakozi_status_message( int status );
+
+// NULL if out of memory.  aakozi_destroy( NULL ) does nothing.
+AAKOZI_API aakozi_engine* aakozi_create( void );
+AAKOZI_API void aakozi_destroy( aakozi_engine* engine );
+
+// 0 (the default) means all of the hardware threads.
+AAKOZI_API int aakozi_set_threads( aakozi_engine* engine, int threads );
+
+// The range is required by the bounded models; 0 < exponent < 2 for the
+// power model.  The nugget is relative to the slope or partial sill.
+AAKOZI_API int aakozi_set_model( aakozi_engine* engine, int model, double range, double exponent, double nugget );
+
+AAKOZI_API int aakozi_set_anisotropy( aakozi_engine* engine, double angle, double ratio, double vertical );
+AAKOZI_API int aakozi_set_geographic( aakozi_engine* engine, int geographic );
+AAKOZI_API int aakozi_set_grid( aakozi_engine* engine, int grid );
+AAKOZI_API int aakozi_set_single_precision( aakozi_engine* engine, int single_precision );
+
+// The tolerance is a separation distance, with the anisotropy, or in
+// kilometers for geographic coordinates.
+AAKOZI_API int aakozi_set_duplicates( aakozi_engine* engine, int policy, double tolerance );
+
+AAKOZI_API int aakozi_set_simulations( aakozi_engine* engine, int simulations, uint64_t seed );
+
+// The n >= 2 locations; elev is NULL for 2-D data.
+AAKOZI_API int aakozi_prepare( aakozi_engine* engine, const double* x, const double* y, const double* elev, int n );
+
+// The number of prepared locations, or 0.
+AAKOZI_API int aakozi_size( const aakozi_engine* engine );
+
+// The boomerang statistics of the n values z at the prepared locations.
+// pvalue_mc is NaN without simulations.
+AAKOZI_API int aakozi_run(
+   aakozi_engine* engine,
+   const double* z,
+   double radius,
+   double* zhat,
+   double* zeta,
+   double* pvalue,
+   double* pvalue_mc,
+   int* cnt );
+
+#ifdef __cplusplus
+}
+#endif
+
+//=============================================================================
+#endif  // AAKOZI_H
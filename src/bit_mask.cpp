@@ -0,0 +1,139 @@
+//=============================================================================
+// bit_mask.cpp
+//
+//    Packed active-set flags, generated from a row of separation distances
+//    by a vectorized compare against the buffer radius.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "bit_mask.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BIT_MASK_SSE2
+#endif
+
+//-----------------------------------------------------------------------------
+// Resize
+//
+//    Resize to n flags, all set to value.
+//-----------------------------------------------------------------------------
+void BitMask::Resize( int n, bool value )
+{
+   assert( n >= 0 );
+
+   m_n = n;
+   m_words.assign( (n + 63) >> 6, value ? ~uint64_t(0) : uint64_t(0) );
+
+   if( value && (n & 63) != 0 )
+      m_words.back() = ( uint64_t(1) << (n & 63) ) - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Count
+//
+//    The number of set flags.
+//-----------------------------------------------------------------------------
+int BitMask::Count() const
+{
+   int count = 0;
+   for( uint64_t w : m_words )
+      count += PopCount( w );
+   return count;
+}
+
+//-----------------------------------------------------------------------------
+// Indices
+//
+//    The indices of the set flags, in increasing order.
+//-----------------------------------------------------------------------------
+void BitMask::Indices( std::vector<int>& index ) const
+{
+   index.clear();
+   index.reserve( Count() );
+   ForEach( [&index]( int i ){ index.push_back(i); } );
+}
+
+//=============================================================================
+// GreaterThan
+//
+//    Set mask[j] = ( d[j] > radius ) for j = 0, 1, ..., n-1, resizing the
+//    mask to n.
+//
+// Notes:
+//
+// o  Two doubles are compared at a time, and the sign bits of the result
+//    are gathered by movemask into the word being filled.  A NaN compares
+//    false, as in the scalar loop.
+//
+// o  The float distances are widened to double before the compare, so the
+//    flags are exactly those of ( double(d[j]) > radius ).
+//=============================================================================
+void GreaterThan( const double* d, int n, double radius, BitMask& mask )
+{
+   mask.Resize( n );
+   uint64_t* words = mask.Words();
+
+   for( int k=0; k<mask.nWords(); ++k )
+   {
+      const double* dk = d + (k << 6);
+      const int m = std::min( 64, n - (k << 6) );
+
+      uint64_t w = 0;
+      int j = 0;
+#if defined(BIT_MASK_SSE2)
+      const __m128d r = _mm_set1_pd( radius );
+      for( ; j+2 <= m; j += 2 )
+      {
+         int bits = _mm_movemask_pd( _mm_cmpgt_pd( _mm_loadu_pd( dk+j ), r ) );
+         w |= uint64_t(bits) << j;
+      }
+#endif
+      for( ; j<m; ++j )
+      {
+         if( dk[j] > radius )
+            w |= uint64_t(1) << j;
+      }
+      words[k] = w;
+   }
+}
+
+void GreaterThan( const float* d, int n, double radius, BitMask& mask )
+{
+   mask.Resize( n );
+   uint64_t* words = mask.Words();
+
+   for( int k=0; k<mask.nWords(); ++k )
+   {
+      const float* dk = d + (k << 6);
+      const int m = std::min( 64, n - (k << 6) );
+
+      uint64_t w = 0;
+      int j = 0;
+#if defined(BIT_MASK_SSE2)
+      const __m128d r = _mm_set1_pd( radius );
+      for( ; j+4 <= m; j += 4 )
+      {
+         __m128  f  = _mm_loadu_ps( dk+j );
+         __m128d lo = _mm_cvtps_pd( f );
+         __m128d hi = _mm_cvtps_pd( _mm_movehl_ps( f, f ) );
+         int bits = _mm_movemask_pd( _mm_cmpgt_pd( lo, r ) ) | ( _mm_movemask_pd( _mm_cmpgt_pd( hi, r ) ) << 2 );
+         w |= uint64_t(bits) << j;
+      }
+#endif
+      for( ; j<m; ++j )
+      {
+         if( double(dk[j]) > radius )
+            w |= uint64_t(1) << j;
+      }
+      words[k] = w;
+   }
+}
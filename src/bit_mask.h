@@ -0,0 +1,124 @@
+//=============================================================================
+// bit_mask.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef BIT_MASK_H
+#define BIT_MASK_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//=============================================================================
+// BitMask
+//
+//    A set of flags packed 64 to a word, for the active sets.  The unused
+//    bits of the last word are always zero, so Count is a popcount of the
+//    words, and ForEach visits the set bits, in order, one word at a time.
+//=============================================================================
+class BitMask
+{
+public:
+   BitMask() : m_n(0), m_words() {}
+   explicit BitMask( int n, bool value = false ) : m_n(0), m_words() { Resize( n, value ); }
+
+   void Resize( int n, bool value = false );
+
+   int  size() const                   { return m_n; }
+   int  nWords() const                 { return int( m_words.size() ); }
+
+   bool operator[]( int i ) const      { return ( m_words[i >> 6] >> (i & 63) ) & 1; }
+   void Set( int i )                   { m_words[i >> 6] |=  ( uint64_t(1) << (i & 63) ); }
+   void Clear( int i )                 { m_words[i >> 6] &= ~( uint64_t(1) << (i & 63) ); }
+
+   const uint64_t* Words() const       { return m_words.data(); }
+   uint64_t*       Words()             { return m_words.data(); }
+
+   int  Count() const;
+
+   template<class Function>
+   void ForEach( Function f ) const;
+
+   void Indices( std::vector<int>& index ) const;
+
+   static int PopCount( uint64_t w );
+   static int LowestBit( uint64_t w );
+
+private:
+   int                   m_n;
+   std::vector<uint64_t> m_words;
+};
+
+//-----------------------------------------------------------------------------
+// PopCount, LowestBit
+//
+//    The number of set bits, and the index of the lowest set bit (w != 0).
+//-----------------------------------------------------------------------------
+inline int BitMask::PopCount( uint64_t w )
+{
+#if defined(__GNUC__) || defined(__clang__)
+   return __builtin_popcountll( w );
+#elif defined(_MSC_VER) && defined(_M_X64)
+   return int( __popcnt64( w ) );
+#else
+   int n = 0;
+   for( ; w != 0; w &= w-1 )
+      ++n;
+   return n;
+#endif
+}
+
+inline int BitMask::LowestBit( uint64_t w )
+{
+   assert( w != 0 );
+#if defined(__GNUC__) || defined(__clang__)
+   return __builtin_ctzll( w );
+#elif defined(_MSC_VER) && defined(_M_X64)
+   unsigned long b;
+   _BitScanForward64( &b, w );
+   return int( b );
+#else
+   int b = 0;
+   while( !( w & 1 ) )
+   {
+      w >>= 1;
+      ++b;
+   }
+   return b;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// ForEach
+//
+//    Call f(i) for each set bit i, in increasing order.
+//-----------------------------------------------------------------------------
+template<class Function>
+void BitMask::ForEach( Function f ) const
+{
+   const int W = nWords();
+   for( int k=0; k<W; ++k )
+   {
+      for( uint64_t w = m_words[k]; w != 0; w &= w-1 )
+         f( (k << 6) + LowestBit(w) );
+   }
+}
+
+//=============================================================================
+void GreaterThan( const double* d, int n, double radius, BitMask& mask );
+void GreaterThan( const float*  d, int n, double radius, BitMask& mask );
+
+
+//=============================================================================
+#endif  // BIT_MASK_H
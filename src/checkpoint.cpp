@@ -0,0 +1,322 @@
+//=============================================================================
+// checkpoint.cpp
+//
+//    Saving and restoring the finished kriging systems of an Engine run.
+//
+//    The file is binary, in the byte order of the machine that wrote it:
+//
+//       "AAKOZICK"    8 bytes
+//       version       uint32
+//       hash          uint64
+//       N, P, count   int32 x 3
+//
+//    followed by count records of
+//
+//       k, cnt        int32 x 2
+//       tau           double
+//       zhat          double x P
+//       xi            double x P
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "checkpoint.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace{
+   // Manifest constants.
+   const char     MAGIC[8] = { 'A', 'A', 'K', 'O', 'Z', 'I', 'C', 'K' };
+   const uint32_t VERSION  = 1;
+   const uint64_t FNV_PRIME = 1099511628211ULL;
+
+   //--------------------------------------------------------------------------
+   // Now
+   //
+   //    Seconds on the steady clock.
+   //--------------------------------------------------------------------------
+   double Now()
+   {
+      std::chrono::duration<double> t = std::chrono::steady_clock::now().time_since_epoch();
+      return t.count();
+   }
+
+   //--------------------------------------------------------------------------
+   // Put, Get
+   //--------------------------------------------------------------------------
+   template<class T>
+   bool Put( FILE* file, const T& value )
+   {
+      return fwrite( &value, sizeof(T), 1, file ) == 1;
+   }
+
+   template<class T>
+   bool Get( FILE* file, T& value )
+   {
+      return fread( &value, sizeof(T), 1, file ) == 1;
+   }
+
+   //--------------------------------------------------------------------------
+   // Commit
+   //
+   //    Flush the file to the disk, and close it.
+   //--------------------------------------------------------------------------
+   bool Commit( FILE* file )
+   {
+      bool ok = ( fflush(file) == 0 );
+#if defined(_WIN32)
+      ok = ok && ( _commit( _fileno(file) ) == 0 );
+#else
+      ok = ok && ( fsync( fileno(file) ) == 0 );
+#endif
+      return ( fclose(file) == 0 ) && ok;
+   }
+
+   //--------------------------------------------------------------------------
+   // Replace
+   //
+   //    Rename from over to, in one step.
+   //--------------------------------------------------------------------------
+   bool Replace( const std::string& from, const std::string& to )
+   {
+#if defined(_WIN32)
+      return MoveFileExA( from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH ) != 0;
+#else
+      return rename( from.c_str(), to.c_str() ) == 0;
+#endif
+   }
+
+   //--------------------------------------------------------------------------
+   // ProcessId
+   //--------------------------------------------------------------------------
+   unsigned long ProcessId()
+   {
+#if defined(_WIN32)
+      return GetCurrentProcessId();
+#else
+      return getpid();
+#endif
+   }
+}
+
+//=============================================================================
+// HashBytes
+//=============================================================================
+uint64_t HashBytes( const void* data, size_t n, uint64_t hash )
+{
+   const unsigned char* p = static_cast<const unsigned char*>( data );
+   for( size_t i=0; i<n; ++i )
+   {
+      hash ^= p[i];
+      hash *= FNV_PRIME;
+   }
+   return hash;
+}
+
+uint64_t HashBytes( const std::vector<double>& v, uint64_t hash )
+{
+   const uint64_t n = v.size();
+   hash = HashBytes( &n, sizeof(n), hash );
+   return HashBytes( v.data(), sizeof(double)*v.size(), hash );
+}
+
+//=============================================================================
+// WriteAtomically
+//
+//    The temporary file is named for the process, so that two processes
+//    writing the same file do not share it.
+//=============================================================================
+bool WriteAtomically( const std::string& filename, const std::function<bool(FILE*)>& write )
+{
+   const std::string temporary = filename + ".tmp" + std::to_string( ProcessId() );
+
+   FILE* file = fopen( temporary.c_str(), "wb" );
+   if( file == nullptr )
+      return false;
+
+   bool ok = write( file );
+   ok = Commit( file ) && ok;
+   ok = ok && Replace( temporary, filename );
+
+   if( !ok )
+      std::remove( temporary.c_str() );
+   return ok;
+}
+
+//=============================================================================
+// Checkpoint
+//=============================================================================
+Checkpoint::Checkpoint(
+   const std::string& filename,
+   uint64_t hash,
+   double interval,
+   Matrix& Zhat,
+   Matrix& Xi,
+   Matrix& Tau,
+   std::vector<int>& cnt )
+:  m_Filename( filename ),
+   m_Hash( hash ),
+   m_Interval( interval ),
+   m_Zhat( Zhat ),
+   m_Xi( Xi ),
+   m_Tau( Tau ),
+   m_cnt( cnt ),
+   m_Finished( new std::atomic<char>[ Zhat.nRows() ] ),
+   m_Next( Now() + interval ),
+   m_Saving(),
+   m_Warned( false )
+{
+   assert( Xi.nRows() == Zhat.nRows() && Xi.nCols() == Zhat.nCols() );
+   assert( Tau.nRows() == Zhat.nRows() && int(cnt.size()) == Zhat.nRows() );
+
+   for( int k=0; k<Zhat.nRows(); ++k )
+      m_Finished[k] = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Load
+//-----------------------------------------------------------------------------
+int Checkpoint::Load()
+{
+   const int N = m_Zhat.nRows();
+   const int P = m_Zhat.nCols();
+
+   FILE* file = fopen( m_Filename.c_str(), "rb" );
+   if( file == nullptr )
+      return 0;
+
+   char magic[8];
+   uint32_t version = 0;
+   uint64_t hash = 0;
+   int32_t n = 0, p = 0, count = 0;
+
+   bool ok = fread( magic, 1, 8, file ) == 8 && memcmp( magic, MAGIC, 8 ) == 0 &&
+             Get( file, version ) && Get( file, hash ) &&
+             Get( file, n ) && Get( file, p ) && Get( file, count );
+
+   if( !ok || version != VERSION || hash != m_Hash || n != N || p != P || count < 0 || count > N )
+   {
+      std::cerr << "WARNING: the checkpoint <" << m_Filename << "> is not for these inputs; starting over." << std::endl;
+      fclose( file );
+      return 0;
+   }
+
+   std::vector<double> row( 2*P );
+   int restored = 0;
+   for( int r=0; r<count; ++r )
+   {
+      int32_t k, cnt;
+      double tau;
+      if( !Get( file, k ) || !Get( file, cnt ) || !Get( file, tau ) ||
+          fread( row.data(), sizeof(double), 2*P, file ) != size_t(2*P) || k < 0 || k >= N )
+      {
+         std::cerr << "WARNING: the checkpoint <" << m_Filename << "> is truncated." << std::endl;
+         break;
+      }
+
+      for( int j=0; j<P; ++j )
+      {
+         m_Zhat(k,j) = row[j];
+         m_Xi(k,j)   = row[P+j];
+      }
+      m_Tau(k,0) = tau;
+      m_cnt[k]   = cnt;
+
+      if( !m_Finished[k] )
+         ++restored;
+      m_Finished[k] = 1;
+   }
+
+   fclose( file );
+   return restored;
+}
+
+//-----------------------------------------------------------------------------
+// IsFinished
+//-----------------------------------------------------------------------------
+bool Checkpoint::IsFinished( int k ) const
+{
+   return m_Finished[k].load( std::memory_order_acquire ) != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Finished
+//
+//    The row k must be complete before the call.
+//-----------------------------------------------------------------------------
+void Checkpoint::Finished( int k )
+{
+   m_Finished[k].store( 1, std::memory_order_release );
+
+   if( Now() < m_Next )
+      return;
+
+   std::unique_lock<std::mutex> lock( m_Saving, std::try_to_lock );
+   if( lock.owns_lock() )
+   {
+      Save();
+      m_Next = Now() + m_Interval;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Save
+//
+//    Only the rows already finished are read, so the other threads may go
+//    on filling in theirs.
+//-----------------------------------------------------------------------------
+bool Checkpoint::Save()
+{
+   const int N = m_Zhat.nRows();
+   const int P = m_Zhat.nCols();
+
+   std::vector<int> rows;
+   for( int k=0; k<N; ++k )
+   {
+      if( IsFinished(k) )
+         rows.push_back( k );
+   }
+
+   bool ok = WriteAtomically( m_Filename, [&]( FILE* file )
+   {
+      const int32_t n = N, p = P, count = rows.size();
+      bool written = fwrite( MAGIC, 1, 8, file ) == 8 &&
+                     Put( file, VERSION ) && Put( file, m_Hash ) &&
+                     Put( file, n ) && Put( file, p ) && Put( file, count );
+
+      for( size_t r=0; written && r<rows.size(); ++r )
+      {
+         const int32_t k = rows[r], cnt = m_cnt[k];
+         written = Put( file, k ) && Put( file, cnt ) && Put( file, m_Tau(k,0) ) &&
+                   fwrite( m_Zhat.Base(k,0), sizeof(double), P, file ) == size_t(P) &&
+                   fwrite( m_Xi.Base(k,0),   sizeof(double), P, file ) == size_t(P);
+      }
+      return written;
+   });
+
+   if( !ok && !m_Warned )
+   {
+      std::cerr << "WARNING: could not write the checkpoint <" << m_Filename << ">." << std::endl;
+      m_Warned = true;
+   }
+   return ok;
+}
@@ -0,0 +1,102 @@
+//=============================================================================
+// checkpoint.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+//=============================================================================
+// HashBytes
+//
+//    The 64-bit FNV-1a hash of n bytes, continuing from hash.  Chain the
+//    calls to hash several arrays.
+//=============================================================================
+const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+uint64_t HashBytes( const void* data, size_t n, uint64_t hash = HASH_SEED );
+
+uint64_t HashBytes( const std::vector<double>& v, uint64_t hash = HASH_SEED );
+
+//=============================================================================
+// WriteAtomically
+//
+//    Replace the file whole: write it to a temporary file of its own, flush
+//    that to the disk, and rename it over the file.  A crash, or a second
+//    process doing the same, leaves either the old file or a complete new
+//    one.  Return false if the file could not be written.
+//=============================================================================
+bool WriteAtomically( const std::string& filename, const std::function<bool(FILE*)>& write );
+
+//=============================================================================
+// Checkpoint
+//
+//    The finished kriging systems of a long Engine run, saved to a sidecar
+//    file so that an interrupted run can be resumed.  The Checkpoint reads
+//    and writes the rows of the Engine's own Zhat, Xi, Tau and cnt, which
+//    must be sized before it is constructed and outlive it.
+//
+//    The file holds the hash of the inputs, and one record per finished
+//    row.  It is only ever replaced whole, by WriteAtomically.
+//
+//    Finished may be called by many threads at once.  About every interval
+//    seconds, the thread finishing a row also saves all of the finished
+//    rows; the others carry on.
+//=============================================================================
+class Checkpoint
+{
+public:
+   Checkpoint( const std::string& filename, uint64_t hash, double interval, Matrix& Zhat, Matrix& Xi, Matrix& Tau, std::vector<int>& cnt );
+
+   // Restore the rows saved by an earlier run with the same hash and
+   // shape, and return their number.  A missing or mismatched file
+   // restores nothing.
+   int  Load();
+
+   bool IsFinished( int k ) const;
+   void Finished( int k );
+
+   // Save the finished rows now.  Return false if the file could not be
+   // written.
+   bool Save();
+
+private:
+   Checkpoint( const Checkpoint& ) = delete;
+   Checkpoint& operator=( const Checkpoint& ) = delete;
+
+   std::string m_Filename;
+   uint64_t    m_Hash;
+   double      m_Interval;
+
+   Matrix&           m_Zhat;
+   Matrix&           m_Xi;
+   Matrix&           m_Tau;
+   std::vector<int>& m_cnt;
+
+   std::unique_ptr< std::atomic<char>[] > m_Finished;
+   std::atomic<double> m_Next;          // seconds since the epoch of the clock
+   std::mutex          m_Saving;
+   bool                m_Warned;
+};
+
+
+//=============================================================================
+#endif  // CHECKPOINT_H
@@ -0,0 +1,320 @@
+//=============================================================================
+// cross_validation.cpp
+//
+//    Spatial block (k-fold) cross-validation: whole blocks of observations
+//    are held out together, and predicted from the rest.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "cross_validation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <utility>
+
+#include "distance.h"
+#include "linear_systems.h"
+#include "matrix.h"
+#include "parallel.h"
+#include "random_stream.h"
+
+//=============================================================================
+// SpatialFolds
+//
+//    Assign the observations to folds by square blocks.
+//
+// Arguments:
+//
+//    x, y        observation coordinates.
+//
+//    blocksize   side of the square blocks, anchored at the lower-left
+//                corner of the bounding box.
+//
+//    nfolds      number of folds.
+//
+//    seed        the blocks are dealt out to the folds in a random order
+//                drawn from this seed.
+//
+//    fold        on exit, the fold of each observation, 0 <= fold < nfolds.
+//
+// Return:
+//
+//    the number of non-empty blocks.  If it is less than nfolds, some of
+//    the folds are empty.
+//=============================================================================
+int SpatialFolds(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   double blocksize,
+   int nfolds,
+   uint64_t seed,
+   std::vector<int>& fold )
+{
+   const int N = x.size();
+   assert( blocksize > 0 );
+   assert( nfolds > 0 );
+
+   const double xmin = *std::min_element( x.begin(), x.end() );
+   const double ymin = *std::min_element( y.begin(), y.end() );
+
+   // The non-empty blocks, numbered in order of their coordinates.
+   std::map< std::pair<long long,long long>, int > blocks;
+   std::vector<int> block(N);
+   for( int i=0; i<N; ++i )
+   {
+      std::pair<long long,long long> key( (long long)floor( (x[i]-xmin)/blocksize ), (long long)floor( (y[i]-ymin)/blocksize ) );
+      auto it = blocks.insert( std::make_pair( key, int(blocks.size()) ) ).first;
+      block[i] = it->second;
+   }
+   const int B = blocks.size();
+
+   // Deal the blocks out to the folds in a random order.
+   std::vector<double> u(B);
+   RandomStream stream( seed );
+   stream.Uniform( u.data(), B );
+
+   std::vector<int> order(B);
+   for( int b=0; b<B; ++b )
+      order[b] = b;
+   std::sort( order.begin(), order.end(), [&u]( int a, int b ){ return u[a] < u[b]; } );
+
+   std::vector<int> dealt(B);
+   for( int r=0; r<B; ++r )
+      dealt[ order[r] ] = r % nfolds;
+
+   fold.resize(N);
+   for( int i=0; i<N; ++i )
+      fold[i] = dealt[ block[i] ];
+
+   return B;
+}
+
+//=============================================================================
+// BlockCrossValidation
+//
+//    Predict every observation from the observations in the other folds by
+//    Ordinary Kriging, with the pseudo-covariance lambda - gamma(D) of the
+//    Engine.
+//
+// Arguments:
+//
+//    x, y, z  observation coordinates and values.
+//
+//    fold     the fold of each observation; any non-negative labels.
+//
+//    options  the Engine options; threads, affinity and the anisotropy
+//             apply.
+//
+//    model    the variogram model.
+//
+// Return:
+//
+//    for each observation, as for the Engine: the estimate, the
+//    standardized residual zeta, its Gaussian p-value, and cnt, the number
+//    of observations the estimate is based upon.  Where a fold's system
+//    could not be solved the results are NaN and cnt is 0.
+//
+// Notes:
+//
+// o  Each fold's kriging system, for the retained observations, is
+//    factored once.  The held-out observations of the fold are then all
+//    solved as one block of right-hand sides, as in KrigeGrid:
+//
+//       U = B~C,  v = B~1,  beta = (1'u - 1)/(1'v),  w = u - beta v
+//
+//       zhat = w'z,  tau = sqrt(lambda - c'w - beta),  xi = (z - zhat)/tau
+//
+// o  The folds run in parallel, one per thread.
+//
+// o  zeta is xi normalized by the root mean square of all of the xi.
+//=============================================================================
+std::vector<Boomerang> BlockCrossValidation(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   const std::vector<int>& fold,
+   const EngineOptions& options )
+{
+   return BlockCrossValidation( x, y, z, fold, options, LinearVariogram() );
+}
+
+template<class Variogram>
+std::vector<Boomerang> BlockCrossValidation(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   const std::vector<int>& fold,
+   const EngineOptions& options,
+   const Variogram& model )
+{
+   const int N = x.size();
+   assert( y.size() == x.size() && z.size() == x.size() && fold.size() == x.size() );
+
+   const Anisotropy& anisotropy = options.anisotropy;
+
+   // Center the coordinates.
+   const double xm = 0.5*( *std::min_element(x.begin(), x.end()) + *std::max_element(x.begin(), x.end()) );
+   const double ym = 0.5*( *std::min_element(y.begin(), y.end()) + *std::max_element(y.begin(), y.end()) );
+
+   std::vector<double> xc(N), yc(N);
+   for( int i=0; i<N; ++i )
+   {
+      xc[i] = x[i] - xm;
+      yc[i] = y[i] - ym;
+   }
+
+   // The folds.
+   const int F = *std::max_element( fold.begin(), fold.end() ) + 1;
+   std::vector< std::vector<int> > members(F);
+   for( int i=0; i<N; ++i )
+   {
+      assert( fold[i] >= 0 );
+      members[ fold[i] ].push_back(i);
+   }
+
+   // lambda, from the largest separation distance, as in the Engine.
+   const int nthreads = ThreadCount( options.threads );
+   std::vector<double> hmax( nthreads, 0.0 );
+   ParallelFor( N, nthreads, [&]( int i, int thread )
+   {
+      std::vector<double> d(N);
+      Distances( xc[i], yc[i], xc.data(), yc.data(), N, anisotropy, d.data() );
+      hmax[thread] = std::max( hmax[thread], *std::max_element( d.begin(), d.end() ) );
+   }, options.affinity );
+   const double lambda = model.Lambda( *std::max_element( hmax.begin(), hmax.end() ) );
+
+   std::vector<double> Xi( N, NAN );
+   std::vector<double> zhat( N, NAN );
+   std::vector<int> cnt( N, 0 );
+
+   ParallelFor( F, nthreads, [&]( int f, int )
+   {
+      const std::vector<int>& held = members[f];
+      const int H = held.size();
+      const int M = N - H;
+      if( H == 0 || M < 2 )
+         return;
+
+      // The retained observations.
+      std::vector<double> xr, yr, zr;
+      xr.reserve(M);
+      yr.reserve(M);
+      zr.reserve(M);
+      for( int i=0; i<N; ++i )
+      {
+         if( fold[i] != f )
+         {
+            xr.push_back( xc[i] );
+            yr.push_back( yc[i] );
+            zr.push_back( z[i] );
+         }
+      }
+
+      // Setup and factor the kriging system for the retained observations.
+      // Only the lower triangle of B is used by the Cholesky decomposition.
+      Matrix B(M, M);
+      for( int a=0; a<M; ++a )
+      {
+         double* Ba = B.Base(a,0);
+         Distances( xr[a], yr[a], xr.data(), yr.data(), a+1, anisotropy, Ba );
+         for( int b=0; b<=a; ++b )
+            Ba[b] = lambda - model( Ba[b] );
+      }
+
+      Matrix L;
+      if( !CholeskyDecomposition(B, L) )
+         return;
+
+      Matrix ones(M, 1, 1.0), v;
+      CholeskySolve( L, ones, v );
+      const double sv = Sum(v);
+
+      // All of the held-out observations as one block of right-hand sides.
+      Matrix Ct(H, M), C, U;
+      for( int t=0; t<H; ++t )
+      {
+         double* Cr = Ct.Base(t,0);
+         Distances( xc[held[t]], yc[held[t]], xr.data(), yr.data(), M, anisotropy, Cr );
+         for( int a=0; a<M; ++a )
+            Cr[a] = lambda - model( Cr[a] );
+      }
+      Transpose( Ct, C );
+
+      CholeskySolve( L, C, U );
+
+      for( int t=0; t<H; ++t )
+      {
+         double su = 0.0;
+         for( int a=0; a<M; ++a )
+            su += U(a,t);
+
+         const double beta = ( su - 1 ) / sv;
+
+         double zt = 0.0;
+         double cw = 0.0;
+         for( int a=0; a<M; ++a )
+         {
+            double w = U(a,t) - beta*v(a,0);
+            zt += w * zr[a];
+            cw += w * C(a,t);
+         }
+
+         const int k = held[t];
+         const double tau = sqrt( lambda - cw - beta );
+         zhat[k] = zt;
+         Xi[k]   = ( z[k] - zt ) / tau;
+         cnt[k]  = M;
+      }
+   }, options.affinity );
+
+   // Normalize, leaving out the failures.
+   XiSums sums;
+   for( int k=0; k<N; ++k )
+   {
+      if( !std::isnan( Xi[k] ) )
+      {
+         sums.sum += Xi[k]*Xi[k];
+         ++sums.count;
+      }
+   }
+
+   std::vector<Boomerang> results(N);
+   for( int k=0; k<N; ++k )
+   {
+      results[k].zhat      = zhat[k];
+      results[k].xi        = Xi[k];
+      results[k].pvalue_mc = NAN;
+      results[k].cnt       = cnt[k];
+   }
+   NormalizeXi( sums, results );
+
+   return results;
+}
+
+//=============================================================================
+// Explicit instantiations for the variogram models in variogram_models.h.
+//=============================================================================
+#define INSTANTIATE_CROSS_VALIDATION( Variogram ) \
+   template std::vector<Boomerang> BlockCrossValidation<Variogram>( \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<int>&,            \
+      const EngineOptions&,               \
+      const Variogram& );
+
+INSTANTIATE_CROSS_VALIDATION( LinearVariogram )
+INSTANTIATE_CROSS_VALIDATION( PowerVariogram )
+INSTANTIATE_CROSS_VALIDATION( ExponentialVariogram )
+INSTANTIATE_CROSS_VALIDATION( SphericalVariogram )
+INSTANTIATE_CROSS_VALIDATION( GaussianVariogram )
+
+#undef INSTANTIATE_CROSS_VALIDATION
@@ -0,0 +1,32 @@
+//=============================================================================
+// cross_validation.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef CROSS_VALIDATION_H
+#define CROSS_VALIDATION_H
+
+#include <cstdint>
+#include <vector>
+
+#include "engine.h"
+
+//=============================================================================
+int SpatialFolds( const std::vector<double>& x, const std::vector<double>& y, double blocksize, int nfolds, uint64_t seed, std::vector<int>& fold );
+
+// Block cross-validation with the LinearVariogram, or with any of the
+// models in variogram_models.h (instantiated in cross_validation.cpp).
+std::vector<Boomerang> BlockCrossValidation( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, const std::vector<int>& fold, const EngineOptions& options );
+
+template<class Variogram>
+std::vector<Boomerang> BlockCrossValidation( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, const std::vector<int>& fold, const EngineOptions& options, const Variogram& model );
+
+
+//=============================================================================
+#endif  // CROSS_VALIDATION_H
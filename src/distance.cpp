@@ -0,0 +1,638 @@
+//=============================================================================
+// distance.cpp
+//
+//    Vectorized separation distance kernels, optionally with a geometric
+//    anisotropy fused into the computation.
+//
+// notes:
+// o  The great-circle distance between two points on the unit sphere with
+//    chord length c is 2 asin(c/2) = c + c^3/24 + 3c^5/640 + 5c^7/7168 + ...
+//    Truncating after the c^5 term leaves only multiplies, adds, and a square
+//    root, so it vectorizes.  The relative error is below 5c^6/7168, i.e.
+//    less than 2e-8 for separations up to 1000 km, but it grows quickly
+//    beyond: 2e-5 at 3000 km, and about 20% at antipodal points.  So the
+//    separations beyond 1000 km are recomputed exactly, as 2 asin(c/2).
+//
+// o  The coordinates are assumed to be of moderate magnitude (e.g. centered),
+//    so the distances are computed as sqrt(dx*dx + dy*dy) without the
+//    overflow protection of hypot.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "distance.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define DISTANCE_SSE2
+#endif
+
+// The wider kernels are compiled for their instruction sets regardless of
+// the compiler flags, and chosen at run time from the CPU.  AVX-512F brings
+// FMA with it, and GCC would otherwise fuse the multiply and the add.
+#if defined(__clang__) && defined(__x86_64__)
+#include <immintrin.h>
+#define DISTANCE_DISPATCH
+#define DISTANCE_TARGET(isa) __attribute__(( target(isa) ))
+#elif defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define DISTANCE_DISPATCH
+#define DISTANCE_TARGET(isa) __attribute__(( target(isa), optimize("fp-contract=off") ))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#include <immintrin.h>
+#include <intrin.h>
+#define DISTANCE_DISPATCH
+#define DISTANCE_TARGET(isa)
+#endif
+
+namespace{
+   // Manifest constants.
+   const double SERIES_MAX_CC = 0.0246;   // squared chord of about 1000 km
+
+   //--------------------------------------------------------------------------
+   // ExactArc
+   //
+   //    The great-circle distance, in kilometers, for the squared chord cc.
+   //--------------------------------------------------------------------------
+   inline double ExactArc( double cc )
+   {
+      return EARTH_RADIUS * ( 2.0 * asin( std::min( 0.5*sqrt(cc), 1.0 ) ) );
+   }
+
+   //--------------------------------------------------------------------------
+   // Metric
+   //
+   //    The rows of the rotate-then-scale transformation for an anisotropy:
+   //
+   //       u = a11*dx + a12*dy     (along the major axis)
+   //       v = a21*dx + a22*dy     (along the minor axis, stretched)
+   //       w = a33*dz              (vertical)
+   //
+   //    For the isotropic case this is the identity, exactly.
+   //--------------------------------------------------------------------------
+   struct Metric
+   {
+      double a11, a12, a21, a22, a33;
+
+      explicit Metric( const Anisotropy& anisotropy )
+      {
+         assert( anisotropy.ratio > 0 && anisotropy.ratio <= 1 );
+         assert( anisotropy.vertical > 0 );
+
+         const double PI = 3.14159265358979323846;
+         double theta = anisotropy.angle * PI / 180.0;
+         double c = ( anisotropy.angle == 0.0 ) ? 1.0 : cos(theta);
+         double s = ( anisotropy.angle == 0.0 ) ? 0.0 : sin(theta);
+
+         a11 =  c;
+         a12 =  s;
+         a21 = -s / anisotropy.ratio;
+         a22 =  c / anisotropy.ratio;
+         a33 =  anisotropy.vertical;
+      }
+   };
+}
+
+#ifdef DISTANCE_DISPATCH
+namespace{
+   //--------------------------------------------------------------------------
+   // Distances256, Distances512
+   //
+   //    The plain 2-D kernel, four distances at a time with AVX2, and eight
+   //    at a time with AVX-512; the tail is masked.  Every lane does exactly
+   //    the operations of the scalar loop, with no fused multiply-add, so
+   //    all of the kernels return identical distances.
+   //--------------------------------------------------------------------------
+   DISTANCE_TARGET("avx2")
+   void Distances256( double x0, double y0, const double* x, const double* y, int n, double* d )
+   {
+      const __m256d X0 = _mm256_set1_pd( x0 );
+      const __m256d Y0 = _mm256_set1_pd( y0 );
+
+      int i = 0;
+      for( ; i+4 <= n; i += 4 )
+      {
+         __m256d dx = _mm256_sub_pd( _mm256_loadu_pd(x+i), X0 );
+         __m256d dy = _mm256_sub_pd( _mm256_loadu_pd(y+i), Y0 );
+         __m256d dd = _mm256_add_pd( _mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy) );
+         _mm256_storeu_pd( d+i, _mm256_sqrt_pd(dd) );
+      }
+
+      for( ; i<n; ++i )
+      {
+         double dx = x[i] - x0;
+         double dy = y[i] - y0;
+         d[i] = sqrt( dx*dx + dy*dy );
+      }
+   }
+
+   DISTANCE_TARGET("avx512f")
+   void Distances512( double x0, double y0, const double* x, const double* y, int n, double* d )
+   {
+      const __m512d X0 = _mm512_set1_pd( x0 );
+      const __m512d Y0 = _mm512_set1_pd( y0 );
+
+      for( int i=0; i<n; i += 8 )
+      {
+         const __mmask8 m = ( n-i >= 8 ) ? __mmask8(0xFF) : __mmask8( (1u << (n-i)) - 1 );
+
+         __m512d dx = _mm512_sub_pd( _mm512_maskz_loadu_pd(m, x+i), X0 );
+         __m512d dy = _mm512_sub_pd( _mm512_maskz_loadu_pd(m, y+i), Y0 );
+         __m512d dd = _mm512_add_pd( _mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy) );
+         _mm512_mask_storeu_pd( d+i, m, _mm512_maskz_sqrt_pd(m, dd) );
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // FloatDistances256, FloatDistances512
+   //
+   //    The single precision 2-D kernel, eight distances at a time with AVX2,
+   //    and sixteen at a time with AVX-512.
+   //--------------------------------------------------------------------------
+   DISTANCE_TARGET("avx2")
+   void FloatDistances256( float x0, float y0, const float* x, const float* y, int n, float* d )
+   {
+      const __m256 X0 = _mm256_set1_ps( x0 );
+      const __m256 Y0 = _mm256_set1_ps( y0 );
+
+      int i = 0;
+      for( ; i+8 <= n; i += 8 )
+      {
+         __m256 dx = _mm256_sub_ps( _mm256_loadu_ps(x+i), X0 );
+         __m256 dy = _mm256_sub_ps( _mm256_loadu_ps(y+i), Y0 );
+         __m256 dd = _mm256_add_ps( _mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy) );
+         _mm256_storeu_ps( d+i, _mm256_sqrt_ps(dd) );
+      }
+
+      for( ; i<n; ++i )
+      {
+         float dx = x[i] - x0;
+         float dy = y[i] - y0;
+         d[i] = std::sqrt( dx*dx + dy*dy );
+      }
+   }
+
+   DISTANCE_TARGET("avx512f")
+   void FloatDistances512( float x0, float y0, const float* x, const float* y, int n, float* d )
+   {
+      const __m512 X0 = _mm512_set1_ps( x0 );
+      const __m512 Y0 = _mm512_set1_ps( y0 );
+
+      for( int i=0; i<n; i += 16 )
+      {
+         const __mmask16 m = ( n-i >= 16 ) ? __mmask16(0xFFFF) : __mmask16( (1u << (n-i)) - 1 );
+
+         __m512 dx = _mm512_sub_ps( _mm512_maskz_loadu_ps(m, x+i), X0 );
+         __m512 dy = _mm512_sub_ps( _mm512_maskz_loadu_ps(m, y+i), Y0 );
+         __m512 dd = _mm512_add_ps( _mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy) );
+         _mm512_mask_storeu_ps( d+i, m, _mm512_maskz_sqrt_ps(m, dd) );
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // Supports
+   //
+   //    True if both the CPU and the operating system support the
+   //    instruction set: 256 for AVX2, 512 for AVX-512F.
+   //--------------------------------------------------------------------------
+   bool Supports( int bits )
+   {
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid( info, 0 );
+      if( info[0] < 7 )
+         return false;
+
+      __cpuid( info, 1 );
+      if( !( info[2] & (1 << 27) ) )         // OSXSAVE
+         return false;
+
+      const unsigned long long xcr0 = _xgetbv( 0 );
+      __cpuidex( info, 7, 0 );
+      if( bits == 256 )
+         return ( info[1] & (1 << 5) ) && ( xcr0 & 0x06 ) == 0x06;
+      else
+         return ( info[1] & (1 << 16) ) && ( xcr0 & 0xE6 ) == 0xE6;
+#else
+      __builtin_cpu_init();
+      if( bits == 256 )
+         return __builtin_cpu_supports( "avx2" );
+      else
+         return __builtin_cpu_supports( "avx512f" );
+#endif
+   }
+
+   //--------------------------------------------------------------------------
+   // PlainKernel
+   //
+   //    The widest plain 2-D kernel this CPU supports, chosen once.
+   //--------------------------------------------------------------------------
+   typedef void (*PlainKernelType)( double, double, const double*, const double*, int, double* );
+
+   const char* g_KernelName = "sse2";
+
+   PlainKernelType PlainKernel()
+   {
+      static const PlainKernelType kernel = []() -> PlainKernelType
+      {
+         if( Supports(512) )
+         {
+            g_KernelName = "avx512";
+            return Distances512;
+         }
+         if( Supports(256) )
+         {
+            g_KernelName = "avx2";
+            return Distances256;
+         }
+         return nullptr;
+      }();
+      return kernel;
+   }
+
+   //--------------------------------------------------------------------------
+   // FloatKernel
+   //
+   //    The single precision counterpart of PlainKernel.
+   //--------------------------------------------------------------------------
+   typedef void (*FloatKernelType)( float, float, const float*, const float*, int, float* );
+
+   FloatKernelType FloatKernel()
+   {
+      static const FloatKernelType kernel = []() -> FloatKernelType
+      {
+         if( Supports(512) )
+            return FloatDistances512;
+         if( Supports(256) )
+            return FloatDistances256;
+         return nullptr;
+      }();
+      return kernel;
+   }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// DistanceInstructionSet
+//
+//    The instruction set used by the plain 2-D kernel: "avx512", "avx2",
+//    "sse2", or "scalar".
+//-----------------------------------------------------------------------------
+const char* DistanceInstructionSet()
+{
+#if defined(DISTANCE_DISPATCH)
+   PlainKernel();
+   return g_KernelName;
+#elif defined(DISTANCE_SSE2)
+   return "sse2";
+#else
+   return "scalar";
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Distances
+//
+//    Compute the separation distance from (x0,y0) to each of the n points
+//    (x[i],y[i]), putting the results in d[i].
+//
+// notes:
+// o  On x86-64 the distances are computed 8, 4 or 2 at a time, using
+//    AVX-512 or AVX2 when the CPU has them, and otherwise SSE2, which is
+//    part of the base instruction set.  The results are identical.
+//-----------------------------------------------------------------------------
+void Distances( double x0, double y0, const double* x, const double* y, int n, double* d )
+{
+   assert( n >= 0 );
+
+#ifdef DISTANCE_DISPATCH
+   if( PlainKernelType kernel = PlainKernel() )
+   {
+      kernel( x0, y0, x, y, n, d );
+      return;
+   }
+#endif
+
+   int i = 0;
+
+#ifdef DISTANCE_SSE2
+   const __m128d X0 = _mm_set1_pd( x0 );
+   const __m128d Y0 = _mm_set1_pd( y0 );
+
+   for( ; i+2 <= n; i += 2 )
+   {
+      __m128d dx = _mm_sub_pd( _mm_loadu_pd(x+i), X0 );
+      __m128d dy = _mm_sub_pd( _mm_loadu_pd(y+i), Y0 );
+      __m128d dd = _mm_add_pd( _mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy) );
+      _mm_storeu_pd( d+i, _mm_sqrt_pd(dd) );
+   }
+#endif
+
+   for( ; i<n; ++i )
+   {
+      double dx = x[i] - x0;
+      double dy = y[i] - y0;
+      d[i] = sqrt( dx*dx + dy*dy );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Distances
+//
+//    As above, but with the geometric anisotropy applied to each separation
+//    vector on the fly; the coordinates are neither copied nor transformed.
+//-----------------------------------------------------------------------------
+void Distances( double x0, double y0, const double* x, const double* y, int n, const Anisotropy& anisotropy, double* d )
+{
+   assert( n >= 0 );
+   const Metric A( anisotropy );
+   int i = 0;
+
+#ifdef DISTANCE_SSE2
+   const __m128d X0  = _mm_set1_pd( x0 );
+   const __m128d Y0  = _mm_set1_pd( y0 );
+   const __m128d A11 = _mm_set1_pd( A.a11 );
+   const __m128d A12 = _mm_set1_pd( A.a12 );
+   const __m128d A21 = _mm_set1_pd( A.a21 );
+   const __m128d A22 = _mm_set1_pd( A.a22 );
+
+   for( ; i+2 <= n; i += 2 )
+   {
+      __m128d dx = _mm_sub_pd( _mm_loadu_pd(x+i), X0 );
+      __m128d dy = _mm_sub_pd( _mm_loadu_pd(y+i), Y0 );
+      __m128d u  = _mm_add_pd( _mm_mul_pd(A11, dx), _mm_mul_pd(A12, dy) );
+      __m128d v  = _mm_add_pd( _mm_mul_pd(A21, dx), _mm_mul_pd(A22, dy) );
+      __m128d dd = _mm_add_pd( _mm_mul_pd(u, u), _mm_mul_pd(v, v) );
+      _mm_storeu_pd( d+i, _mm_sqrt_pd(dd) );
+   }
+#endif
+
+   for( ; i<n; ++i )
+   {
+      double dx = x[i] - x0;
+      double dy = y[i] - y0;
+      double u  = A.a11*dx + A.a12*dy;
+      double v  = A.a21*dx + A.a22*dy;
+      d[i] = sqrt( u*u + v*v );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Distances
+//
+//    The 3-D version: the separation distance from (x0,y0,z0) to each of
+//    the n points (x[i],y[i],z[i]), with the horizontal anisotropy and the
+//    vertical factor applied on the fly.
+//-----------------------------------------------------------------------------
+void Distances( double x0, double y0, double z0, const double* x, const double* y, const double* z, int n, const Anisotropy& anisotropy, double* d )
+{
+   assert( n >= 0 );
+   const Metric A( anisotropy );
+   int i = 0;
+
+#ifdef DISTANCE_SSE2
+   const __m128d X0  = _mm_set1_pd( x0 );
+   const __m128d Y0  = _mm_set1_pd( y0 );
+   const __m128d Z0  = _mm_set1_pd( z0 );
+   const __m128d A11 = _mm_set1_pd( A.a11 );
+   const __m128d A12 = _mm_set1_pd( A.a12 );
+   const __m128d A21 = _mm_set1_pd( A.a21 );
+   const __m128d A22 = _mm_set1_pd( A.a22 );
+   const __m128d A33 = _mm_set1_pd( A.a33 );
+
+   for( ; i+2 <= n; i += 2 )
+   {
+      __m128d dx = _mm_sub_pd( _mm_loadu_pd(x+i), X0 );
+      __m128d dy = _mm_sub_pd( _mm_loadu_pd(y+i), Y0 );
+      __m128d dz = _mm_sub_pd( _mm_loadu_pd(z+i), Z0 );
+      __m128d u  = _mm_add_pd( _mm_mul_pd(A11, dx), _mm_mul_pd(A12, dy) );
+      __m128d v  = _mm_add_pd( _mm_mul_pd(A21, dx), _mm_mul_pd(A22, dy) );
+      __m128d w  = _mm_mul_pd( A33, dz );
+      __m128d dd = _mm_add_pd( _mm_add_pd( _mm_mul_pd(u, u), _mm_mul_pd(v, v) ), _mm_mul_pd(w, w) );
+      _mm_storeu_pd( d+i, _mm_sqrt_pd(dd) );
+   }
+#endif
+
+   for( ; i<n; ++i )
+   {
+      double dx = x[i] - x0;
+      double dy = y[i] - y0;
+      double dz = z[i] - z0;
+      double u  = A.a11*dx + A.a12*dy;
+      double v  = A.a21*dx + A.a22*dy;
+      double w  = A.a33*dz;
+      d[i] = sqrt( (u*u + v*v) + w*w );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Distances
+//
+//    The single precision version of the plain 2-D kernel: 16, 8 or 4
+//    distances at a time.  Only the storage and arithmetic are float; the
+//    caller must center the coordinates so that float keeps enough
+//    significant digits, and apply any anisotropy to them beforehand
+//    (MetricCoordinates).
+//-----------------------------------------------------------------------------
+void Distances( float x0, float y0, const float* x, const float* y, int n, float* d )
+{
+   assert( n >= 0 );
+
+#ifdef DISTANCE_DISPATCH
+   if( FloatKernelType kernel = FloatKernel() )
+   {
+      kernel( x0, y0, x, y, n, d );
+      return;
+   }
+#endif
+
+   int i = 0;
+
+#ifdef DISTANCE_SSE2
+   const __m128 X0 = _mm_set1_ps( x0 );
+   const __m128 Y0 = _mm_set1_ps( y0 );
+
+   for( ; i+4 <= n; i += 4 )
+   {
+      __m128 dx = _mm_sub_ps( _mm_loadu_ps(x+i), X0 );
+      __m128 dy = _mm_sub_ps( _mm_loadu_ps(y+i), Y0 );
+      __m128 dd = _mm_add_ps( _mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy) );
+      _mm_storeu_ps( d+i, _mm_sqrt_ps(dd) );
+   }
+#endif
+
+   for( ; i<n; ++i )
+   {
+      float dx = x[i] - x0;
+      float dy = y[i] - y0;
+      d[i] = std::sqrt( dx*dx + dy*dy );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Distance
+//
+//    The anisotropic length of a single separation vector (dx,dy).
+//-----------------------------------------------------------------------------
+double Distance( double dx, double dy, const Anisotropy& anisotropy )
+{
+   const Metric A( anisotropy );
+   double u = A.a11*dx + A.a12*dy;
+   double v = A.a21*dx + A.a22*dy;
+   return sqrt( u*u + v*v );
+}
+
+//-----------------------------------------------------------------------------
+// CenterCoordinates
+//
+//    Shift the planar coordinates so that their bounding box is centered on
+//    the origin.  Every table and list of separation distances is computed
+//    from these, so that they agree to the last bit.
+//-----------------------------------------------------------------------------
+void CenterCoordinates( const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& X, std::vector<double>& Y )
+{
+   assert( x.size() == y.size() );
+   const int N = x.size();
+
+   X.resize(N);
+   Y.resize(N);
+   if( N == 0 )
+      return;
+
+   const double xc = 0.5*( *std::min_element(x.begin(), x.end()) + *std::max_element(x.begin(), x.end()) );
+   const double yc = 0.5*( *std::min_element(y.begin(), y.end()) + *std::max_element(y.begin(), y.end()) );
+
+   for( int i=0; i<N; ++i )
+   {
+      X[i] = x[i] - xc;
+      Y[i] = y[i] - yc;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// MetricCoordinates
+//
+//    The coordinates (U,V,W) of the n observations in which the anisotropic
+//    separation distance is the Euclidean one.  W holds the scaled
+//    elevations, and is left empty if elev is nullptr.
+//-----------------------------------------------------------------------------
+void MetricCoordinates( int n, const double* x, const double* y, const double* elev, const Anisotropy& anisotropy, std::vector<double>& U, std::vector<double>& V, std::vector<double>& W )
+{
+   const Metric A( anisotropy );
+
+   U.resize(n);
+   V.resize(n);
+   W.clear();
+   for( int i=0; i<n; ++i )
+   {
+      U[i] = A.a11*x[i] + A.a12*y[i];
+      V[i] = A.a21*x[i] + A.a22*y[i];
+   }
+
+   if( elev != nullptr )
+   {
+      W.resize(n);
+      for( int i=0; i<n; ++i )
+         W[i] = A.a33*elev[i];
+   }
+}
+
+//-----------------------------------------------------------------------------
+// UnitVectors
+//
+//    Convert longitude and latitude, in degrees, to points (X,Y,Z) on the
+//    unit sphere.
+//-----------------------------------------------------------------------------
+void UnitVectors( const std::vector<double>& lon, const std::vector<double>& lat, std::vector<double>& X, std::vector<double>& Y, std::vector<double>& Z )
+{
+   assert( lon.size() == lat.size() );
+   const int N = lon.size();
+   const double DEGREES = 3.14159265358979323846 / 180.0;
+
+   X.resize(N);
+   Y.resize(N);
+   Z.resize(N);
+   for( int i=0; i<N; ++i )
+   {
+      double phi    = lat[i] * DEGREES;
+      double lambda = lon[i] * DEGREES;
+
+      X[i] = cos(phi) * cos(lambda);
+      Y[i] = cos(phi) * sin(lambda);
+      Z[i] = sin(phi);
+   }
+}
+
+//-----------------------------------------------------------------------------
+// GreatCircleDistances
+//
+//    Compute the great-circle distance, in kilometers, from the unit vector
+//    (X0,Y0,Z0) to each of the n unit vectors (X[i],Y[i],Z[i]), putting the
+//    results in d[i].
+//
+// notes:
+// o  The truncated series is used up to about 1000 km, and the exact arc
+//    beyond; a pair of lanes is only recomputed if one of them is that far.
+//-----------------------------------------------------------------------------
+void GreatCircleDistances( double X0, double Y0, double Z0, const double* X, const double* Y, const double* Z, int n, double* d )
+{
+   assert( n >= 0 );
+   const double C3 = 1.0/24.0;
+   const double C5 = 3.0/640.0;
+   int i = 0;
+
+#ifdef DISTANCE_SSE2
+   const __m128d PX = _mm_set1_pd( X0 );
+   const __m128d PY = _mm_set1_pd( Y0 );
+   const __m128d PZ = _mm_set1_pd( Z0 );
+   const __m128d K3 = _mm_set1_pd( C3 );
+   const __m128d K5 = _mm_set1_pd( C5 );
+   const __m128d R  = _mm_set1_pd( EARTH_RADIUS );
+   const __m128d ONE = _mm_set1_pd( 1.0 );
+   const __m128d CCX = _mm_set1_pd( SERIES_MAX_CC );
+
+   for( ; i+2 <= n; i += 2 )
+   {
+      __m128d dx = _mm_sub_pd( _mm_loadu_pd(X+i), PX );
+      __m128d dy = _mm_sub_pd( _mm_loadu_pd(Y+i), PY );
+      __m128d dz = _mm_sub_pd( _mm_loadu_pd(Z+i), PZ );
+      __m128d cc = _mm_add_pd( _mm_add_pd( _mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy) ), _mm_mul_pd(dz, dz) );
+      __m128d c  = _mm_sqrt_pd( cc );
+      __m128d s  = _mm_add_pd( ONE, _mm_mul_pd( cc, _mm_add_pd( K3, _mm_mul_pd(cc, K5) ) ) );
+      _mm_storeu_pd( d+i, _mm_mul_pd( R, _mm_mul_pd(c, s) ) );
+
+      const int far = _mm_movemask_pd( _mm_cmpgt_pd( cc, CCX ) );
+      if( far != 0 )
+      {
+         double ccs[2];
+         _mm_storeu_pd( ccs, cc );
+         for( int k=0; k<2; ++k )
+            if( far & (1 << k) )
+               d[i+k] = ExactArc( ccs[k] );
+      }
+   }
+#endif
+
+   for( ; i<n; ++i )
+   {
+      double dx = X[i] - X0;
+      double dy = Y[i] - Y0;
+      double dz = Z[i] - Z0;
+      double cc = (dx*dx + dy*dy) + dz*dz;
+      double c  = sqrt( cc );
+      if( cc > SERIES_MAX_CC )
+         d[i] = ExactArc( cc );
+      else
+         d[i] = EARTH_RADIUS * ( c * ( 1.0 + cc*( C3 + cc*C5 ) ) );
+   }
+}
@@ -0,0 +1,66 @@
+//=============================================================================
+// distance.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <vector>
+
+//=============================================================================
+// Anisotropy
+//
+//    Geometric anisotropy: the major axis is at "angle" degrees
+//    counterclockwise from the x axis, and "ratio" is the minor-to-major
+//    range ratio, 0 < ratio <= 1.  Separations along the minor axis are
+//    stretched by 1/ratio.  For 3-D observations, elevation differences are
+//    multiplied by the "vertical" factor.
+//=============================================================================
+struct Anisotropy
+{
+   double angle    = 0.0;
+   double ratio    = 1.0;
+   double vertical = 1.0;
+
+   bool IsIsotropic() const { return ratio == 1.0; }    // horizontally
+};
+
+//=============================================================================
+//
+//=============================================================================
+void Distances( double x0, double y0, const double* x, const double* y, int n, double* d );
+void Distances( double x0, double y0, const double* x, const double* y, int n, const Anisotropy& anisotropy, double* d );
+void Distances( double x0, double y0, double z0, const double* x, const double* y, const double* z, int n, const Anisotropy& anisotropy, double* d );
+
+// Single precision: the coordinates must be centered, and in the metric.
+void Distances( float x0, float y0, const float* x, const float* y, int n, float* d );
+
+double Distance( double dx, double dy, const Anisotropy& anisotropy );
+
+void CenterCoordinates( const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& X, std::vector<double>& Y );
+void MetricCoordinates( int n, const double* x, const double* y, const double* elev, const Anisotropy& anisotropy, std::vector<double>& U, std::vector<double>& V, std::vector<double>& W );
+
+const char* DistanceInstructionSet();
+
+//=============================================================================
+// Geographic coordinates
+//
+//    Longitude and latitude, in degrees, are converted once to points on
+//    the unit sphere.  The great-circle distance, in kilometers, is then
+//    computed from the chord length by a short series; see distance.cpp.
+//=============================================================================
+const double EARTH_RADIUS = 6371.0088;      // mean radius [km]
+
+void UnitVectors( const std::vector<double>& lon, const std::vector<double>& lat, std::vector<double>& X, std::vector<double>& Y, std::vector<double>& Z );
+void GreatCircleDistances( double X0, double Y0, double Z0, const double* X, const double* Y, const double* Z, int n, double* d );
+
+
+//=============================================================================
+#endif  // DISTANCE_H
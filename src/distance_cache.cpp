@@ -0,0 +1,186 @@
+//=============================================================================
+// distance_cache.cpp
+//
+//    A cache of separation distance tables on disk, for rerunning the
+//    Engine on the same locations.
+//
+//    Each table is a binary file, in the byte order of the machine that
+//    wrote it:
+//
+//       "AAKOZIDT"       8 bytes
+//       version          uint32
+//       entry            uint32        4 or 8
+//       hash             uint64
+//       n                int64
+//       hmax, error      double x 2
+//       (zero padding to HEADER_BYTES)
+//       the n x n table, row by row
+//
+//    The whole square is stored, not just a triangle, so the rows of the
+//    mapping are used in place: the Engine reads a full row per kriging
+//    system.  The header is padded to a page, so the rows are aligned.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "distance_cache.h"
+#include "checkpoint.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace{
+   // Manifest constants.
+   const char     MAGIC[8]     = { 'A', 'A', 'K', 'O', 'Z', 'I', 'D', 'T' };
+   const uint32_t VERSION      = 1;
+   const size_t   HEADER_BYTES = 4096;
+
+   //--------------------------------------------------------------------------
+   // Header
+   //--------------------------------------------------------------------------
+   struct Header
+   {
+      char     magic[8];
+      uint32_t version;
+      uint32_t entry;
+      uint64_t hash;
+      int64_t  n;
+      double   hmax;
+      double   error;
+   };
+}
+
+//=============================================================================
+// DistanceHash
+//=============================================================================
+uint64_t DistanceHash(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const Anisotropy& anisotropy,
+   bool geographic,
+   size_t entry )
+{
+   uint64_t hash = HashBytes( x );
+   hash = HashBytes( y, hash );
+   hash = HashBytes( elev, hash );
+
+   const double settings[] = {
+      anisotropy.angle,
+      anisotropy.ratio,
+      anisotropy.vertical,
+      double( geographic ),
+      double( entry )
+   };
+   return HashBytes( settings, sizeof(settings), hash );
+}
+
+//=============================================================================
+// DistanceCacheName
+//=============================================================================
+std::string DistanceCacheName( const std::string& directory, uint64_t hash )
+{
+   std::ostringstream name;
+   name << directory;
+   if( !directory.empty() && directory.back() != '/' && directory.back() != '\\' )
+      name << '/';
+   name << "aakozi_" << std::hex << std::setw(16) << std::setfill('0') << hash << ".dist";
+   return name.str();
+}
+
+//=============================================================================
+// StoreDistances
+//=============================================================================
+bool StoreDistances( const std::string& filename, uint64_t hash, int n, size_t entry, double hmax, double error, const void* data )
+{
+   assert( entry == 4 || entry == 8 );
+
+   Header header;
+   memcpy( header.magic, MAGIC, 8 );
+   header.version = VERSION;
+   header.entry   = uint32_t( entry );
+   header.hash    = hash;
+   header.n       = n;
+   header.hmax    = hmax;
+   header.error   = error;
+
+   std::vector<char> block( HEADER_BYTES, 0 );
+   memcpy( block.data(), &header, sizeof(header) );
+
+   return WriteAtomically( filename, [&]( FILE* file )
+   {
+      const size_t row = entry * size_t(n);
+      bool written = fwrite( block.data(), 1, HEADER_BYTES, file ) == HEADER_BYTES;
+      for( int i=0; written && i<n; ++i )
+         written = fwrite( static_cast<const char*>(data) + i*row, 1, row, file ) == row;
+      return written;
+   });
+}
+
+//=============================================================================
+// CachedDistances
+//=============================================================================
+CachedDistances::CachedDistances()
+:  m_File(),
+   m_Data( nullptr ),
+   m_MaxEntry( 0.0 ),
+   m_Error( 0.0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+// Map
+//-----------------------------------------------------------------------------
+bool CachedDistances::Map( const std::string& filename, uint64_t hash, int n, size_t entry )
+{
+   m_Data = nullptr;
+   if( !m_File.Map( filename ) )
+      return false;
+
+   Header header;
+   const size_t bytes = HEADER_BYTES + entry * size_t(n) * size_t(n);
+   if( m_File.Bytes() != bytes )
+   {
+      m_File.Release();
+      return false;
+   }
+   memcpy( &header, m_File.Data(), sizeof(header) );
+
+   if( memcmp( header.magic, MAGIC, 8 ) != 0 || header.version != VERSION ||
+       header.entry != entry || header.hash != hash || header.n != n )
+   {
+      m_File.Release();
+      return false;
+   }
+
+   m_Data     = static_cast<const char*>( m_File.Data() ) + HEADER_BYTES;
+   m_MaxEntry = header.hmax;
+   m_Error    = header.error;
+   return true;
+}
+
+//-----------------------------------------------------------------------------
+const void* CachedDistances::Data() const
+{
+   return m_Data;
+}
+
+//-----------------------------------------------------------------------------
+double CachedDistances::MaxEntry() const
+{
+   return m_MaxEntry;
+}
+
+//-----------------------------------------------------------------------------
+double CachedDistances::Error() const
+{
+   return m_Error;
+}
@@ -0,0 +1,80 @@
+//=============================================================================
+// distance_cache.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef DISTANCE_CACHE_H
+#define DISTANCE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "distance.h"
+#include "large_buffer.h"
+
+//=============================================================================
+// DistanceHash
+//
+//    The hash of everything that determines a separation distance table:
+//    the locations (elev is empty in 2-D), the anisotropy, the geographic
+//    flag, and the size of an entry (4 or 8 bytes).
+//=============================================================================
+uint64_t DistanceHash(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const Anisotropy& anisotropy,
+   bool geographic,
+   size_t entry );
+
+//=============================================================================
+// DistanceCacheName
+//
+//    The file in the cache directory for the table with this hash.
+//=============================================================================
+std::string DistanceCacheName( const std::string& directory, uint64_t hash );
+
+//=============================================================================
+// StoreDistances
+//
+//    Add the n x n table of entries of the given size to the cache, with
+//    its largest entry, and the largest error of a single precision table.
+//    Return false if the file could not be written.
+//=============================================================================
+bool StoreDistances( const std::string& filename, uint64_t hash, int n, size_t entry, double hmax, double error, const void* data );
+
+//=============================================================================
+// CachedDistances
+//
+//    A table from the cache, mapped read-only.  Map returns false unless the
+//    file holds a complete n x n table with this hash and entry size.
+//=============================================================================
+class CachedDistances
+{
+public:
+   CachedDistances();
+
+   bool Map( const std::string& filename, uint64_t hash, int n, size_t entry );
+
+   const void* Data() const;
+   double MaxEntry() const;
+   double Error() const;
+
+private:
+   MappedFile  m_File;
+   const void* m_Data;
+   double      m_MaxEntry;
+   double      m_Error;
+};
+
+
+//=============================================================================
+#endif  // DISTANCE_CACHE_H
@@ -0,0 +1,214 @@
+//=============================================================================
+// duplicates.cpp
+//
+//    Detection of co-located and near-duplicate observations by spatial
+//    hashing.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "duplicates.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace{
+   //--------------------------------------------------------------------------
+   // Key
+   //
+   //    A hash key of up to three 64-bit integers: either the bit patterns of
+   //    the coordinates (exact duplicates), or the indices of the cube of
+   //    side "tolerance" containing the observation (near duplicates).
+   //--------------------------------------------------------------------------
+   struct Key
+   {
+      int64_t a, b, c;
+
+      bool operator==( const Key& k ) const
+      {
+         return a == k.a && b == k.b && c == k.c;
+      }
+   };
+
+   struct KeyHash
+   {
+      size_t operator()( const Key& k ) const
+      {
+         uint64_t h = uint64_t(k.a) * 0x9E3779B97F4A7C15ULL;
+         h ^= uint64_t(k.b) + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+         h ^= uint64_t(k.c) + 0x94D049BB133111EBULL + (h << 6) + (h >> 2);
+         return size_t(h);
+      }
+   };
+
+   //--------------------------------------------------------------------------
+   // Bits
+   //
+   //    The bit pattern of a coordinate, with -0 folded onto +0.
+   //--------------------------------------------------------------------------
+   int64_t Bits( double v )
+   {
+      v += 0.0;
+      int64_t b;
+      memcpy( &b, &v, sizeof(b) );
+      return b;
+   }
+
+   //--------------------------------------------------------------------------
+   // Find
+   //
+   //    The root of i in the union-find forest, with path halving.  Every
+   //    root is the smallest index in its tree.
+   //--------------------------------------------------------------------------
+   int Find( std::vector<int>& parent, int i )
+   {
+      while( parent[i] != i )
+      {
+         parent[i] = parent[ parent[i] ];
+         i = parent[i];
+      }
+      return i;
+   }
+}
+
+//=============================================================================
+// FindDuplicates
+//
+// Arguments:
+//    n           the number of observations.
+//
+//    x, y        the observation coordinates.
+//
+//    elev        the observation elevations, or nullptr for 2-D data.
+//
+//    tolerance   observations within this (Euclidean) distance of one
+//                another are duplicates.  With tolerance <= 0 only exactly
+//                co-located observations are duplicates.
+//
+//    group       on exit, the group of each observation.  The groups are
+//                numbered in the order of their first observations.
+//
+//    first       on exit, the index of the first observation in each
+//                group.
+//
+// Return:
+//    The number of groups; i.e. the number of distinct locations.
+//
+// Notes:
+// o  Each observation is hashed once, and compared only with the
+//    observations in the adjacent cubes, so the expected work is O(N).
+//=============================================================================
+int FindDuplicates(
+   int n,
+   const double* x,
+   const double* y,
+   const double* elev,
+   double tolerance,
+   std::vector<int>& group,
+   std::vector<int>& first )
+{
+   const int N = n;
+
+   const bool exact = !( tolerance > 0 );
+   const int  span  = ( exact ? 0 : 1 );
+   const int  zspan = ( elev == nullptr ? 0 : span );
+
+   std::vector<int> parent( N );
+   std::unordered_map< Key, std::vector<int>, KeyHash > cells( 2*N );
+
+   for( int i=0; i<N; ++i )
+   {
+      parent[i] = i;
+
+      const double zi = ( elev != nullptr ) ? elev[i] : 0.0;
+
+      Key key;
+      if( exact )
+      {
+         key.a = Bits( x[i] );
+         key.b = Bits( y[i] );
+         key.c = Bits( zi );
+      }
+      else
+      {
+         key.a = int64_t( floor( x[i]/tolerance ) );
+         key.b = int64_t( floor( y[i]/tolerance ) );
+         key.c = int64_t( floor( zi/tolerance ) );
+      }
+
+      // Compare with the earlier observations in this and the adjacent cells.
+      for( int da=-span; da<=span; ++da )
+      {
+         for( int db=-span; db<=span; ++db )
+         {
+            for( int dc=-zspan; dc<=zspan; ++dc )
+            {
+               auto cell = cells.find( Key{ key.a+da, key.b+db, key.c+dc } );
+               if( cell == cells.end() )
+                  continue;
+
+               for( int j : cell->second )
+               {
+                  if( !exact )
+                  {
+                     double dx = x[i] - x[j];
+                     double dy = y[i] - y[j];
+                     double dz = ( elev != nullptr ) ? zi - elev[j] : 0.0;
+                     if( dx*dx + dy*dy + dz*dz > tolerance*tolerance )
+                        continue;
+                  }
+
+                  int ri = Find( parent, i );
+                  int rj = Find( parent, j );
+                  if( ri < rj )
+                     parent[rj] = ri;
+                  else if( rj < ri )
+                     parent[ri] = rj;
+               }
+            }
+         }
+      }
+
+      cells[key].push_back( i );
+   }
+
+   // Number the groups in the order of their first observations.
+   group.assign( N, -1 );
+   first.clear();
+   for( int i=0; i<N; ++i )
+   {
+      int r = Find( parent, i );
+      if( r == i )
+      {
+         group[i] = first.size();
+         first.push_back( i );
+      }
+      else
+      {
+         group[i] = group[r];
+      }
+   }
+
+   return first.size();
+}
+
+int FindDuplicates(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>* elev,
+   double tolerance,
+   std::vector<int>& group,
+   std::vector<int>& first )
+{
+   assert( x.size() == y.size() );
+   assert( elev == nullptr || elev->size() == x.size() );
+   return FindDuplicates( int(x.size()), x.data(), y.data(), ( elev != nullptr ? elev->data() : nullptr ), tolerance, group, first );
+}
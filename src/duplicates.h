@@ -0,0 +1,43 @@
+//=============================================================================
+// duplicates.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef DUPLICATES_H
+#define DUPLICATES_H
+
+#include <vector>
+
+//=============================================================================
+// FindDuplicates
+//
+//    Group the observations that are co-located, or within the tolerance of
+//    one another (transitively).  Returns the number of groups.  The
+//    coordinates may be given as arrays of n, without a copy.
+//=============================================================================
+int FindDuplicates(
+   int n,
+   const double* x,
+   const double* y,
+   const double* elev,
+   double tolerance,
+   std::vector<int>& group,
+   std::vector<int>& first );
+
+int FindDuplicates(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>* elev,
+   double tolerance,
+   std::vector<int>& group,
+   std::vector<int>& first );
+
+
+//=============================================================================
+#endif  // DUPLICATES_H
@@ -2,7 +2,8 @@
 // engine.cpp
 //
 //    Compute the boomerang statistic for each measured location using a
-//    simple linear variogram model.
+//    simple linear variogram model, or any of the models in
+//    variogram_models.h.
 //
 // author:
 //    Dr. Randal J. Barnes
@@ -13,129 +14,1712 @@
 //    11 June 2017
 //=============================================================================
 #include "engine.h"
+#include "bit_mask.h"
+#include "checkpoint.h"
+#include "distance.h"
+#include "distance_cache.h"
+#include "duplicates.h"
 #include "special_functions.h"
 #include "matrix.h"
 #include "linear_systems.h"
+#include "grid.h"
+#include "large_buffer.h"
+#include "neighbor_lists.h"
+#include "parallel.h"
+#include "random_stream.h"
+#include "shard.h"
+#include "sum_product-inl.h"
 
-#include <numeric>
 #include <math.h>
 #include <iomanip>
+#include <algorithm>
 #include <cassert>
+#include <vector>
+
+namespace{
+   // Manifest constants.
+   const int MINIMUM_COUNT = 10;
+   const int TILE          = 64;        // rows and columns per distance tile
+   const int ERROR_SAMPLE  = 16;        // rows between single precision error checks
+
+   //--------------------------------------------------------------------------
+   // RowTiles
+   //
+   //    The block of row tiles [first, last) that belongs to the given
+   //    thread, out of nthreads.  A distance table is zeroed and filled by
+   //    the same blocks, so each thread first writes, and so places, the
+   //    rows that it later fills.
+   //--------------------------------------------------------------------------
+   void RowTiles( int n, int nthreads, int thread, int& first, int& last )
+   {
+      const int ntiles = ( n + TILE - 1 ) / TILE;
+      first = int( (long long)(ntiles) * thread / nthreads );
+      last  = int( (long long)(ntiles) * (thread+1) / nthreads );
+   }
+
+   //--------------------------------------------------------------------------
+   // DistanceTable
+   //
+   //    A square table of separation distances, in double or single
+   //    precision.  It offers just the part of the Matrix interface that the
+   //    kernels use.  The storage comes from a LargeBuffer, optionally on
+   //    huge pages, and is first written by the pinned worker threads,
+   //    one block of row tiles each (see RowTiles), so the pages are
+   //    spread over the NUMA nodes instead of all landing on the node of
+   //    the calling thread.
+   //
+   //    A table may instead be mapped read-only from the distance cache;
+   //    it is then only used through the const interface.
+   //--------------------------------------------------------------------------
+   template<class T>
+   class DistanceTable
+   {
+   public:
+      DistanceTable() : m_n(0), m_data(nullptr), m_buffer(), m_cached() {}
+
+      void Allocate( int n, const EngineOptions& options )
+      {
+         m_n    = n;
+         m_data = static_cast<T*>( m_buffer.Allocate( sizeof(T)*size_t(n)*n, options.pages ) );
+
+         const int nthreads = ThreadCount( options.threads );
+         ParallelRun( nthreads, [&]( int thread )
+         {
+            int first, last;
+            RowTiles( n, nthreads, thread, first, last );
+            std::fill( Base( std::min(first*TILE, n), 0 ), Base( std::min(last*TILE, n), 0 ), T(0) );
+         }, options.affinity );
+      }
+
+      bool Map( const std::string& filename, uint64_t hash, int n, double& hmax, double& error )
+      {
+         if( !m_cached.Map( filename, hash, n, sizeof(T) ) )
+            return false;
+
+         m_buffer.Release();
+         m_n    = n;
+         m_data = const_cast<T*>( static_cast<const T*>( m_cached.Data() ) );
+         hmax   = m_cached.MaxEntry();
+         error  = m_cached.Error();
+         return true;
+      }
+
+      bool Store( const std::string& filename, uint64_t hash, double hmax, double error ) const
+      {
+         return StoreDistances( filename, hash, m_n, sizeof(T), hmax, error, m_data );
+      }
+
+      int nRows() const                         { return m_n; }
+
+      T        operator()( int i, int j ) const { return m_data[ size_t(i)*m_n + j ]; }
+      T&       operator()( int i, int j )       { return m_data[ size_t(i)*m_n + j ]; }
+      const T* Base( int i, int j ) const       { return m_data + size_t(i)*m_n + j; }
+      T*       Base( int i, int j )             { return m_data + size_t(i)*m_n + j; }
+
+   private:
+      int          m_n;
+      T*           m_data;
+      LargeBuffer  m_buffer;
+      CachedDistances m_cached;
+   };
+
+   //--------------------------------------------------------------------------
+   // MaxEntry
+   //
+   //    The largest separation distance.
+   //--------------------------------------------------------------------------
+   template<class T>
+   double MaxEntry( const DistanceTable<T>& D )
+   {
+      const int N = D.nRows();
+      T m = 0;
+      for( int i=0; i<N; ++i )
+         m = std::max( m, *std::max_element( D.Base(i,0), D.Base(i,0)+N ) );
+      return m;
+   }
+
+   //--------------------------------------------------------------------------
+   // FillTiles
+   //
+   //    Fill the allocated table D in TILE x TILE tiles, with
+   //    Row(i, j, n, d, thread) storing the distances from observation i to
+   //    observations j, ..., j+n-1 in d.
+   //
+   //    Each thread works through its own block of row tiles (RowTiles).
+   //    Row tile I computes the tiles (I, I+d), d = 0, 1, ..., ntiles/2,
+   //    the column tiles taken cyclically, and mirrors each one into the
+   //    rows of its column tile while it is still in cache.  Every pair of
+   //    tiles is computed once, every row tile does about the same work,
+   //    and every write is a contiguous run of up to TILE entries.
+   //--------------------------------------------------------------------------
+   template<class T, class RowFunction>
+   void FillTiles( DistanceTable<T>& D, const EngineOptions& options, const RowFunction& Row )
+   {
+      const int N = D.nRows();
+      const int ntiles = ( N + TILE - 1 ) / TILE;
+      const int nthreads = ThreadCount( options.threads );
+
+      ParallelRun( nthreads, [&]( int thread )
+      {
+         int first, last;
+         RowTiles( N, nthreads, thread, first, last );
+
+         for( int I=first; I<last; ++I )
+         {
+            for( int d=0; d<=ntiles/2; ++d )
+            {
+               // With an even count, the tiles half way round are met from
+               // both ends; only the first half of the row tiles take them.
+               if( 2*d == ntiles && 2*I >= ntiles )
+                  continue;
+
+               const int J  = ( I + d ) % ntiles;
+               const int i0 = I * TILE;
+               const int j0 = J * TILE;
+               const int ni = std::min( TILE, N-i0 );
+               const int nj = std::min( TILE, N-j0 );
+
+               for( int i=i0; i<i0+ni; ++i )
+                  Row( i, j0, nj, D.Base(i,j0), thread );
+
+               if( I != J )
+               {
+                  for( int j=j0; j<j0+nj; ++j )
+                  {
+                     T* Dj = D.Base(j,i0);
+                     for( int i=0; i<ni; ++i )
+                        Dj[i] = D(i0+i, j);
+                  }
+               }
+            }
+         }
+      }, options.affinity );
+   }
+
+   //--------------------------------------------------------------------------
+   // DistanceMatrix
+   //
+   //    Pre-compute the separation distance matrix for all of the
+   //    observations; in 3-D if the elevations are given, or great-circle
+   //    if the coordinates are geographic.  An anisotropy is applied inside
+   //    the vectorized distance kernel.
+   //
+   //    The matrix is built in mirrored TILE x TILE tiles by FillTiles.
+   //    The planar coordinates are centered on the bounding box first,
+   //    which keeps the differences small.
+   //--------------------------------------------------------------------------
+   void DistanceMatrix( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* elev, const EngineOptions& options, DistanceTable<double>& D )
+   {
+      const int N = x.size();
+      const Anisotropy& anisotropy = options.anisotropy;
+
+      std::vector<double> X, Y, Z;
+      if( options.geographic )
+      {
+         UnitVectors( x, y, X, Y, Z );
+      }
+      else
+      {
+         CenterCoordinates( x, y, X, Y );
+      }
+      const double* e = ( elev != nullptr ) ? elev->data() : nullptr;
+
+      // The distances from observation i to observations j, ..., j+n-1.
+      auto Row = [&]( int i, int j, int n, double* d, int )
+      {
+         if( options.geographic )
+            GreatCircleDistances( X[i], Y[i], Z[i], &X[j], &Y[j], &Z[j], n, d );
+         else if( e != nullptr )
+            Distances( X[i], Y[i], e[i], &X[j], &Y[j], e+j, n, anisotropy, d );
+         else if( anisotropy.IsIsotropic() )
+            Distances( X[i], Y[i], &X[j], &Y[j], n, d );
+         else
+            Distances( X[i], Y[i], &X[j], &Y[j], n, anisotropy, d );
+      };
+
+      D.Allocate( N, options );
+      FillTiles( D, options, Row );
+   }
+
+   //--------------------------------------------------------------------------
+   // FloatDistanceMatrix
+   //
+   //    The separation distance matrix in single precision.  The
+   //    coordinates are centered on the bounding box, carried into the
+   //    metric of the anisotropy, and only then rounded to float, so every
+   //    row is computed by the plain single precision kernel.  The matrix
+   //    is built in mirrored tiles by FillTiles, as in DistanceMatrix.
+   //
+   //    The distance error is measured against the double precision rows
+   //    of DistanceMatrix on every ERROR_SAMPLE-th row only; the float
+   //    rounding of the coordinates affects every row alike.
+   //--------------------------------------------------------------------------
+   void FloatDistanceMatrix( const std::vector<double>& x, const std::vector<double>& y, const EngineOptions& options, DistanceTable<float>& D, double& error )
+   {
+      const int N = x.size();
+      const Anisotropy& anisotropy = options.anisotropy;
+
+      std::vector<double> xd, yd;
+      CenterCoordinates( x, y, xd, yd );
+
+      std::vector<double> u, v, w;
+      if( anisotropy.IsIsotropic() )
+      {
+         u = xd;
+         v = yd;
+      }
+      else
+      {
+         MetricCoordinates( N, xd.data(), yd.data(), nullptr, anisotropy, u, v, w );
+      }
+
+      std::vector<float> uf(N), vf(N);
+      for( int i=0; i<N; ++i )
+      {
+         uf[i] = float( u[i] );
+         vf[i] = float( v[i] );
+      }
+
+      const int nthreads = ThreadCount( options.threads );
+      std::vector< std::vector<double> > exact( nthreads, std::vector<double>(TILE) );
+      std::vector<double> errors( nthreads, 0.0 );
+
+      // The float distances from observation i to observations j, ...,
+      // j+n-1, and on the sampled rows the largest difference from the
+      // double ones.
+      auto Row = [&]( int i, int j, int n, float* d, int thread )
+      {
+         Distances( uf[i], vf[i], &uf[j], &vf[j], n, d );
+         if( i % ERROR_SAMPLE != 0 )
+            return;
+
+         double* exact_row = exact[thread].data();
+         if( anisotropy.IsIsotropic() )
+            Distances( xd[i], yd[i], &xd[j], &yd[j], n, exact_row );
+         else
+            Distances( xd[i], yd[i], &xd[j], &yd[j], n, anisotropy, exact_row );
+
+         double& e = errors[thread];
+         for( int k=0; k<n; ++k )
+            e = std::max( e, fabs( double(d[k]) - exact_row[k] ) );
+      };
+
+      D.Allocate( N, options );
+      FillTiles( D, options, Row );
+
+      error = *std::max_element( errors.begin(), errors.end() );
+   }
+
+   //--------------------------------------------------------------------------
+   // SumXi
+   //
+   //    The sum of squares of column r of Xi.  The observations for which
+   //    the kriging system could not be solved (NaN) are left out.
+   //--------------------------------------------------------------------------
+   XiSums SumXi( const Matrix& Xi, int r )
+   {
+      const int N = Xi.nRows();
+
+      XiSums sums;
+      for( int k=0; k<N; ++k )
+      {
+         if( !std::isnan( Xi(k,r) ) )
+         {
+            sums.sum += Xi(k,r)*Xi(k,r);
+            ++sums.count;
+         }
+      }
+      return sums;
+   }
+
+   //--------------------------------------------------------------------------
+   // StdXi
+   //
+   //    The root mean square of column r of Xi.
+   //--------------------------------------------------------------------------
+   double StdXi( const Matrix& Xi, int r )
+   {
+      XiSums sums = SumXi( Xi, r );
+      return sqrt( sums.sum / sums.count );
+   }
+
+   //--------------------------------------------------------------------------
+   // Normalize
+   //
+   //    Normalize the xi to account for the unknown variogram slope, and
+   //    compute the associated p-values.  The sums are also reported, if
+   //    asked for.
+   //--------------------------------------------------------------------------
+   void Normalize( const Matrix& Xi, const EngineOptions& options, std::vector<Boomerang>& results )
+   {
+      const int N = results.size();
+
+      for( int k=0; k<N; ++k )
+         results[k].xi = Xi(k,0);
+
+      XiSums sums = SumXi( Xi, 0 );
+      if( options.xi_sums != nullptr )
+         *options.xi_sums = sums;
+
+      NormalizeXi( sums, results );
+   }
+
+   //--------------------------------------------------------------------------
+   // Skipped
+   //
+   //    True if the observation [k] is to be skipped: either it is not to
+   //    be kriged here (mine[k] == 0), and its estimates are left as they
+   //    are, or after a cancel, in which case they are set to NaN.  An empty
+   //    mine means every observation.
+   //--------------------------------------------------------------------------
+   bool Skipped( const EngineOptions& options, const std::vector<char>& mine, int k, Matrix& Zhat, Matrix& Xi, Matrix& Tau )
+   {
+      if( !mine.empty() && !mine[k] )
+         return true;
+
+      if( options.progress == nullptr || !options.progress->cancel )
+         return false;
+
+      for( int p=0; p<Zhat.nCols(); ++p )
+      {
+         Zhat(k,p) = NAN;
+         Xi(k,p)   = NAN;
+      }
+      Tau(k,0) = NAN;
+      return true;
+   }
+
+   //--------------------------------------------------------------------------
+   // Finished
+   //
+   //    Count one more finished observation, and pass it to the checkpoint.
+   //--------------------------------------------------------------------------
+   void Finished( const EngineOptions& options, Checkpoint* checkpoint, int k )
+   {
+      if( checkpoint != nullptr )
+         checkpoint->Finished( k );
+
+      if( options.progress != nullptr )
+         ++options.progress->completed;
+   }
+
+   //--------------------------------------------------------------------------
+   // DenseKernel
+   //
+   //    Solve each Ordinary Kriging system by a Cholesky decomposition of the
+   //    active slice of the full separation distance matrix.
+   //
+   //    Each column of Z is a separate set of values at the same locations.
+   //    The kriging weights do not depend upon the values, so each system is
+   //    factored once and applied to all of the columns.  Zhat and Xi have
+   //    the same shape as Z, and Tau holds the kriging standard deviation of
+   //    each observation; they and cnt are sized, with cnt = 0, by the
+   //    caller.  Where the system could not be solved, Zhat, Xi and Tau are
+   //    NaN and cnt is 0.
+   //
+   //    The covariances lambda - gamma(D) are assembled directly from the
+   //    distances, with the variogram model inlined.  hmax is the largest
+   //    entry of D.  Only the observations with mine[k] != 0 are kriged,
+   //    or all of them if mine is empty; see Skipped.  Each one finished is
+   //    passed to the checkpoint, if there is one.
+   //--------------------------------------------------------------------------
+   template<class DistanceMatrixType, class Variogram>
+   void DenseKernel(
+      const DistanceMatrixType& D,
+      const Matrix& Z,
+      double radius,
+      bool volumetric,
+      const EngineOptions& options,
+      const Variogram& model,
+      double hmax,
+      const std::vector<char>& mine,
+      Checkpoint* checkpoint,
+      Matrix& Zhat,
+      Matrix& Xi,
+      Matrix& Tau,
+      std::vector<int>& cnt )
+   {
+      const int N = Z.nRows();    // number of observations.
+      const int P = Z.nCols();    // number of sets of values.
+
+      assert( Zhat.nRows() == N && Zhat.nCols() == P && Xi.nRows() == N && Xi.nCols() == P );
+      assert( Tau.nRows() == N && int(cnt.size()) == N );
+
+      std::vector<char> failed(N, 0);
+
+      double lambda = model.Lambda( hmax );
+
+      // The pre-sorted neighbor lists, if they reach far enough.
+      const NeighborLists* neighbors = options.neighbors;
+      if( neighbors != nullptr && ( neighbors->size() != N || radius > neighbors->MaxRadius() || neighbors->IsVolumetric() != volumetric ) )
+         neighbors = nullptr;
+      if( options.geographic )
+         neighbors = nullptr;                // the lists are planar
+      if( neighbors != nullptr && ( neighbors->GetAnisotropy().angle    != options.anisotropy.angle ||
+                                    neighbors->GetAnisotropy().ratio    != options.anisotropy.ratio ||
+                                    neighbors->GetAnisotropy().vertical != options.anisotropy.vertical ) )
+         neighbors = nullptr;
+
+      // The packed set flags are kept per thread.  With neighbor lists they
+      // are restored after each use, so the per-k setup is proportional to
+      // the buffer; otherwise they are regenerated from the distance row.
+      const int nthreads = ThreadCount( options.threads );
+      std::vector<BitMask> actives( nthreads, BitMask(N, true) );
+
+      // Setup and solve the Ordinary Kriging system for the location of
+      // observation [k], given the active set flags.
+      auto Solve = [&]( int k, int M, const BitMask& active )
+      {
+         if( M < MINIMUM_COUNT )
+         {
+            for( int p=0; p<P; ++p )
+            {
+               Zhat(k,p) = NAN;
+               Xi(k,p)   = NAN;
+            }
+            Tau(k,0) = NAN;
+            return;
+         }
+
+         // Setup the Ordinary Kriging system for the location of observation [k].
+         // Only the lower triangle of B is used by the Cholesky decomposition.
+         std::vector<int> index;
+         active.Indices( index );
+
+         Matrix B(M, M), c(M, 1), zactive(M, P);
+         for( int a=0; a<M; ++a )
+         {
+            const auto*   Da = D.Base( index[a], 0 );
+            double*       Ba = B.Base( a, 0 );
+
+            for( int b=0; b<=a; ++b )
+               Ba[b] = lambda - model( Da[index[b]] );
+
+            c(a,0) = lambda - model( Da[k] );
+
+            for( int p=0; p<P; ++p )
+               zactive(a,p) = Z(index[a],p);
+         }
+
+         // Solve the Ordinary Kriging system.
+         Matrix L, u, v, bv, w;
+         Matrix ones(M, 1, 1.0);
+
+         if( CholeskyDecomposition(B,L) )
+         {
+            CholeskySolve(L,c,u);
+            CholeskySolve(L,ones,v);
+
+            double beta = ( Sum(u) - 1 ) / Sum(v);
+
+            Multiply_aM( beta, v, bv );
+            Subtract_MM( u, bv, w );
+
+            double tau = sqrt( lambda - DotProduct(c,w) - beta );
+            for( int p=0; p<P; ++p )
+            {
+               double zhat = SumProduct( M, w.Base(), zactive.Base(0,p), P );
+               Zhat(k,p) = zhat;
+               Xi(k,p)   = ( Z(k,p)-zhat ) / tau;
+            }
+            Tau(k,0) = tau;
+            cnt[k] = M;
+         }
+         else
+         {
+            for( int p=0; p<P; ++p )
+            {
+               Zhat(k,p) = NAN;
+               Xi(k,p)   = NAN;
+            }
+            Tau(k,0) = NAN;
+            failed[k] = 1;
+         }
+      };
+
+      // Pass through the set of observations one at a time.
+      ParallelFor( N, nthreads, [&]( int k, int thread )
+      {
+         if( Skipped( options, mine, k, Zhat, Xi, Tau ) )
+            return;
+
+         // Determine the active subset of the observations for the location of
+         // observation [k]; i.e. those observations outside of the buffer radius.
+         BitMask& active = actives[thread];
+
+         const int* buffer = nullptr;
+         int nbuffer = 0;
+         int M = 0;
+
+         if( neighbors != nullptr )
+         {
+            nbuffer = neighbors->Buffer( k, radius, buffer );
+            for( int i=0; i<nbuffer; ++i )
+               active.Clear( buffer[i] );
+            M = N - nbuffer;
+         }
+         else
+         {
+            GreaterThan( D.Base(k,0), N, radius, active );
+            M = active.Count();
+         }
+
+         Solve( k, M, active );
+
+         // Restore the set flags.
+         if( neighbors != nullptr )
+         {
+            for( int i=0; i<nbuffer; ++i )
+               active.Set( buffer[i] );
+         }
+
+         Finished( options, checkpoint, k );
+      }, options.affinity );
+
+      for( int k=0; k<N; ++k )
+      {
+         if( failed[k] )
+            std::cerr << "WARNING: Cholesky Decompositon failed " << k << std::endl;
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // GridKernel
+   //
+   //    For gridded observations, the separation distance matrix is never
+   //    formed.  Each Ordinary Kriging system is solved by conjugate
+   //    gradients, with the matrix-vector products computed by the FFT.
+   //
+   //    The vectors are kept at full length N with zeros at the inactive
+   //    observations, so the masked operator
+   //
+   //       P (lambda - gamma(D)) P
+   //
+   //    (P = diag(active)) is symmetric positive definite on the active
+   //    subspace, and conjugate gradients never leaves that subspace.  The
+   //    right-hand side is looked up in the operator's table of gamma over
+   //    the node offsets.
+   //
+   //    The arguments Z, model, mine, checkpoint, Zhat, Xi, Tau, and cnt are
+   //    as in DenseKernel.
+   //
+   // Notes:
+   //
+   // o  The cost is not O(N log N).  Each of the N systems costs O(N) to
+   //    set up, and two solves of I iterations, each iteration an FFT pair
+   //    over the embedding of L >= 4 nx ny entries: O(N (N + I L log L))
+   //    in all, with I <= M (or cg_max_iter).  This beats the O(N M^3) of
+   //    the dense kernel when the systems are large and I is much less
+   //    than M, which is what the planner estimates; it does not make
+   //    rasters of a million cells tractable.
+   //
+   // o  The memory is O(L) for the operator, and O(N + L) per thread,
+   //    instead of the N x N distance matrix.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   void GridKernel(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const RegularGrid& grid,
+      const Matrix& Z,
+      double radius,
+      const EngineOptions& options,
+      const Variogram& model,
+      const std::vector<char>& mine,
+      Checkpoint* checkpoint,
+      Matrix& Zhat,
+      Matrix& Xi,
+      Matrix& Tau,
+      std::vector<int>& cnt )
+   {
+      const int N = Z.nRows();    // number of observations.
+      const int P = Z.nCols();    // number of sets of values.
+
+      assert( Zhat.nRows() == N && Zhat.nCols() == P && Xi.nRows() == N && Xi.nCols() == P );
+      assert( Tau.nRows() == N && int(cnt.size()) == N );
+
+      std::vector<char> failed(N, 0);
+
+      ToeplitzDistanceOperator G( grid, options.anisotropy, model );
+      double lambda = model.Lambda( G.MaxDistance() );
+
+      // The active sets are found from the same centered coordinates, and
+      // the same distance kernels, as in DistanceMatrix.
+      std::vector<double> X, Y;
+      CenterCoordinates( x, y, X, Y );
+
+      // Pass through the set of observations one at a time.
+      ParallelFor( N, options.threads, [&]( int k, int )
+      {
+         if( Skipped( options, mine, k, Zhat, Xi, Tau ) )
+            return;
+
+         std::vector< std::complex<double> > work;
+         std::vector<double> dist(N);
+         Matrix active(N, 1), c(N, 1), u, v, Gp, pp(N, 1);
+
+         // The operator: Bp = P (lambda - gamma(D)) P p.
+         auto B = [&]( const Matrix& p, Matrix& Bp )
+         {
+            double s = 0.0;
+            for( int j=0; j<N; ++j )
+            {
+               pp(j,0) = active(j,0) * p(j,0);
+               s += pp(j,0);
+            }
+
+            G.Multiply( pp, Gp, work );
+
+            Bp.Resize( N, 1 );
+            for( int j=0; j<N; ++j )
+               Bp(j,0) = active(j,0) * ( lambda*s - Gp(j,0) );
+         };
+
+         // Determine the active subset, and the right-hand side, for the
+         // location of observation [k].
+         if( options.anisotropy.IsIsotropic() )
+            Distances( X[k], Y[k], X.data(), Y.data(), N, dist.data() );
+         else
+            Distances( X[k], Y[k], X.data(), Y.data(), N, options.anisotropy, dist.data() );
+
+         int M = 0;
+         for( int j=0; j<N; ++j )
+         {
+            if( dist[j] > radius )
+            {
+               active(j,0) = 1.0;
+               c(j,0) = lambda - G.Value(k, j);
+               ++M;
+            }
+            else
+            {
+               active(j,0) = 0.0;
+               c(j,0) = 0.0;
+            }
+         }
+
+         if( M < MINIMUM_COUNT )
+         {
+            for( int p=0; p<P; ++p )
+            {
+               Zhat(k,p) = NAN;
+               Xi(k,p)   = NAN;
+            }
+            Tau(k,0) = NAN;
+            Finished( options, checkpoint, k );
+            return;
+         }
+
+         // Solve the Ordinary Kriging system.
+         const int maxit = options.cg_max_iter > 0 ? options.cg_max_iter : M;
+
+         if( ConjugateGradientSolve( B, c, u, options.cg_tolerance, maxit ) &&
+             ConjugateGradientSolve( B, active, v, options.cg_tolerance, maxit ) )
+         {
+            double beta = ( Sum(u) - 1 ) / Sum(v);
+
+            Matrix w(N, 1);
+            double cw = 0.0;
+            for( int j=0; j<N; ++j )
+            {
+               w(j,0) = u(j,0) - beta*v(j,0);
+               cw += w(j,0) * c(j,0);
+            }
+
+            double tau = sqrt( lambda - cw - beta );
+            for( int p=0; p<P; ++p )
+            {
+               double zhat = SumProduct( N, w.Base(), Z.Base(0,p), P );
+               Zhat(k,p) = zhat;
+               Xi(k,p)   = ( Z(k,p)-zhat ) / tau;
+            }
+            Tau(k,0) = tau;
+            cnt[k] = M;
+         }
+         else
+         {
+            for( int p=0; p<P; ++p )
+            {
+               Zhat(k,p) = NAN;
+               Xi(k,p)   = NAN;
+            }
+            Tau(k,0) = NAN;
+            failed[k] = 1;
+         }
+
+         Finished( options, checkpoint, k );
+      }, options.affinity );
+
+      for( int k=0; k<N; ++k )
+      {
+         if( failed[k] )
+            std::cerr << "WARNING: Conjugate gradients failed to converge " << k << std::endl;
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // Simulate
+   //
+   //    Fill columns 1..R of Z with unconditional realizations of a random
+   //    field with the (pseudo-) covariance lambda - gamma(D).  Column 0 is
+   //    left untouched.
+   //
+   //    Z = L G, where C = LL' and G is a matrix of standard normal
+   //    deviates.  Realization r always uses the random stream seed+r, so
+   //    the realizations do not depend upon the number of threads.
+   //
+   //    hmax is the largest entry of D.  Return false if the covariance
+   //    matrix is not positive definite.
+   //--------------------------------------------------------------------------
+   template<class DistanceMatrixType, class Variogram>
+   bool Simulate( const DistanceMatrixType& D, const Variogram& model, double hmax, uint64_t seed, int nthreads, Matrix& Z )
+   {
+      const int N = Z.nRows();
+      const int R = Z.nCols()-1;
+
+      const double lambda = model.Lambda( hmax );
+
+      Matrix C(N, N), L;
+      for( int i=0; i<N; ++i )
+      {
+         for( int j=0; j<=i; ++j )
+            C(i,j) = lambda - model( D(i,j) );
+      }
+      if( !CholeskyDecomposition(C, L) )
+         return false;
+
+      Matrix G(N, R);
+      ParallelFor( R, nthreads, [&]( int r, int )
+      {
+         std::vector<double> g(N);
+         RandomStream stream( seed + r );
+         stream.Gaussian( g.data(), N );
+
+         for( int i=0; i<N; ++i )
+            G(i,r) = g[i];
+      });
+
+      ParallelFor( N, nthreads, [&]( int i, int )
+      {
+         for( int r=0; r<R; ++r )
+            Z(i,r+1) = SumProduct( i+1, L.Base(i,0), G.Base(0,r), R );
+      });
+
+      return true;
+   }
+
+   //--------------------------------------------------------------------------
+   // EmpiricalPValues
+   //
+   //    Compare the zeta of each observation with the zeta at the same
+   //    location in each of the simulated realizations.  Each realization is
+   //    normalized separately, exactly as the data are.  The tail is chosen
+   //    by the sign of the observed zeta, as in the Gaussian p-value.
+   //--------------------------------------------------------------------------
+   void EmpiricalPValues( const Matrix& Xi, std::vector<Boomerang>& results )
+   {
+      const int N = Xi.nRows();
+      const int R = Xi.nCols()-1;
+
+      std::vector<double> stdXi(R+1);
+      for( int r=0; r<=R; ++r )
+         stdXi[r] = StdXi( Xi, r );
+
+      for( int k=0; k<N; ++k )
+      {
+         if( results[k].cnt == 0 )
+         {
+            results[k].pvalue_mc = NAN;
+            continue;
+         }
+
+         double zeta = results[k].zeta;
+         int count = 0;
+         for( int r=1; r<=R; ++r )
+         {
+            double zr = Xi(k,r)/stdXi[r];
+            if( (zeta < 0 && zr <= zeta) || (zeta >= 0 && zr >= zeta) )
+               ++count;
+         }
+         results[k].pvalue_mc = double(count + 1) / double(R + 1);
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // InputHash
+   //
+   //    The hash of everything that determines the estimates at the
+   //    distinct locations, for the checkpoint.  The variogram models are
+   //    plain structs of doubles, so they are hashed by their bytes.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   uint64_t InputHash(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>& elev,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      bool gridded,
+      bool single,
+      int P,
+      const Variogram& model )
+   {
+      uint64_t hash = HashBytes( x );
+      hash = HashBytes( y, hash );
+      hash = HashBytes( elev, hash );
+      hash = HashBytes( z, hash );
+
+      const double settings[] = {
+         radius,
+         options.anisotropy.angle,
+         options.anisotropy.ratio,
+         options.anisotropy.vertical,
+         options.cg_tolerance,
+         double( options.cg_max_iter ),
+         double( options.geographic ),
+         double( gridded ),
+         double( single ),
+         double( options.shard ),
+         double( options.nshards ),
+         double( P )
+      };
+      hash = HashBytes( settings, sizeof(settings), hash );
+      hash = HashBytes( &options.seed, sizeof(options.seed), hash );
+      return HashBytes( &model, sizeof(model), hash );
+   }
+
+   //--------------------------------------------------------------------------
+   // Finish
+   //
+   //    Fill the results from the estimates and standardized residuals.
+   //--------------------------------------------------------------------------
+   std::vector<Boomerang> Finish( const Matrix& Zhat, const Matrix& Xi, const std::vector<int>& cnt, const EngineOptions& options )
+   {
+      const int N = Zhat.nRows();
+
+      std::vector<Boomerang> results(N);
+      for( int k=0; k<N; ++k )
+      {
+         results[k].zhat      = Zhat(k,0);
+         results[k].cnt       = cnt[k];
+         results[k].pvalue_mc = NAN;
+      }
+
+      Normalize( Xi, options, results );
+
+      if( Xi.nCols() > 1 )
+         EmpiricalPValues( Xi, results );
+
+      return results;
+   }
+
+   //--------------------------------------------------------------------------
+   // Boomerangs
+   //
+   //    The boomerang statistics for 2-D (elev == nullptr) or 3-D
+   //    observations, with the given variogram model: the two phases of a
+   //    BoomerangEngine used once.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   std::vector<Boomerang> Boomerangs(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>* elev,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      const Variogram& model )
+   {
+      BoomerangEngine engine;
+      if( elev != nullptr )
+         engine.Prepare( x, y, *elev, options );
+      else
+         engine.Prepare( x, y, options );
+
+      return engine.Run( z, radius, options, model );
+   }
+}
 
 //=============================================================================
+// BoomerangEngine::Geometry
 //
+//    Everything that depends only upon the locations.
 //=============================================================================
-std::vector<Boomerang> Engine(
-   const std::vector<double>x,
-   const std::vector<double>y,
-   const std::vector<double>z,
-   double radius )
+struct BoomerangEngine::Geometry
 {
-   // Manifest constants.
-   const int MINIMUM_COUNT = 10;
-   const int N = x.size();     // number of observations.
+   int  N;                             // number of observations
+   int  G;                             // number of distinct locations
+   bool volumetric;
+   EngineOptions options;              // the options given to Prepare
+
+   // The duplicate groups, and one location per group.
+   std::vector<int> group, first;
+   std::vector<double> x, y, elev;
+
+   // The FFT solver, for gridded observations.
+   bool gridded;
+   RegularGrid grid;
+
+   // The distance matrix, in double or single precision, and its largest
+   // entry.  It is not formed for gridded observations.
+   bool single;
+   DistanceTable<double> D;
+   DistanceTable<float>  F;
+   double hmax;
+
+   // Optional neighbor lists for the distinct locations.
+   std::unique_ptr<NeighborLists> neighbors;
+};
+
+//=============================================================================
+// BoomerangEngine
+//=============================================================================
+BoomerangEngine::BoomerangEngine()
+:  m_Geometry()
+{
+}
+
+BoomerangEngine::~BoomerangEngine()
+{
+}
+
+bool BoomerangEngine::IsPrepared() const
+{
+   return m_Geometry != nullptr;
+}
+
+int BoomerangEngine::size() const
+{
+   return m_Geometry != nullptr ? m_Geometry->N : 0;
+}
+
+//-----------------------------------------------------------------------------
+// Prepare
+//
+//    Find the co-located observations, which would make the kriging systems
+//    singular, and keep one location per group.  Then detect a regular
+//    grid, or else tabulate the separation distances between the distinct
+//    locations, and build the neighbor lists out to maxradius (if > 0).
+//-----------------------------------------------------------------------------
+void BoomerangEngine::Prepare(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const EngineOptions& options,
+   double maxradius )
+{
+   assert( y.size() == x.size() );
+   Prepare( x.data(), y.data(), nullptr, int(x.size()), options, maxradius );
+}
+
+void BoomerangEngine::Prepare(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const EngineOptions& options,
+   double maxradius )
+{
+   assert( y.size() == x.size() );
+   assert( elev.size() == x.size() );
+   Prepare( x.data(), y.data(), elev.data(), int(x.size()), options, maxradius );
+}
+
+void BoomerangEngine::Prepare(
+   const double* x,
+   const double* y,
+   const double* elev,
+   int n,
+   const EngineOptions& options,
+   double maxradius )
+{
+   const int N = n;            // number of observations.
    assert( N>1 );
+   assert( !( options.geographic && elev != nullptr ) );
 
-   std::vector<Boomerang> results(N);
+   if( options.geographic && !options.anisotropy.IsIsotropic() )
+      std::cerr << "WARNING: the anisotropy is ignored for geographic coordinates." << std::endl;
+
+   m_Geometry.reset( new Geometry );
+   Geometry& g = *m_Geometry;
 
-   // Pre-compute the separation distance matrix for all of the observations.
-   Matrix D(N, N);
-   for( int i=0; i<N-1; ++i )
+   g.N = N;
+   g.volumetric = ( elev != nullptr );
+   g.options = options;
+   g.options.progress = nullptr;
+
+   // Find the co-located observations.  A tolerance is a separation
+   // distance, so the near duplicates are found in coordinates in which
+   // the engine's distance is the Euclidean one: points on the unit sphere
+   // for geographic data, with the tolerance in kilometers converted to a
+   // chord, and otherwise the anisotropic metric.
+   if( options.duplicate_tolerance > 0 )
    {
-      for( int j=i+1; j<N; ++j )
+      std::vector<double> u, v, w;
+      double tolerance = options.duplicate_tolerance;
+      if( options.geographic )
       {
-         D(i,j) = _hypot( x[i]-x[j], y[i]-y[j] );
-         D(j,i) = D(i,j);
+         const double PI = 3.14159265358979323846;
+         UnitVectors( std::vector<double>( x, x+N ), std::vector<double>( y, y+N ), u, v, w );
+         tolerance = 2.0*sin( std::min( 0.5*tolerance/EARTH_RADIUS, 0.5*PI ) );
       }
+      else
+      {
+         MetricCoordinates( N, x, y, elev, options.anisotropy, u, v, w );
+      }
+      g.G = FindDuplicates( N, u.data(), v.data(), ( w.empty() ? nullptr : w.data() ), tolerance, g.group, g.first );
+   }
+   else
+   {
+      g.G = FindDuplicates( N, x, y, elev, 0.0, g.group, g.first );
    }
+   if( g.G < N )
+      std::cerr << "WARNING: " << N-g.G << " duplicate observations in " << g.G << " distinct locations." << std::endl;
+
+   g.x.resize( g.G );
+   g.y.resize( g.G );
+   if( elev != nullptr )
+      g.elev.resize( g.G );
 
-   Matrix Z(N, 1);
-   Matrix Xi(N, 1);
+   for( int i=0; i<g.G; ++i )
+   {
+      g.x[i] = x[ g.first[i] ];
+      g.y[i] = y[ g.first[i] ];
+      if( elev != nullptr )
+         g.elev[i] = elev[ g.first[i] ];
+   }
+
+   // Use the FFT solver for gridded observations, if allowed.
+   g.gridded = false;
+   if( options.grid_mode != GRID_OFF && ( elev != nullptr || options.geographic ) )
+   {
+      std::cerr << "WARNING: the FFT solver is 2-D planar only; using the dense solver." << std::endl;
+   }
+   else if( options.grid_mode == GRID_ON )
+   {
+      g.gridded = DetectRegularGrid( g.x, g.y, g.grid );
 
-   for( int k=0; k<N; ++k )
-      Z(k,0) = z[k];
+      if( !g.gridded )
+         std::cerr << "WARNING: the observations are not on a regular grid; using the dense solver." << std::endl;
+   }
 
-   double lambda = MaxAbs(D);
+   // The single precision distances are for 2-D planar coordinates.
+   g.single = options.single_precision && elev == nullptr && !options.geographic;
+   if( options.single_precision && !g.single )
+      std::cerr << "WARNING: single precision distances are 2-D planar only; using double precision." << std::endl;
 
-   // Pass through the set of observations one at a time.
-   for( int k=0; k<N; ++k )
+   // The full distance matrix is required by the dense solver.  It is
+   // mapped from the distance cache, if it is there, and otherwise added.
+   g.hmax = 0.0;
+   if( !g.gridded )
    {
-      // Determine the active subset of the observations for the location of
-      // observation [k]; i.e. those observations outside of the buffer radius.
-      std::vector<int> current(N, 0);
-      current[k] = 1;
+      const bool cached = !options.distance_cache.empty();
+      uint64_t hash = 0;
+      std::string filename;
+      if( cached )
+      {
+         hash = DistanceHash( g.x, g.y, g.elev, options.anisotropy, options.geographic, g.single ? sizeof(float) : sizeof(double) );
+         filename = DistanceCacheName( options.distance_cache, hash );
+      }
+
+      bool stored = true;
+      if( g.single )
+      {
+         double error = 0.0;
+         if( !cached || !g.F.Map( filename, hash, g.G, g.hmax, error ) )
+         {
+            FloatDistanceMatrix( g.x, g.y, options, g.F, error );
+            g.hmax = MaxEntry( g.F );
+            if( cached )
+               stored = g.F.Store( filename, hash, g.hmax, error );
+         }
+         if( options.distance_error != nullptr )
+            *options.distance_error = error;
+      }
+      else
+      {
+         double error = 0.0;
+         if( !cached || !g.D.Map( filename, hash, g.G, g.hmax, error ) )
+         {
+            DistanceMatrix( g.x, g.y, ( g.volumetric ? &g.elev : nullptr ), options, g.D );
+            g.hmax = MaxEntry( g.D );
+            if( cached )
+               stored = g.D.Store( filename, hash, g.hmax, 0.0 );
+         }
+      }
+
+      if( !stored )
+         std::cerr << "WARNING: could not add the distances to the cache <" << filename << ">." << std::endl;
+   }
+
+   // The neighbor lists are planar.
+   if( maxradius > 0 && !g.gridded && !options.geographic )
+   {
+      if( g.volumetric )
+         g.neighbors.reset( new NeighborLists( g.x, g.y, g.elev, maxradius, options.threads, options.anisotropy ) );
+      else
+         g.neighbors.reset( new NeighborLists( g.x, g.y, maxradius, options.threads, options.anisotropy ) );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Run
+//
+//    The boomerang statistics for the values z at the prepared locations.
+//
+//    Each group of co-located observations is reduced to a single location
+//    according to the duplicate policy:
+//
+//    o  DUPLICATES_AVERAGE: one observation with the mean value; each
+//       member of the group gets the results of the merged observation.
+//
+//    o  DUPLICATES_FIRST: the first observation of the group is kept;
+//       the others are dropped, with NaN results and cnt = 0.
+//
+//    o  DUPLICATES_GROUP: the members are replicates.  The group enters
+//       the other kriging systems once, with the mean value, and each
+//       member is compared with the estimate at the group's location.
+//-----------------------------------------------------------------------------
+std::vector<Boomerang> BoomerangEngine::Run(
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options ) const
+{
+   return Run( z, radius, options, LinearVariogram() );
+}
+
+template<class Variogram>
+std::vector<Boomerang> BoomerangEngine::Run(
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model ) const
+{
+   assert( int(z.size()) == size() );
+   return Run( z.data(), radius, options, model );
+}
+
+template<class Variogram>
+std::vector<Boomerang> BoomerangEngine::Run(
+   const double* z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model ) const
+{
+   assert( IsPrepared() );
+
+   const Geometry& g = *m_Geometry;
+   const int N = g.N;          // number of observations.
+   const int G = g.G;          // number of distinct locations.
+   const int R = ( options.nshards > 1 ? 0 : std::max( options.simulations, 0 ) );
+   assert( 0 <= options.shard && options.shard < options.nshards );
+
+   if( options.nshards > 1 && options.simulations > 0 )
+      std::cerr << "WARNING: the simulations are not sharded; no simulations." << std::endl;
+
+   // The geometric options are those given to Prepare.
+   EngineOptions run = options;
+   run.grid_mode        = g.options.grid_mode;
+   run.anisotropy       = g.options.anisotropy;
+   run.geographic       = g.options.geographic;
+   run.single_precision = g.options.single_precision;
+   run.pages            = g.options.pages;
+
+   if( g.neighbors != nullptr )
+      run.neighbors = g.neighbors.get();
+   else if( G < N )
+      run.neighbors = nullptr;      // the lists for all of the observations do not apply
 
-      std::vector<int> first(1, 0);
-      first[0] = 1;
+   // The locations of this shard.
+   std::vector<char> mine;
+   int nmine = G;
+   if( options.nshards > 1 )
+   {
+      std::vector<int> shard;
+      AssignShards( g.x, g.y, options.nshards, shard );
 
-      std::vector<int> active(N);
-      for( int j=0; j<N; ++j)
+      mine.resize( G );
+      nmine = 0;
+      for( int k=0; k<G; ++k )
       {
-         if( D(k,j) > radius )
-            active[j] = 1;
-         else
-            active[j] = 0;
+         mine[k] = ( shard[k] == options.shard );
+         nmine += mine[k];
       }
-      int M = std::accumulate(active.begin(), active.end(), int(0));
+   }
+
+   if( run.progress != nullptr )
+   {
+      run.progress->total     = nmine;
+      run.progress->completed = 0;
+   }
+
+   // One value per location.
+   std::vector<double> zg(G, 0.0);
+   std::vector<int> size(G, 0);
+   for( int i=0; i<N; ++i )
+   {
+      zg[ g.group[i] ] += z[i];
+      ++size[ g.group[i] ];
+   }
+   for( int i=0; i<G; ++i )
+   {
+      if( options.duplicates == DUPLICATES_FIRST )
+         zg[i] = z[ g.first[i] ];
+      else
+         zg[i] /= size[i];
+   }
+
+   // Column 0 holds the data; columns 1..R the simulated realizations.
+   Matrix Z(G, R+1);
+   for( int k=0; k<G; ++k )
+      Z(k,0) = zg[k];
 
-      if( M < MINIMUM_COUNT )
+   bool simulated = true;
+   if( R > 0 && !( run.progress != nullptr && run.progress->cancel ) )
+   {
+      if( g.gridded )
       {
-         results[k].zhat   = NAN;
-         results[k].zeta   = NAN;
-         results[k].pvalue = NAN;
-         results[k].cnt    = 0;
-         continue;
+         // The distance matrix is needed to simulate, even on a grid.
+         DistanceTable<double> D;
+         DistanceMatrix( g.x, g.y, nullptr, run, D );
+         simulated = Simulate( D, model, MaxEntry(D), run.seed, run.threads, Z );
+      }
+      else if( g.single )
+      {
+         simulated = Simulate( g.F, model, g.hmax, run.seed, run.threads, Z );
       }
+      else
+      {
+         simulated = Simulate( g.D, model, g.hmax, run.seed, run.threads, Z );
+      }
+   }
 
-      // Setup the Ordinary Kriging system for the location of observation [k].
-      Matrix A, B;
-      Slice(D, active, active, A);
-      Subtract_aM(lambda, A, B);
+   if( !simulated )
+   {
+      std::cerr << "WARNING: the covariance matrix is not positive definite; no simulations." << std::endl;
 
-      Matrix b, c;
-      Slice(D, active, current, b);
-      Subtract_aM(lambda, b, c);
+      Matrix Z1(G, 1);
+      for( int k=0; k<G; ++k )
+         Z1(k,0) = zg[k];
+      Z = Z1;
+   }
 
-      Matrix zactive;
-      Slice(Z, active, first, zactive);
+   // The estimates at the distinct locations.  Those of the other shards
+   // are NaN.
+   const int P = Z.nCols();
+   Matrix Zhat(G, P), Xi(G, P), Tau(G, 1);
+   std::vector<int> cnt(G, 0);
 
-      // Solve the Ordinary Kriging system.
-      Matrix L, u, v, bv, w;
-      Matrix ones(M, 1, 1.0);
+   for( int k=0; k<int(mine.size()); ++k )
+   {
+      if( !mine[k] )
+      {
+         for( int p=0; p<P; ++p )
+         {
+            Zhat(k,p) = NAN;
+            Xi(k,p)   = NAN;
+         }
+         Tau(k,0) = NAN;
+      }
+   }
 
-      if( CholeskyDecomposition(B,L) )
+   // Restore the estimates saved by an interrupted run, and krige the rest.
+   std::unique_ptr<Checkpoint> checkpoint;
+   if( !run.checkpoint.empty() )
+   {
+      const uint64_t hash = InputHash( g.x, g.y, g.elev, zg, radius, run, g.gridded, g.single, P, model );
+      checkpoint.reset( new Checkpoint( run.checkpoint, hash, run.checkpoint_interval, Zhat, Xi, Tau, cnt ) );
+
+      if( run.resume && checkpoint->Load() > 0 )
       {
-         CholeskySolve(L,c,u);
-         CholeskySolve(L,ones,v);
+         if( mine.empty() )
+            mine.assign( G, 1 );
+
+         int restored = 0;
+         for( int k=0; k<G; ++k )
+         {
+            if( checkpoint->IsFinished(k) )
+            {
+               mine[k] = 0;
+               ++restored;
+            }
+         }
+
+         if( run.progress != nullptr )
+            run.progress->completed = restored;
+      }
+   }
+
+   if( g.gridded )
+      GridKernel( g.x, g.y, g.grid, Z, radius, run, model, mine, checkpoint.get(), Zhat, Xi, Tau, cnt );
+   else if( g.single )
+      DenseKernel( g.F, Z, radius, false, run, model, g.hmax, mine, checkpoint.get(), Zhat, Xi, Tau, cnt );
+   else
+      DenseKernel( g.D, Z, radius, g.volumetric, run, model, g.hmax, mine, checkpoint.get(), Zhat, Xi, Tau, cnt );
+
+   if( checkpoint != nullptr )
+      checkpoint->Save();
 
-         double beta = ( Sum(u) - 1 ) / Sum(v);
+   if( G == N )
+      return Finish( Zhat, Xi, cnt, run );
 
-         Multiply_aM( beta, v, bv );
-         Subtract_MM( u, bv, w );
+   // Expand the results to all of the observations.
+   if( options.duplicates == DUPLICATES_GROUP )
+   {
+      const int P = Xi.nCols();
+      Matrix ZhatN(N, 1), XiN(N, P);
+      std::vector<int> cntN(N);
 
-         double zhat = DotProduct(w,zactive);
-         double tau2 = lambda - DotProduct(c,w) - beta;
-         Xi(k,0) = ( z[k]-zhat ) / sqrt(tau2);
+      for( int i=0; i<N; ++i )
+      {
+         const int k = g.group[i];
+         ZhatN(i,0) = Zhat(k,0);
+         XiN(i,0)   = ( z[i] - Zhat(k,0) ) / Tau(k,0);
+         for( int p=1; p<P; ++p )
+            XiN(i,p) = Xi(k,p);
+         cntN[i] = cnt[k];
+      }
+      return Finish( ZhatN, XiN, cntN, run );
+   }
 
-         results[k].zhat = zhat;
-         results[k].cnt  = M;
+   std::vector<Boomerang> merged = Finish( Zhat, Xi, cnt, run );
+   std::vector<Boomerang> results(N);
+   for( int i=0; i<N; ++i )
+   {
+      const int k = g.group[i];
+      if( options.duplicates == DUPLICATES_FIRST && i != g.first[k] )
+      {
+         results[i].zhat      = NAN;
+         results[i].zeta      = NAN;
+         results[i].pvalue    = NAN;
+         results[i].pvalue_mc = NAN;
+         results[i].xi        = NAN;
+         results[i].cnt       = 0;
       }
       else
       {
-         std::cerr << "WARNING: Cholesky Decompositon failed " << k << std::endl;
+         results[i] = merged[k];
       }
    }
 
-   // Normalize the xi to account for the unknown variogram slope.
-   double stdXi = sqrt( DotProduct(Xi, Xi) / N );
+   return results;
+}
+
+//=============================================================================
+// NormalizeXi
+//=============================================================================
+void NormalizeXi( const XiSums& sums, std::vector<Boomerang>& results )
+{
+   const int N = results.size();
+
+   double stdXi = sqrt( sums.sum / sums.count );
    for( int k=0; k<N; ++k)
    {
-      results[k].zeta = Xi(k,0)/stdXi;
+      results[k].zeta = results[k].xi/stdXi;
 
-      if( results[k].zeta < 0 )
+      // The series in GaussianCDF does not terminate for a NaN.
+      if( std::isnan( results[k].zeta ) )
+         results[k].pvalue = NAN;
+      else if( results[k].zeta < 0 )
          results[k].pvalue = GaussianCDF(results[k].zeta);
       else
          results[k].pvalue = 1 - GaussianCDF(results[k].zeta);
    }
-   return results;
 }
+
+//=============================================================================
+//
+//=============================================================================
+std::vector<Boomerang> Engine(
+   const std::vector<double>x,
+   const std::vector<double>y,
+   const std::vector<double>z,
+   double radius )
+{
+   return Engine( x, y, z, radius, EngineOptions() );
+}
+
+//=============================================================================
+//
+//=============================================================================
+std::vector<Boomerang> Engine(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options )
+{
+   return Engine( x, y, z, radius, options, LinearVariogram() );
+}
+
+//=============================================================================
+//
+//=============================================================================
+template<class Variogram>
+std::vector<Boomerang> Engine(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model )
+{
+   return Boomerangs( x, y, nullptr, z, radius, options, model );
+}
+
+//=============================================================================
+//
+//=============================================================================
+std::vector<Boomerang> Engine(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options )
+{
+   return Engine( x, y, elev, z, radius, options, LinearVariogram() );
+}
+
+//=============================================================================
+//
+//=============================================================================
+template<class Variogram>
+std::vector<Boomerang> Engine(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model )
+{
+   assert( elev.size() == x.size() );
+   return Boomerangs( x, y, &elev, z, radius, options, model );
+}
+
+//=============================================================================
+// EngineJob
+//=============================================================================
+EngineJob::EngineJob()
+:  m_Progress(),
+   m_Result(),
+   m_Start( std::chrono::steady_clock::now() )
+{
+}
+
+EngineJob::EngineJob( const std::shared_ptr<EngineProgress>& progress, const std::shared_future< std::vector<Boomerang> >& result )
+:  m_Progress( progress ),
+   m_Result( result ),
+   m_Start( std::chrono::steady_clock::now() )
+{
+}
+
+bool EngineJob::Valid() const
+{
+   return m_Progress != nullptr && m_Result.valid();
+}
+
+bool EngineJob::Ready() const
+{
+   assert( Valid() );
+   return m_Result.wait_for( std::chrono::seconds(0) ) == std::future_status::ready;
+}
+
+int EngineJob::Completed() const
+{
+   assert( Valid() );
+   return m_Progress->completed;
+}
+
+int EngineJob::Total() const
+{
+   assert( Valid() );
+   return m_Progress->total;
+}
+
+double EngineJob::SecondsRemaining() const
+{
+   assert( Valid() );
+
+   const int completed = m_Progress->completed;
+   const int total     = m_Progress->total;
+   if( completed <= 0 )
+      return NAN;
+
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_Start;
+   return elapsed.count() * double( std::max(total - completed, 0) ) / double( completed );
+}
+
+void EngineJob::Cancel()
+{
+   assert( Valid() );
+   m_Progress->cancel = true;
+}
+
+bool EngineJob::Cancelled() const
+{
+   assert( Valid() );
+   return m_Progress->cancel;
+}
+
+void EngineJob::Wait() const
+{
+   assert( Valid() );
+   m_Result.wait();
+}
+
+std::vector<Boomerang> EngineJob::Get() const
+{
+   assert( Valid() );
+   return m_Result.get();
+}
+
+namespace{
+   //--------------------------------------------------------------------------
+   // Launch
+   //
+   //    Run the Boomerangs on a pooled thread with the job's own progress.
+   //    The data are copied into the task.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   EngineJob Launch(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>* elev,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      const Variogram& model )
+   {
+      auto progress = std::make_shared<EngineProgress>();
+      progress->total = x.size();
+
+      EngineOptions job = options;
+      job.progress = progress.get();
+
+      const bool volumetric = ( elev != nullptr );
+      std::vector<double> e = volumetric ? *elev : std::vector<double>();
+
+      auto task = std::make_shared< std::packaged_task< std::vector<Boomerang>() > >(
+         [=]()
+         {
+            return Boomerangs( x, y, ( volumetric ? &e : nullptr ), z, radius, job, model );
+         } );
+
+      EngineJob handle( progress, task->get_future().share() );
+      RunAsync( [task]{ (*task)(); } );
+      return handle;
+   }
+}
+
+//=============================================================================
+//
+//=============================================================================
+EngineJob EngineAsync(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options )
+{
+   return EngineAsync( x, y, z, radius, options, LinearVariogram() );
+}
+
+//=============================================================================
+//
+//=============================================================================
+template<class Variogram>
+EngineJob EngineAsync(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model )
+{
+   return Launch( x, y, nullptr, z, radius, options, model );
+}
+
+//=============================================================================
+//
+//=============================================================================
+EngineJob EngineAsync(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options )
+{
+   return EngineAsync( x, y, elev, z, radius, options, LinearVariogram() );
+}
+
+//=============================================================================
+//
+//=============================================================================
+template<class Variogram>
+EngineJob EngineAsync(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z,
+   double radius,
+   const EngineOptions& options,
+   const Variogram& model )
+{
+   assert( elev.size() == x.size() );
+   return Launch( x, y, &elev, z, radius, options, model );
+}
+
+//=============================================================================
+// Explicit instantiations for the variogram models in variogram_models.h.
+//=============================================================================
+#define INSTANTIATE_ENGINE( Variogram )   \
+   template std::vector<Boomerang> Engine<Variogram>( \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& );                 \
+   template std::vector<Boomerang> Engine<Variogram>( \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& );                 \
+   template EngineJob EngineAsync<Variogram>( \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& );                 \
+   template EngineJob EngineAsync<Variogram>( \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& );                 \
+   template std::vector<Boomerang> BoomerangEngine::Run<Variogram>( \
+      const std::vector<double>&,         \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& ) const;           \
+   template std::vector<Boomerang> BoomerangEngine::Run<Variogram>( \
+      const double*,                      \
+      double,                             \
+      const EngineOptions&,               \
+      const Variogram& ) const;
+
+INSTANTIATE_ENGINE( LinearVariogram )
+INSTANTIATE_ENGINE( PowerVariogram )
+INSTANTIATE_ENGINE( ExponentialVariogram )
+INSTANTIATE_ENGINE( SphericalVariogram )
+INSTANTIATE_ENGINE( GaussianVariogram )
+
+#undef INSTANTIATE_ENGINE
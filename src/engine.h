@@ -12,8 +12,21 @@
 #ifndef AAKOZI_ENGINE_H
 #define AAKOZI_ENGINE_H
 
+#include "distance.h"
+#include "large_buffer.h"
+#include "parallel.h"
+#include "variogram_models.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
+class NeighborLists;
+
 //=============================================================================
 // Boomerang
 //=============================================================================
@@ -22,11 +35,241 @@ struct Boomerang
    double   zhat;
    double   zeta;
    double   pvalue;
+   double   pvalue_mc;              // empirical p-value from the simulated null
+   double   xi;                     // standardized residual, before normalization
    int      cnt;
 };
 
+//=============================================================================
+// XiSums
+//
+//    The sum of the squared standardized residuals, and their number, over
+//    the observations that were kriged.  Each xi is normalized by
+//    sqrt(sum/count).  A sharded run reports its partial sums; the sums of
+//    all of the shards are added before the normalization.
+//=============================================================================
+struct XiSums
+{
+   double   sum   = 0.0;
+   int      count = 0;
+};
+
+//=============================================================================
+// EngineProgress
+//
+//    Shared between a running Engine and any other thread.  The Engine
+//    counts the observations as their kriging systems are finished, and
+//    checks the cancel flag before starting each one.  The observations not
+//    started after a cancel have NaN results and cnt = 0.
+//=============================================================================
+struct EngineProgress
+{
+   std::atomic<int>  completed{0};
+   std::atomic<int>  total{0};      // the distinct locations
+   std::atomic<bool> cancel{false};
+};
+
+//=============================================================================
+// EngineOptions
+//=============================================================================
+enum GridMode
+{
+   GRID_OFF,                        // always use the dense per-k solver
+   GRID_ON                          // use the FFT solver if the data are gridded
+};
+
+enum DuplicatePolicy
+{
+   DUPLICATES_AVERAGE,              // merge each group, with the mean value
+   DUPLICATES_FIRST,                // keep the first of each group
+   DUPLICATES_GROUP                 // treat each group as replicates
+};
+
+struct EngineOptions
+{
+   GridMode grid_mode      = GRID_OFF;
+   double   cg_tolerance   = 1e-10; // relative residual for the FFT solver
+   int      cg_max_iter    = 0;     // 0 --> the number of active observations
+
+   int      threads        = 0;     // 0 --> all of the hardware threads
+   AffinityPolicy affinity = AFFINITY_NONE;
+   PagePolicy     pages    = PAGES_DEFAULT;   // for the distance matrix
+   int      simulations    = 0;     // number of simulated null realizations
+   uint64_t seed           = 20170611;
+
+   Anisotropy anisotropy;           // geometric anisotropy of the distances
+
+   // Store the centered coordinates and the distances in single precision;
+   // the kriging systems are still factored in double precision.  If
+   // distance_error is set, it receives the largest distance error found
+   // on a sample of the rows.
+   bool     single_precision = false;
+   double*  distance_error   = nullptr;
+
+   // Co-located observations, or those within the tolerance of one another,
+   // are grouped before any kriging system is factored.  The tolerance is a
+   // separation distance, measured as the engine measures them: with the
+   // anisotropy (and the vertical factor in 3-D), or in great-circle
+   // kilometers for geographic coordinates.
+   DuplicatePolicy duplicates          = DUPLICATES_AVERAGE;
+   double          duplicate_tolerance = 0.0;   // 0 --> exactly co-located only
+
+   // Geographic coordinates: x is the longitude and y the latitude, in
+   // degrees, and the distances (and the radius) are great-circle
+   // kilometers.  2-D and isotropic only.
+   bool     geographic     = false;
+
+   // Optional directory of cached distance tables.  The table for these
+   // locations is mapped read-only from it if it is there, and is otherwise
+   // computed and added, so later runs on the same locations, and runs at
+   // the same time on the same node, share one copy in the page cache.
+   std::string distance_cache;
+
+   // Optional pre-sorted neighbor lists for these observations.  They are
+   // used if the buffer radius does not exceed their maximum radius, and
+   // they were built with the same anisotropy.
+   const NeighborLists* neighbors = nullptr;
+
+   // Optional progress counters and cancel flag; see EngineProgress.
+   EngineProgress* progress = nullptr;
+
+   // Sharded execution, to split one job over several processes: only the
+   // distinct locations that AssignShards deals to shard (0 <= shard <
+   // nshards) are kriged; the other observations have NaN results and
+   // cnt = 0.  The zeta and p-values are normalized over this shard alone;
+   // NormalizeXi with the sums of all of the shards gives the global ones.
+   // There are no simulations in a sharded run.
+   int      shard          = 0;
+   int      nshards        = 1;
+
+   // If set, receives the sums used to normalize the xi.
+   XiSums*  xi_sums        = nullptr;
+
+   // Optional checkpoint file.  If named, the finished kriging systems are
+   // saved to it about every checkpoint_interval seconds, and at the end,
+   // with a hash of the inputs and the radius.  With resume, the systems
+   // saved by an earlier run with the same hash are not solved again.
+   std::string checkpoint;
+   double      checkpoint_interval = 300.0;
+   bool        resume              = false;
+};
+
 //=============================================================================
 std::vector<Boomerang> Engine( const std::vector<double>x, const std::vector<double>y, const std::vector<double>z, double radius );
+std::vector<Boomerang> Engine( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double radius, const EngineOptions& options );
+
+// The Engine with a variogram model from variogram_models.h; the two
+// overloads above use the LinearVariogram.  Instantiated in engine.cpp for
+// each of those models.
+template<class Variogram>
+std::vector<Boomerang> Engine( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double radius, const EngineOptions& options, const Variogram& model );
+
+// The Engine for 3-D observations at (x, y, elev).
+std::vector<Boomerang> Engine( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const std::vector<double>& z, double radius, const EngineOptions& options );
+
+template<class Variogram>
+std::vector<Boomerang> Engine( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const std::vector<double>& z, double radius, const EngineOptions& options, const Variogram& model );
+
+// Set the zeta and the p-values of the results from their xi, given the
+// sums of the squared xi; the pvalue_mc are not changed.
+void NormalizeXi( const XiSums& sums, std::vector<Boomerang>& results );
+
+//=============================================================================
+// BoomerangEngine
+//
+//    The Engine in two phases, for many sets of values at the same
+//    locations.  Prepare does everything that depends only upon the
+//    locations: the duplicate groups, the grid detection, the separation
+//    distance matrix and its largest entry, and, if maxradius > 0, the
+//    neighbor lists out to maxradius.  Run then krigs each set of values,
+//    at any radius.
+//
+//    Prepare fixes the geometric options: grid_mode, anisotropy,
+//    geographic, single_precision, distance_error, pages, distance_cache
+//    and duplicate_tolerance.  Run takes everything else from its own options.
+//    Run does not change the engine, so several may run at once.
+//
+//    The coordinates and the values may also be given as arrays of n
+//    (elev may be nullptr for 2-D data), which are read but not copied.
+//=============================================================================
+class BoomerangEngine
+{
+public:
+   BoomerangEngine();
+   ~BoomerangEngine();
+
+   void Prepare( const std::vector<double>& x, const std::vector<double>& y, const EngineOptions& options, double maxradius = 0.0 );
+   void Prepare( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const EngineOptions& options, double maxradius = 0.0 );
+   void Prepare( const double* x, const double* y, const double* elev, int n, const EngineOptions& options, double maxradius = 0.0 );
+
+   bool IsPrepared() const;
+   int  size() const;
+
+   std::vector<Boomerang> Run( const std::vector<double>& z, double radius, const EngineOptions& options ) const;
+
+   template<class Variogram>
+   std::vector<Boomerang> Run( const std::vector<double>& z, double radius, const EngineOptions& options, const Variogram& model ) const;
+
+   template<class Variogram>
+   std::vector<Boomerang> Run( const double* z, double radius, const EngineOptions& options, const Variogram& model ) const;
+
+private:
+   BoomerangEngine( const BoomerangEngine& ) = delete;
+   BoomerangEngine& operator=( const BoomerangEngine& ) = delete;
+
+   struct Geometry;
+   std::unique_ptr<Geometry> m_Geometry;
+};
+
+//=============================================================================
+// EngineJob
+//
+//    The handle to an Engine running on a pooled thread, returned by
+//    EngineAsync.  Copies of the handle share the same job.
+//
+//    SecondsRemaining extrapolates the time per finished observation since
+//    the job was started; it is NaN until the first one is finished.
+//    Cancel returns at once; the running observations are finished, and the
+//    rest are skipped.  Get waits for the job, and returns the (partial, if
+//    cancelled) results.
+//=============================================================================
+class EngineJob
+{
+public:
+   EngineJob();
+   EngineJob( const std::shared_ptr<EngineProgress>& progress, const std::shared_future< std::vector<Boomerang> >& result );
+
+   bool   Valid() const;
+   bool   Ready() const;
+   int    Completed() const;
+   int    Total() const;
+   double SecondsRemaining() const;
+
+   void   Cancel();
+   bool   Cancelled() const;
+
+   void   Wait() const;
+   std::vector<Boomerang> Get() const;
+
+private:
+   std::shared_ptr<EngineProgress>              m_Progress;
+   std::shared_future< std::vector<Boomerang> > m_Result;
+   std::chrono::steady_clock::time_point        m_Start;
+};
+
+// The asynchronous Engine.  The coordinates and values are copied; the
+// objects pointed to by the options (neighbors, distance_error) must
+// outlive the job.  Any progress set in the options is replaced by the
+// job's own.
+EngineJob EngineAsync( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double radius, const EngineOptions& options );
+
+template<class Variogram>
+EngineJob EngineAsync( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double radius, const EngineOptions& options, const Variogram& model );
+
+EngineJob EngineAsync( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const std::vector<double>& z, double radius, const EngineOptions& options );
+
+template<class Variogram>
+EngineJob EngineAsync( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const std::vector<double>& z, double radius, const EngineOptions& options, const Variogram& model );
 
 
 //=============================================================================
@@ -0,0 +1,184 @@
+//=============================================================================
+// fft.cpp
+//
+//    A minimal radix-2 fast Fourier transform, in one and two dimensions.
+//
+// references:
+// o  Cooley, J.W., and Tukey, J.W., 1965, An algorithm for the machine
+//    calculation of complex Fourier series, Mathematics of Computation,
+//    v. 19, pp. 297-301.
+//
+// o  Press, W.H., Teukolsky, S.A., Vetterling, W.T., and Flannery, B.P.,
+//    2007, NUMERICAL RECIPES, 3rd Edition, Cambridge University Press,
+//    Section 12.2.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "fft.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "numerical_constants.h"
+
+//-----------------------------------------------------------------------------
+// NextPowerOfTwo
+//
+//    Return the smallest power of two that is >= n.
+//-----------------------------------------------------------------------------
+int NextPowerOfTwo( int n )
+{
+   int p = 1;
+   while( p < n )
+      p <<= 1;
+   return p;
+}
+
+namespace{
+   //--------------------------------------------------------------------------
+   // Twiddles
+   //
+   //    The n/2 twiddle factors for a transform of length n.
+   //--------------------------------------------------------------------------
+   std::vector< std::complex<double> > Twiddles( int n, bool inverse )
+   {
+      const double sign = inverse ? 1.0 : -1.0;
+
+      std::vector< std::complex<double> > w( n/2 );
+      for( int k=0; k<n/2; ++k )
+         w[k] = std::polar( 1.0, sign*TWO_PI*k/n );
+
+      return w;
+   }
+
+   //--------------------------------------------------------------------------
+   // Radix2
+   //
+   //    The iterative, decimation-in-time, Cooley-Tukey algorithm applied to
+   //    the n values starting at a.  The twiddle factors w were computed for
+   //    a transform of length m >= n; both n and m are powers of two.
+   //--------------------------------------------------------------------------
+   void Radix2( std::complex<double>* a, int n, const std::vector< std::complex<double> >& w, int m )
+   {
+      // Bit-reversal permutation.
+      for( int i=1, j=0; i<n; ++i )
+      {
+         int bit = n >> 1;
+         for( ; j & bit; bit >>= 1 )
+            j ^= bit;
+         j ^= bit;
+
+         if( i < j )
+            std::swap( a[i], a[j] );
+      }
+
+      // Butterflies.
+      for( int len=2; len<=n; len <<= 1 )
+      {
+         const int half   = len/2;
+         const int stride = m/len;
+
+         for( int i=0; i<n; i += len )
+         {
+            for( int k=0; k<half; ++k )
+            {
+               std::complex<double> u = a[i+k];
+               std::complex<double> v = a[i+k+half] * w[k*stride];
+               a[i+k]      = u + v;
+               a[i+k+half] = u - v;
+            }
+         }
+      }
+   }
+}
+
+//=============================================================================
+// FFT
+//
+//    Compute the discrete Fourier transform of "a" in place.
+//
+// Arguments:
+//
+//    a        on entrance, the sequence to be transformed; on exit, the
+//             transformed sequence.  The length of "a" MUST be a power of
+//             two.
+//
+//    inverse  if true, compute the inverse transform, including the 1/n
+//             scaling.
+//
+// Notes:
+//
+// o  The twiddle factors are computed directly, rather than by recurrence,
+//    so the round-off does not accumulate with the length of the sequence.
+//=============================================================================
+void FFT( std::vector< std::complex<double> >& a, bool inverse )
+{
+   const int n = a.size();
+   assert( n > 0 && (n & (n-1)) == 0 );
+
+   Radix2( a.data(), n, Twiddles(n, inverse), n );
+
+   if( inverse )
+   {
+      for( int i=0; i<n; ++i )
+         a[i] /= n;
+   }
+}
+
+//=============================================================================
+// FFT2
+//
+//    Compute the two-dimensional discrete Fourier transform of "a" in place.
+//
+// Arguments:
+//
+//    a        on entrance, the (nrows x ncols) array to be transformed,
+//             stored in row-major order; on exit, the transformed array.
+//
+//    nrows    number of rows; MUST be a power of two.
+//
+//    ncols    number of columns; MUST be a power of two.
+//
+//    inverse  if true, compute the inverse transform, including the
+//             1/(nrows*ncols) scaling.
+//=============================================================================
+void FFT2( std::vector< std::complex<double> >& a, int nrows, int ncols, bool inverse )
+{
+   assert( int(a.size()) == nrows*ncols );
+   assert( nrows > 0 && (nrows & (nrows-1)) == 0 );
+   assert( ncols > 0 && (ncols & (ncols-1)) == 0 );
+
+   const int m = std::max( nrows, ncols );
+   const std::vector< std::complex<double> > w = Twiddles( m, inverse );
+
+   // Transform the rows in place.
+   for( int i=0; i<nrows; ++i )
+      Radix2( a.data() + i*ncols, ncols, w, m );
+
+   // Transform the columns.
+   std::vector< std::complex<double> > buffer( nrows );
+   for( int j=0; j<ncols; ++j )
+   {
+      for( int i=0; i<nrows; ++i )
+         buffer[i] = a[i*ncols + j];
+
+      Radix2( buffer.data(), nrows, w, m );
+
+      for( int i=0; i<nrows; ++i )
+         a[i*ncols + j] = buffer[i];
+   }
+
+   if( inverse )
+   {
+      const double scale = 1.0/(double(nrows)*double(ncols));
+      for( int k=0; k<nrows*ncols; ++k )
+         a[k] *= scale;
+   }
+}
@@ -0,0 +1,28 @@
+//=============================================================================
+// fft.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <vector>
+
+//=============================================================================
+//
+//=============================================================================
+int NextPowerOfTwo( int n );
+
+void FFT( std::vector< std::complex<double> >& a, bool inverse );
+void FFT2( std::vector< std::complex<double> >& a, int nrows, int ncols, bool inverse );
+
+
+//=============================================================================
+#endif  // FFT_H
@@ -0,0 +1,247 @@
+//=============================================================================
+// grid.cpp
+//
+//    Detection of regularly gridded observations, and the fast block-Toeplitz
+//    separation distance operator for such observations.
+//
+// references:
+// o  Dietrich, C.R., and Newsam, G.N., 1997, Fast and exact simulation of
+//    stationary Gaussian processes through circulant embedding of the
+//    covariance matrix, SIAM Journal on Scientific Computing, v. 18, no. 4,
+//    pp. 1088-1107.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "fft.h"
+
+namespace{
+   const double GRID_TOLERANCE = 1e-4;    // relative to the grid spacing
+   const double MINIMUM_FILL   = 0.5;     // occupied fraction of the grid
+
+   //--------------------------------------------------------------------------
+   // DetectAxis
+   //
+   //    Determine the origin, spacing, and number of nodes of a regularly
+   //    spaced coordinate axis, and the node index of each coordinate.
+   //    Return false if the coordinates are not regularly spaced.
+   //--------------------------------------------------------------------------
+   bool DetectAxis( const std::vector<double>& u, double& u0, double& du, int& nu, std::vector<int>& index )
+   {
+      std::vector<double> s( u );
+      std::sort( s.begin(), s.end() );
+
+      const double extent = s.back() - s.front();
+      u0 = s.front();
+
+      // All of the coordinates are the same: a single node.
+      if( extent <= 0.0 )
+      {
+         du = 1.0;
+         nu = 1;
+         index.assign( u.size(), 0 );
+         return true;
+      }
+
+      // The spacing is the smallest non-trivial gap between coordinates.
+      du = extent;
+      for( unsigned i=1; i<s.size(); ++i )
+      {
+         double gap = s[i] - s[i-1];
+         if( gap > GRID_TOLERANCE*extent && gap < du )
+            du = gap;
+      }
+
+      nu = int( floor( extent/du + 0.5 ) ) + 1;
+
+      // Every coordinate must fall on a node.
+      index.resize( u.size() );
+      for( unsigned i=0; i<u.size(); ++i )
+      {
+         double t = (u[i] - u0)/du;
+         int    k = int( floor( t + 0.5 ) );
+
+         if( fabs(t-k) > GRID_TOLERANCE || k < 0 || k >= nu )
+            return false;
+
+         index[i] = k;
+      }
+      return true;
+   }
+}
+
+//=============================================================================
+// DetectRegularGrid
+//
+//    Determine if the observations are located on the nodes of a regular,
+//    axis-aligned, rectangular grid.
+//
+// Arguments:
+//
+//    x, y     observation coordinates.
+//
+//    grid     on exit, the grid geometry and the node of each observation,
+//             if the observations are gridded.
+//
+// Return:
+//
+//    true  if the observations are gridded;
+//    false if not.
+//
+// Notes:
+//
+// o  The grid need not be complete; e.g. a raster with no-data cells.  But
+//    no node may be occupied twice, and at least half of the nodes must be
+//    occupied, otherwise the circulant embedding is not worth the effort.
+//=============================================================================
+bool DetectRegularGrid( const std::vector<double>& x, const std::vector<double>& y, RegularGrid& grid )
+{
+   assert( x.size() == y.size() );
+   const int N = x.size();
+
+   if( N < 2 )
+      return false;
+
+   if( !DetectAxis( x, grid.x0, grid.dx, grid.nx, grid.col ) )
+      return false;
+
+   if( !DetectAxis( y, grid.y0, grid.dy, grid.ny, grid.row ) )
+      return false;
+
+   double nodes = double(grid.nx) * double(grid.ny);
+   if( N < MINIMUM_FILL*nodes )
+      return false;
+
+   // No node may be occupied twice.
+   std::vector<char> occupied( grid.nx*grid.ny, 0 );
+   for( int i=0; i<N; ++i )
+   {
+      char& flag = occupied[ grid.row[i]*grid.nx + grid.col[i] ];
+      if( flag )
+         return false;
+      flag = 1;
+   }
+
+   return true;
+}
+
+//=============================================================================
+// ToeplitzDistanceOperator
+//=============================================================================
+
+//-----------------------------------------------------------------------------
+// Constructor.
+//
+//    The (2nx-1)x(2ny-1) table of node-to-node separation distances, with
+//    f applied, is wrapped into a circulant array, padded to powers of two,
+//    and transformed once.  The half of the table with non-negative row
+//    offsets is also kept, for Value; the other half is its reflection.
+//-----------------------------------------------------------------------------
+ToeplitzDistanceOperator::ToeplitzDistanceOperator(
+   const RegularGrid& grid,
+   const Anisotropy& anisotropy,
+   const std::function<double(double)>& f )
+:  m_Grid( grid ),
+   m_Anisotropy( anisotropy ),
+   m_nRows( NextPowerOfTwo( 2*grid.ny - 1 ) ),
+   m_nCols( NextPowerOfTwo( 2*grid.nx - 1 ) ),
+   m_Kernel(),
+   m_Values()
+{
+   m_Kernel.assign( m_nRows*m_nCols, std::complex<double>(0.0, 0.0) );
+   m_Values.assign( size_t(grid.ny)*(2*grid.nx-1), 0.0 );
+
+   for( int a=0; a<m_nRows; ++a )
+   {
+      int di = (a < grid.ny) ? a : a - m_nRows;
+      if( di <= -grid.ny ) continue;
+
+      for( int b=0; b<m_nCols; ++b )
+      {
+         int dj = (b < grid.nx) ? b : b - m_nCols;
+         if( dj <= -grid.nx ) continue;
+
+         double d = Distance( dj*grid.dx, di*grid.dy, anisotropy );
+         m_Kernel[a*m_nCols + b] = f ? f(d) : d;
+
+         if( di >= 0 )
+            m_Values[ size_t(di)*(2*grid.nx-1) + dj + grid.nx-1 ] = m_Kernel[a*m_nCols + b].real();
+      }
+   }
+
+   FFT2( m_Kernel, m_nRows, m_nCols, false );
+}
+
+//-----------------------------------------------------------------------------
+// Multiply
+//
+//    Compute Dv = f(D)*v, where v and Dv are (N x 1) in observation order.
+//    The work array is resized as necessary; pass the same work array to
+//    repeated calls to avoid reallocation.
+//-----------------------------------------------------------------------------
+void ToeplitzDistanceOperator::Multiply( const Matrix& v, Matrix& Dv, std::vector< std::complex<double> >& work ) const
+{
+   const int N = m_Grid.col.size();
+   assert( v.nRows() == N && v.nCols() == 1 );
+
+   work.assign( m_nRows*m_nCols, std::complex<double>(0.0, 0.0) );
+   for( int i=0; i<N; ++i )
+      work[ m_Grid.row[i]*m_nCols + m_Grid.col[i] ] = v(i,0);
+
+   FFT2( work, m_nRows, m_nCols, false );
+   for( int k=0; k<m_nRows*m_nCols; ++k )
+      work[k] *= m_Kernel[k];
+   FFT2( work, m_nRows, m_nCols, true );
+
+   Dv.Resize( N, 1 );
+   for( int i=0; i<N; ++i )
+      Dv(i,0) = work[ m_Grid.row[i]*m_nCols + m_Grid.col[i] ].real();
+}
+
+//-----------------------------------------------------------------------------
+// Value
+//
+//    f(D(i,j)) for observations i and j.
+//-----------------------------------------------------------------------------
+double ToeplitzDistanceOperator::Value( int i, int j ) const
+{
+   int di = m_Grid.row[j] - m_Grid.row[i];
+   int dj = m_Grid.col[j] - m_Grid.col[i];
+   if( di < 0 )
+   {
+      di = -di;
+      dj = -dj;
+   }
+   return m_Values[ size_t(di)*(2*m_Grid.nx-1) + dj + m_Grid.nx-1 ];
+}
+
+//-----------------------------------------------------------------------------
+// MaxDistance
+//
+//    An upper bound on the separation distance between any two
+//    observations: the longer diagonal of the occupied part of the grid.
+//    The (anisotropic) distance is a norm, so its maximum over the box is
+//    at a corner.
+//-----------------------------------------------------------------------------
+double ToeplitzDistanceOperator::MaxDistance() const
+{
+   const int ilo = *std::min_element( m_Grid.row.begin(), m_Grid.row.end() );
+   const int ihi = *std::max_element( m_Grid.row.begin(), m_Grid.row.end() );
+   const int jlo = *std::min_element( m_Grid.col.begin(), m_Grid.col.end() );
+   const int jhi = *std::max_element( m_Grid.col.begin(), m_Grid.col.end() );
+
+   const double Lx = (jhi-jlo)*m_Grid.dx;
+   const double Ly = (ihi-ilo)*m_Grid.dy;
+   return std::max( Distance( Lx, Ly, m_Anisotropy ), Distance( Lx, -Ly, m_Anisotropy ) );
+}
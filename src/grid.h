@@ -0,0 +1,82 @@
+//=============================================================================
+// grid.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef GRID_H
+#define GRID_H
+
+#include <complex>
+#include <functional>
+#include <vector>
+
+#include "distance.h"
+#include "matrix.h"
+
+//=============================================================================
+// RegularGrid
+//
+//    The geometry of observations located on (a subset of the nodes of) a
+//    regular, axis-aligned, rectangular grid.
+//=============================================================================
+struct RegularGrid
+{
+   int      nx;                     // number of grid columns
+   int      ny;                     // number of grid rows
+   double   x0;                     // x-coordinate of column 0
+   double   y0;                     // y-coordinate of row 0
+   double   dx;                     // column spacing
+   double   dy;                     // row spacing
+
+   std::vector<int> col;            // column index of each observation
+   std::vector<int> row;            // row index of each observation
+};
+
+bool DetectRegularGrid( const std::vector<double>& x, const std::vector<double>& y, RegularGrid& grid );
+
+//=============================================================================
+// ToeplitzDistanceOperator
+//
+//    The separation distance matrix D for observations on a regular grid is
+//    block-Toeplitz, as is f(D) for any function f applied term-by-term.
+//    This operator computes the product f(D)*v using a circulant embedding
+//    and the FFT, without ever forming D.  The embedding has L >= 4 nx ny
+//    entries, so each product costs O(L log L) and the operator O(L)
+//    memory.  The distances may be anisotropic; by default f is the
+//    identity.
+//
+//    Value(i,j) is the single entry f(D(i,j)), looked up in the table of
+//    f over the node offsets from which the embedding is built.
+//=============================================================================
+class ToeplitzDistanceOperator
+{
+public:
+   explicit ToeplitzDistanceOperator(
+      const RegularGrid& grid,
+      const Anisotropy& anisotropy = Anisotropy(),
+      const std::function<double(double)>& f = std::function<double(double)>() );
+
+   void Multiply( const Matrix& v, Matrix& Dv, std::vector< std::complex<double> >& work ) const;
+
+   double Value( int i, int j ) const;
+
+   double MaxDistance() const;
+
+private:
+   RegularGrid                         m_Grid;
+   Anisotropy                          m_Anisotropy;
+   int                                 m_nRows;    // embedding rows (power of 2)
+   int                                 m_nCols;    // embedding columns (power of 2)
+   std::vector< std::complex<double> > m_Kernel;   // FFT of the embedded distances
+   std::vector<double>                 m_Values;   // f at the offsets, row offset >= 0
+};
+
+
+//=============================================================================
+#endif  // GRID_H
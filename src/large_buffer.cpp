@@ -0,0 +1,300 @@
+//=============================================================================
+// large_buffer.cpp
+//
+//    Large, page-aligned allocations with optional huge pages, and
+//    read-only file mappings.
+//
+// notes:
+// o  On Linux, PAGES_EXPLICIT maps from the reserved huge page pool
+//    (MAP_HUGETLB); if the pool is empty it falls back to transparent huge
+//    pages, which are requested with madvise(MADV_HUGEPAGE).
+//
+// o  On Windows, both huge page policies request large pages, which needs
+//    the "Lock pages in memory" privilege; without it the ordinary pages
+//    are used.
+//
+// o  Elsewhere the policy is ignored.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "large_buffer.h"
+
+#include <cassert>
+#include <cstdio>
+#include <new>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LARGE_BUFFER_MMAP
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define LARGE_BUFFER_VIRTUALALLOC
+#endif
+
+#if defined(LARGE_BUFFER_MMAP) || defined(LARGE_BUFFER_VIRTUALALLOC)
+namespace{
+   const size_t HUGE_PAGE_SIZE = size_t(2) << 20;     // 2 MB
+
+   size_t RoundUp( size_t bytes, size_t page )
+   {
+      return ( (bytes + page - 1) / page ) * page;
+   }
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Constructor.
+//-----------------------------------------------------------------------------
+LargeBuffer::LargeBuffer()
+:  m_Data( nullptr ),
+   m_Bytes( 0 )
+{
+}
+
+//-----------------------------------------------------------------------------
+// Destructor.
+//-----------------------------------------------------------------------------
+LargeBuffer::~LargeBuffer()
+{
+   Release();
+}
+
+//-----------------------------------------------------------------------------
+// Allocate
+//
+//    Release any existing block, and obtain a new one of at least the
+//    requested size.  Throws std::bad_alloc on failure.
+//-----------------------------------------------------------------------------
+void* LargeBuffer::Allocate( size_t bytes, PagePolicy policy )
+{
+   Release();
+   if( bytes == 0 )
+      return nullptr;
+
+#if defined(LARGE_BUFFER_MMAP)
+   const size_t size = RoundUp( bytes, HUGE_PAGE_SIZE );
+   void* p = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+   if( policy == PAGES_EXPLICIT )
+      p = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+#endif
+
+   if( p == MAP_FAILED )
+   {
+      p = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+      if( p == MAP_FAILED )
+         throw std::bad_alloc();
+
+#ifdef MADV_HUGEPAGE
+      if( policy != PAGES_DEFAULT )
+         madvise( p, size, MADV_HUGEPAGE );
+#endif
+   }
+
+   m_Data   = p;
+   m_Bytes  = size;
+
+#elif defined(LARGE_BUFFER_VIRTUALALLOC)
+   void* p = nullptr;
+
+   const size_t large = GetLargePageMinimum();
+   if( policy != PAGES_DEFAULT && large > 0 )
+      p = VirtualAlloc( nullptr, RoundUp(bytes, large), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE );
+
+   if( p == nullptr )
+      p = VirtualAlloc( nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE );
+
+   if( p == nullptr )
+      throw std::bad_alloc();
+
+   m_Data   = p;
+   m_Bytes  = bytes;
+
+#else
+   (void) policy;
+   m_Data   = ::operator new( bytes );
+   m_Bytes  = bytes;
+#endif
+
+   return m_Data;
+}
+
+//-----------------------------------------------------------------------------
+// Release
+//-----------------------------------------------------------------------------
+void LargeBuffer::Release()
+{
+   if( m_Data == nullptr )
+      return;
+
+#if defined(LARGE_BUFFER_MMAP)
+   munmap( m_Data, m_Bytes );
+#elif defined(LARGE_BUFFER_VIRTUALALLOC)
+   VirtualFree( m_Data, 0, MEM_RELEASE );
+#else
+   ::operator delete( m_Data );
+#endif
+
+   m_Data   = nullptr;
+   m_Bytes  = 0;
+}
+
+//-----------------------------------------------------------------------------
+void* LargeBuffer::Data() const
+{
+   return m_Data;
+}
+
+//-----------------------------------------------------------------------------
+size_t LargeBuffer::Bytes() const
+{
+   return m_Bytes;
+}
+
+//=============================================================================
+// MappedFile
+//=============================================================================
+MappedFile::MappedFile()
+:  m_Data( nullptr ),
+   m_Bytes( 0 )
+#if defined(_WIN32)
+   , m_Mapping( nullptr )
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+   Release();
+}
+
+//-----------------------------------------------------------------------------
+// Map
+//
+//    Release any existing mapping, and map the file.
+//-----------------------------------------------------------------------------
+bool MappedFile::Map( const std::string& filename )
+{
+   Release();
+
+#if defined(LARGE_BUFFER_MMAP)
+   int fd = open( filename.c_str(), O_RDONLY );
+   if( fd < 0 )
+      return false;
+
+   struct stat info;
+   if( fstat( fd, &info ) != 0 || info.st_size <= 0 )
+   {
+      close( fd );
+      return false;
+   }
+
+   void* p = mmap( nullptr, size_t(info.st_size), PROT_READ, MAP_SHARED, fd, 0 );
+   close( fd );
+   if( p == MAP_FAILED )
+      return false;
+
+   m_Data  = p;
+   m_Bytes = size_t( info.st_size );
+   return true;
+
+#elif defined(LARGE_BUFFER_VIRTUALALLOC)
+   HANDLE file = CreateFileA( filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+   if( file == INVALID_HANDLE_VALUE )
+      return false;
+
+   LARGE_INTEGER size;
+   if( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 )
+   {
+      CloseHandle( file );
+      return false;
+   }
+
+   HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+   CloseHandle( file );
+   if( mapping == nullptr )
+      return false;
+
+   void* p = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+   if( p == nullptr )
+   {
+      CloseHandle( mapping );
+      return false;
+   }
+
+   m_Data    = p;
+   m_Bytes   = size_t( size.QuadPart );
+   m_Mapping = mapping;
+   return true;
+
+#else
+   FILE* file = fopen( filename.c_str(), "rb" );
+   if( file == nullptr )
+      return false;
+
+   fseek( file, 0, SEEK_END );
+   long size = ftell( file );
+   fseek( file, 0, SEEK_SET );
+   if( size <= 0 )
+   {
+      fclose( file );
+      return false;
+   }
+
+   m_Data  = ::operator new( size_t(size) );
+   m_Bytes = size_t( size );
+   const bool ok = fread( m_Data, 1, m_Bytes, file ) == m_Bytes;
+   fclose( file );
+
+   if( !ok )
+      Release();
+   return ok;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Release
+//-----------------------------------------------------------------------------
+void MappedFile::Release()
+{
+   if( m_Data == nullptr )
+      return;
+
+#if defined(LARGE_BUFFER_MMAP)
+   munmap( m_Data, m_Bytes );
+#elif defined(LARGE_BUFFER_VIRTUALALLOC)
+   UnmapViewOfFile( m_Data );
+   CloseHandle( m_Mapping );
+   m_Mapping = nullptr;
+#else
+   ::operator delete( m_Data );
+#endif
+
+   m_Data  = nullptr;
+   m_Bytes = 0;
+}
+
+//-----------------------------------------------------------------------------
+const void* MappedFile::Data() const
+{
+   return m_Data;
+}
+
+//-----------------------------------------------------------------------------
+size_t MappedFile::Bytes() const
+{
+   return m_Bytes;
+}
@@ -0,0 +1,90 @@
+//=============================================================================
+// large_buffer.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef LARGE_BUFFER_H
+#define LARGE_BUFFER_H
+
+#include <cstddef>
+#include <string>
+
+//=============================================================================
+// PagePolicy
+//=============================================================================
+enum PagePolicy
+{
+   PAGES_DEFAULT,                   // ordinary pages
+   PAGES_TRANSPARENT,               // ask for transparent huge pages
+   PAGES_EXPLICIT                   // reserved huge pages, else transparent
+};
+
+//=============================================================================
+// LargeBuffer
+//
+//    An uninitialized block of memory obtained directly from the operating
+//    system, optionally backed by huge pages.  The pages are not touched
+//    here, so they are placed on the NUMA node of the thread that first
+//    writes them.
+//=============================================================================
+class LargeBuffer
+{
+public:
+   LargeBuffer();
+   ~LargeBuffer();
+
+   void*  Allocate( size_t bytes, PagePolicy policy );
+   void   Release();
+
+   void*  Data() const;
+   size_t Bytes() const;
+
+private:
+   void*  m_Data;
+   size_t m_Bytes;                  // size of the mapping
+
+   LargeBuffer( const LargeBuffer& ) = delete;
+   LargeBuffer& operator=( const LargeBuffer& ) = delete;
+};
+
+//=============================================================================
+// MappedFile
+//
+//    A whole file mapped read-only into memory.  The pages come from the
+//    page cache, so every process that maps the same file shares them.
+//    Where there is no mapping, the file is read into memory instead.
+//=============================================================================
+class MappedFile
+{
+public:
+   MappedFile();
+   ~MappedFile();
+
+   // Return false if the file could not be opened and mapped.
+   bool   Map( const std::string& filename );
+   void   Release();
+
+   const void* Data() const;
+   size_t Bytes() const;
+
+private:
+   void*  m_Data;
+   size_t m_Bytes;
+
+#if defined(_WIN32)
+   void*  m_Mapping;                // the file mapping object
+#endif
+
+   MappedFile( const MappedFile& ) = delete;
+   MappedFile& operator=( const MappedFile& ) = delete;
+};
+
+
+//=============================================================================
+#endif  // LARGE_BUFFER_H
@@ -102,8 +102,9 @@ bool CholeskyDecomposition( const Matrix& A, Matrix& L )
 //
 //    L     the Cholesky decomposition of a symmetric positive definite
 //          matrix A = LL'.
-//    b     on entrance, the right hand side of the system of equations;
-//          on exit, the solution.
+//    b     the right hand side of the system of equations.  Each column of
+//          b is a separate right hand side.
+//    x     on exit, the solution; one column per column of b.
 //
 // Notes:
 //
@@ -120,6 +121,10 @@ bool CholeskyDecomposition( const Matrix& A, Matrix& L )
 //    however, in both sub-systems the soultion overwrites the right hand
 //    side vector b.
 //
+// o  All of the right hand sides are carried through each sweep together,
+//    so L is read once regardless of the number of columns.  The inner
+//    loops run along the (contiguous) rows of x.
+//
 // References:
 //
 //    Golub, G.H., and Van Loan, C.F., 1983, MATRIX COMPUTATIONS, Johns
@@ -134,29 +139,43 @@ void CholeskySolve( const Matrix& L, const Matrix& b, Matrix& x )
 
    // Define local constants.
    const int N = L.nRows();
+   const int P = b.nCols();
 
    // Solve L y = b using forward elimination.
    x = b;
 
-   double Sum;
    for( int i=0; i<N; i++ )
    {
-      Sum = x(i,0);
+      double* xi = x.Base(i,0);
       for( int j=0; j<i; ++j )
-         Sum -= L(i,j) * x(j,0);
+      {
+         const double  Lij = L(i,j);
+         const double* xj  = x.Base(j,0);
+         for( int p=0; p<P; ++p )
+            xi[p] -= Lij * xj[p];
+      }
 
-      x(i,0) = Sum / L(i,i);
+      const double Lii = L(i,i);
+      for( int p=0; p<P; ++p )
+         xi[p] /= Lii;
    }
 
    // Solve L' x = y using back substitution.
    // See Golub and Van Loan, 1983, Algorithm 4.1-2, page 53.
    for( int i=N-1; i>=0; --i )
    {
-      Sum = x(i,0);
+      double* xi = x.Base(i,0);
       for( int j=i+1; j<N; ++j )
-         Sum -= L(j,i) * x(j,0);
+      {
+         const double  Lji = L(j,i);
+         const double* xj  = x.Base(j,0);
+         for( int p=0; p<P; ++p )
+            xi[p] -= Lji * xj[p];
+      }
 
-      x(i,0) = Sum / L(i,i);
+      const double Lii = L(i,i);
+      for( int p=0; p<P; ++p )
+         xi[p] /= Lii;
    }
 }
 
@@ -355,6 +374,80 @@ bool LeastSquaresSolve( const Matrix& A, const Matrix& B, Matrix& X )
 }
 
 
+//=============================================================================
+// ConjugateGradientSolve
+//
+// Purpose:
+//    Solve the symmetric positive definite system of linear equations
+//
+//       A x = b
+//
+//    using the method of conjugate gradients.  The Matrix A is never formed;
+//    it is accessed only through its action on a vector.
+//
+// Arguments:
+//    A        a function that computes Ap = A*p for an (N x 1) Matrix p.
+//    b        (N x 1) right-hand-side column Matrix.
+//    x        (N x 1) solution column Matrix (on exit).
+//    tol      convergence tolerance on the relative residual ||r|| / ||b||.
+//    maxit    maximum number of iterations.
+//
+// Return:
+//    true     if the solution converged, and false otherwise.
+//
+// Notes:
+// o  This routine is based upon Golub and Van Loan (1996), Algorithm 10.2.1.
+//
+// o  The iteration starts from x = 0.
+//
+// References:
+// o  Golub, G. H., and C. F. Van Loan, 1996, MATRIX COMPUTATIONS (3rd
+//    Edition), Johns Hopkins University Press, Baltimore Maryland,
+//    ISBN 0-8018-5414-8.
+//=============================================================================
+bool ConjugateGradientSolve( const std::function<void(const Matrix&, Matrix&)>& A, const Matrix& b, Matrix& x, double tol, int maxit )
+{
+   assert( isCol(b) );
+   const int N = b.nRows();
+
+   x.Resize( N, 1 );
+
+   Matrix r( b );
+   Matrix p( b );
+   Matrix Ap;
+
+   double bb = DotProduct( b, b );
+   if( bb == 0.0 ) return true;
+
+   double rr = bb;
+   for( int iter=0; iter<maxit; ++iter )
+   {
+      A( p, Ap );
+
+      double pAp = DotProduct( p, Ap );
+      if( pAp <= 0.0 ) return false;
+
+      double alpha = rr / pAp;
+      for( int i=0; i<N; ++i )
+      {
+         x(i,0) += alpha * p(i,0);
+         r(i,0) -= alpha * Ap(i,0);
+      }
+
+      double rrnew = DotProduct( r, r );
+      if( rrnew <= tol*tol*bb ) return true;
+
+      double gamma = rrnew / rr;
+      for( int i=0; i<N; ++i )
+         p(i,0) = r(i,0) + gamma * p(i,0);
+
+      rr = rrnew;
+   }
+
+   return false;
+}
+
+
 //=============================================================================
 // AffineTransformation
 //
@@ -379,15 +472,24 @@ void AffineTransformation( const Matrix& A, const Matrix& B, const Matrix& C, Ma
    assert( C.nRows() == 1 );
    assert( C.nCols() == B.nCols() );
 
-   Matrix DD;
-   Multiply_MM(A,B,DD);
+   // Write directly into D, unless D is also one of the arguments.
+   if( &D == &A || &D == &B || &D == &C )
+   {
+      Matrix DD;
+      AffineTransformation( A, B, C, DD );
+      D = DD;
+      return;
+   }
+
+   const int M = A.nRows();
+   const int N = B.nCols();
 
-   for (int i=0; i<DD.nRows(); ++i)
+   D.Resize( M, N );
+   for (int i=0; i<M; ++i)
    {
-      for (int j=0; j<DD.nCols(); ++j)
+      for (int j=0; j<N; ++j)
       {
-         DD(i,j) += C(0,j);
+         D(i,j) = SumProduct( N, A.Base(i,0), B.Base(0,j), N ) + C(0,j);
       }
    }
-   D = DD;
 }
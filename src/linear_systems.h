@@ -12,6 +12,8 @@
 #ifndef LINEAR_SYSTEMS_H
 #define LINEAR_SYSTEMS_H
 
+#include <functional>
+
 #include "matrix.h"
 
 
@@ -24,6 +26,8 @@ void CholeskySolve( const Matrix& L, const Matrix& b, Matrix& x );
 bool RSPDInv( const Matrix& A, Matrix& Ainv );
 bool LeastSquaresSolve( const Matrix& A, const Matrix& B, Matrix& X );
 
+bool ConjugateGradientSolve( const std::function<void(const Matrix&, Matrix&)>& A, const Matrix& b, Matrix& x, double tol, int maxit );
+
 void AffineTransformation( const Matrix& A, const Matrix& B, const Matrix& C, Matrix& D );
 
 
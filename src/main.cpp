@@ -13,20 +13,43 @@
 //=============================================================================
 #include <vector>
 #include <set>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <ctime>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <string>
 #include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
 
+#include "checkpoint.h"
+#include "cross_validation.h"
 #include "engine.h"
+#include "grid.h"
+#include "parallel.h"
+#include "planner.h"
+#include "prediction.h"
+#include "shard.h"
+#include "variogram.h"
+#include "unix_socket.h"
 #include "version.h"
 #include "now.h"
 
 
 namespace{
+   // Manifest constants.
+   const int DEFAULT_GEOMETRIES = 8;                  // cached by the server
+   const std::chrono::seconds PROGRESS_INTERVAL(1);   // between server progress lines
+
    //--------------------------------------------------------------------------
    //
    //--------------------------------------------------------------------------
@@ -34,10 +57,370 @@ namespace{
    {
       std::cerr << std::endl;
       std::cerr << "Aakozi (" << Version() << ')'      << std::endl;
-      std::cerr << "Usage: Aakozi <filename> <radius>" << std::endl;
+      std::cerr << "Usage: Aakozi [options] <filename> <radius>" << std::endl;
+      std::cerr << "       Aakozi [options] variogram <filename> <nbins> [maxlag]" << std::endl;
+      std::cerr << "       Aakozi [options] predict <filename> <xll> <yll> <cellsize> <ncols> <nrows> [slope]" << std::endl;
+      std::cerr << "       Aakozi [options] cv <filename> <blocksize> <folds>" << std::endl;
+      std::cerr << "       Aakozi [options] merge <filename> <shardfile> [shardfile ...]" << std::endl;
+      std::cerr << "       Aakozi [options] batch <manifest>" << std::endl;
+      std::cerr << "       Aakozi [options] serve <socket> [ngeometries]" << std::endl;
+      std::cerr << std::endl;
+      std::cerr << "Options:" << std::endl;
+      std::cerr << "   --grid=off|auto|on   FFT solver for gridded data (default off);" << std::endl;
+      std::cerr << "                        on also requires the data to be gridded" << std::endl;
+      std::cerr << "   --threads=n          number of threads (default 0 = all)" << std::endl;
+      std::cerr << "   --simulations=n      simulated null realizations for the" << std::endl;
+      std::cerr << "                        empirical p-value column (default 0)" << std::endl;
+      std::cerr << "   --seed=n             random seed for the simulations" << std::endl;
+      std::cerr << "   --shard=i/n          compute only shard i of n, 1 <= i <= n, for" << std::endl;
+      std::cerr << "                        the merge subcommand (no simulations)" << std::endl;
+      std::cerr << "   --checkpoint=s       save the finished observations to <output>.ckpt" << std::endl;
+      std::cerr << "                        every s seconds" << std::endl;
+      std::cerr << "   --resume             skip the observations saved in <output>.ckpt" << std::endl;
+      std::cerr << "   --affinity=policy    pin the worker threads: none (default)," << std::endl;
+      std::cerr << "                        compact, or scatter" << std::endl;
+      std::cerr << "   --pages=policy       distance matrix pages: default, transparent" << std::endl;
+      std::cerr << "                        (huge pages), or huge (reserved huge pages)" << std::endl;
+      std::cerr << "   --single             single precision coordinates and distances" << std::endl;
+      std::cerr << "   --cache=dir          reuse the distance tables cached in dir, and add" << std::endl;
+      std::cerr << "                        new ones to it" << std::endl;
+      std::cerr << "   --plan=strategy      auto (default), dense, single, or grid" << std::endl;
+      std::cerr << "   --memory=m           memory limit for the plan in MB (default" << std::endl;
+      std::cerr << "                        the physical memory)" << std::endl;
+      std::cerr << "   --duplicates=policy  co-located data: average (default), first," << std::endl;
+      std::cerr << "                        or group (replicates)" << std::endl;
+      std::cerr << "   --tolerance=t        data closer than t are co-located (default 0);" << std::endl;
+      std::cerr << "                        anisotropic distance, or km if geographic" << std::endl;
+      std::cerr << "   --model=name         variogram model: linear (default), power," << std::endl;
+      std::cerr << "                        exponential, spherical, or gaussian" << std::endl;
+      std::cerr << "   --range=a            practical range of the bounded models" << std::endl;
+      std::cerr << "   --exponent=p         exponent of the power model, 0 < p < 2" << std::endl;
+      std::cerr << "   --nugget=c           nugget, relative to the slope or partial sill" << std::endl;
+      std::cerr << "   --angle=a            anisotropy: major axis direction, degrees" << std::endl;
+      std::cerr << "                        counterclockwise from the x axis" << std::endl;
+      std::cerr << "   --ratio=r            anisotropy: minor/major range ratio, 0 < r <= 1" << std::endl;
+      std::cerr << "   --3d                 3-D data, one \"id x y elev z\" per line" << std::endl;
+      std::cerr << "   --vertical=f         3-D: factor applied to elevation differences" << std::endl;
+      std::cerr << "   --geographic         x and y are longitude and latitude in degrees;" << std::endl;
+      std::cerr << "                        distances and the radius are in kilometers" << std::endl;
       std::cerr << std::endl;
    }
 
+   //--------------------------------------------------------------------------
+   // ModelSpec
+   //
+   //    The variogram model named on the command line.
+   //--------------------------------------------------------------------------
+   enum ModelType
+   {
+      MODEL_LINEAR,
+      MODEL_POWER,
+      MODEL_EXPONENTIAL,
+      MODEL_SPHERICAL,
+      MODEL_GAUSSIAN
+   };
+
+   struct ModelSpec
+   {
+      ModelType type     = MODEL_LINEAR;
+      double    range    = 0.0;
+      double    exponent = 1.0;
+      double    nugget   = 0.0;
+   };
+
+   //--------------------------------------------------------------------------
+   // PlanSpec
+   //
+   //    The execution plan requested on the command line.  --grid, --single
+   //    and --plan=<strategy> select the strategy; otherwise it is planned.
+   //    --grid=on and --plan=grid also declare that the data are gridded,
+   //    which is then checked before the run.
+   //--------------------------------------------------------------------------
+   struct PlanSpec
+   {
+      bool      automatic = true;
+      bool      gridded   = false;  // the data are declared to be gridded
+      double    memory    = 0.0;    // MB; 0 --> the physical memory
+   };
+
+   //--------------------------------------------------------------------------
+   // ParseOptions
+   //
+   //    Separate the "--name=value" options from the positional arguments.
+   //    Return false if an option is not recognized.
+   //--------------------------------------------------------------------------
+   bool ParseOptions( int argc, char* argv[], std::vector<std::string>& args, EngineOptions& options, ModelSpec& model, PlanSpec& plan, bool& volumetric )
+   {
+      for( int i=1; i<argc; ++i )
+      {
+         std::string arg = argv[i];
+
+         if( arg.compare(0, 2, "--") != 0 )
+         {
+            args.push_back( arg );
+            continue;
+         }
+
+         std::string name  = arg.substr( 0, arg.find('=') );
+         std::string value = ( arg.find('=') == std::string::npos ) ? "" : arg.substr( arg.find('=')+1 );
+
+         bool valid = true;
+         if( name == "--grid" )
+         {
+            plan.gridded = false;
+            if( value == "off" )
+               options.grid_mode = GRID_OFF;
+            else if( value == "auto" )
+               options.grid_mode = GRID_ON;
+            else if( value == "on" || value == "" )
+            {
+               options.grid_mode = GRID_ON;
+               plan.gridded = true;
+            }
+            else
+               valid = false;
+            plan.automatic = false;
+         }
+         else if( name == "--threads" )
+         {
+            options.threads = atoi( value.c_str() );
+            valid = ( options.threads >= 0 && value != "" );
+         }
+         else if( name == "--simulations" )
+         {
+            options.simulations = atoi( value.c_str() );
+            valid = ( options.simulations >= 0 && value != "" );
+         }
+         else if( name == "--seed" )
+         {
+            options.seed = strtoull( value.c_str(), nullptr, 10 );
+            valid = ( value != "" );
+         }
+         else if( name == "--shard" )
+         {
+            std::istringstream is( value );
+            int i = 0, n = 0;
+            char slash = 0;
+            valid = ( is >> i >> slash >> n ) && slash == '/' && 1 <= i && i <= n && is.peek() == EOF;
+            options.shard   = i-1;
+            options.nshards = n;
+         }
+         else if( name == "--checkpoint" )
+         {
+            // The file is named for the output file, once it is known.
+            options.checkpoint_interval = atof( value.c_str() );
+            options.checkpoint = "Aakozi.out.ckpt";
+            valid = ( options.checkpoint_interval > 0 );
+         }
+         else if( name == "--resume" )
+         {
+            options.resume = true;
+            valid = ( value == "" );
+         }
+         else if( name == "--angle" )
+         {
+            options.anisotropy.angle = atof( value.c_str() );
+            valid = ( value != "" );
+         }
+         else if( name == "--ratio" )
+         {
+            options.anisotropy.ratio = atof( value.c_str() );
+            valid = ( options.anisotropy.ratio > 0 && options.anisotropy.ratio <= 1 );
+         }
+         else if( name == "--3d" )
+         {
+            volumetric = true;
+            valid = ( value == "" );
+         }
+         else if( name == "--geographic" )
+         {
+            options.geographic = true;
+            valid = ( value == "" );
+         }
+         else if( name == "--vertical" )
+         {
+            options.anisotropy.vertical = atof( value.c_str() );
+            valid = ( options.anisotropy.vertical > 0 );
+         }
+         else if( name == "--affinity" )
+         {
+            if( value == "none" )
+               options.affinity = AFFINITY_NONE;
+            else if( value == "compact" )
+               options.affinity = AFFINITY_COMPACT;
+            else if( value == "scatter" )
+               options.affinity = AFFINITY_SCATTER;
+            else
+               valid = false;
+         }
+         else if( name == "--pages" )
+         {
+            if( value == "default" )
+               options.pages = PAGES_DEFAULT;
+            else if( value == "transparent" )
+               options.pages = PAGES_TRANSPARENT;
+            else if( value == "huge" )
+               options.pages = PAGES_EXPLICIT;
+            else
+               valid = false;
+         }
+         else if( name == "--single" )
+         {
+            options.single_precision = true;
+            plan.automatic = false;
+            valid = ( value == "" );
+         }
+         else if( name == "--cache" )
+         {
+            options.distance_cache = value;
+            valid = ( value != "" );
+         }
+         else if( name == "--plan" )
+         {
+            plan.automatic = false;
+            if( value == "auto" )
+               plan.automatic = true;
+            else if( value == "dense" )
+            {
+               options.grid_mode = GRID_OFF;
+               options.single_precision = false;
+            }
+            else if( value == "single" )
+            {
+               options.grid_mode = GRID_OFF;
+               options.single_precision = true;
+            }
+            else if( value == "grid" )
+            {
+               options.grid_mode = GRID_ON;
+               options.single_precision = false;
+               plan.gridded = true;
+            }
+            else
+               valid = false;
+         }
+         else if( name == "--memory" )
+         {
+            plan.memory = atof( value.c_str() );
+            valid = ( plan.memory > 0 );
+         }
+         else if( name == "--duplicates" )
+         {
+            if( value == "average" )
+               options.duplicates = DUPLICATES_AVERAGE;
+            else if( value == "first" )
+               options.duplicates = DUPLICATES_FIRST;
+            else if( value == "group" )
+               options.duplicates = DUPLICATES_GROUP;
+            else
+               valid = false;
+         }
+         else if( name == "--tolerance" )
+         {
+            options.duplicate_tolerance = atof( value.c_str() );
+            valid = ( options.duplicate_tolerance >= 0 && value != "" );
+         }
+         else if( name == "--model" )
+         {
+            if( value == "linear" )
+               model.type = MODEL_LINEAR;
+            else if( value == "power" )
+               model.type = MODEL_POWER;
+            else if( value == "exponential" )
+               model.type = MODEL_EXPONENTIAL;
+            else if( value == "spherical" )
+               model.type = MODEL_SPHERICAL;
+            else if( value == "gaussian" )
+               model.type = MODEL_GAUSSIAN;
+            else
+               valid = false;
+         }
+         else if( name == "--range" )
+         {
+            model.range = atof( value.c_str() );
+            valid = ( model.range > 0 );
+         }
+         else if( name == "--exponent" )
+         {
+            model.exponent = atof( value.c_str() );
+            valid = ( model.exponent > 0 && model.exponent < 2 );
+         }
+         else if( name == "--nugget" )
+         {
+            model.nugget = atof( value.c_str() );
+            valid = ( model.nugget >= 0 && value != "" );
+         }
+         else
+         {
+            valid = false;
+         }
+
+         if( !valid )
+         {
+            std::cerr << "ERROR: unrecognized option <" << arg << ">." << std::endl;
+            return false;
+         }
+      }
+      // The bounded models require a range.
+      if( model.type != MODEL_LINEAR && model.type != MODEL_POWER && model.range <= 0 )
+      {
+         std::cerr << "ERROR: the " << ( model.type == MODEL_EXPONENTIAL ? "exponential" : model.type == MODEL_SPHERICAL ? "spherical" : "gaussian" )
+                   << " model requires --range." << std::endl;
+         return false;
+      }
+      return true;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunModel
+   //
+   //    Run the Engine in 2-D, or in 3-D if there are elevations.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   std::vector<Boomerang> RunModel(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>& elev,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      const Variogram& model )
+   {
+      if( elev.empty() )
+         return Engine( x, y, z, radius, options, model );
+      else
+         return Engine( x, y, elev, z, radius, options, model );
+   }
+
+   //--------------------------------------------------------------------------
+   // RunEngine
+   //
+   //    Select the Engine instantiation for the variogram model, once.
+   //--------------------------------------------------------------------------
+   std::vector<Boomerang> RunEngine(
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>& elev,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      const ModelSpec& model )
+   {
+      switch( model.type )
+      {
+      case MODEL_POWER:
+         return RunModel( x, y, elev, z, radius, options, PowerVariogram( model.exponent, model.nugget ) );
+      case MODEL_EXPONENTIAL:
+         return RunModel( x, y, elev, z, radius, options, ExponentialVariogram( model.range, model.nugget ) );
+      case MODEL_SPHERICAL:
+         return RunModel( x, y, elev, z, radius, options, SphericalVariogram( model.range, model.nugget ) );
+      case MODEL_GAUSSIAN:
+         return RunModel( x, y, elev, z, radius, options, GaussianVariogram( model.range, model.nugget ) );
+      default:
+         return RunModel( x, y, elev, z, radius, options, LinearVariogram( model.nugget ) );
+      }
+   }
+
    //--------------------------------------------------------------------------
    //
    //--------------------------------------------------------------------------
@@ -47,6 +430,1168 @@ namespace{
       ost << "Aakozi                       (" << Version() << ')' << std::endl;
       ost << "================================================="  << std::endl;
    }
+
+   //--------------------------------------------------------------------------
+   // ReadData
+   //
+   //    Read the observation data, one "id x y z" per line.  Lines that do
+   //    not start with these four values are skipped.
+   //--------------------------------------------------------------------------
+   void ReadData( std::istream& inpfile, std::vector<int>& id, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z )
+   {
+      std::string line;
+
+      double xx, yy, zz;
+      int ii;
+      while( std::getline(inpfile, line) )
+      {
+         std::istringstream is(line);
+         if( is >> ii >> xx >> yy >> zz )
+         {
+            id.push_back(ii);
+            x.push_back(xx);
+            y.push_back(yy);
+            z.push_back(zz);
+         }
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // ReadData
+   //
+   //    Read 3-D observation data, one "id x y elev z" per line.  Lines that
+   //    do not start with these five values are skipped.
+   //--------------------------------------------------------------------------
+   void ReadData( std::istream& inpfile, std::vector<int>& id, std::vector<double>& x, std::vector<double>& y, std::vector<double>& elev, std::vector<double>& z )
+   {
+      std::string line;
+
+      double xx, yy, ee, zz;
+      int ii;
+      while( std::getline(inpfile, line) )
+      {
+         std::istringstream is(line);
+         if( is >> ii >> xx >> yy >> ee >> zz )
+         {
+            id.push_back(ii);
+            x.push_back(xx);
+            y.push_back(yy);
+            elev.push_back(ee);
+            z.push_back(zz);
+         }
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // WriteResults
+   //
+   //    Write the boomerang statistics, one observation per line.  The elev
+   //    are empty for 2-D data.
+   //--------------------------------------------------------------------------
+   void WriteResults(
+      std::ostream& outfile,
+      const std::vector<int>& id,
+      const std::vector<double>& x,
+      const std::vector<double>& y,
+      const std::vector<double>& elev,
+      const std::vector<double>& z,
+      const std::vector<Boomerang>& results,
+      bool simulated )
+   {
+      const int N = x.size();
+      for( int n=1; n<N; ++n )
+      {
+         outfile << std::fixed << std::setw(12)                         << id[n];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << x[n];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << y[n];
+         if( !elev.empty() )
+            outfile << std::fixed << std::setw(12) << std::setprecision(2) << elev[n];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << z[n];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[n].zhat;
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[n].zeta;
+         outfile << std::fixed << std::setw(12) << std::setprecision(3) << results[n].pvalue;
+         if( simulated )
+            outfile << std::fixed << std::setw(12) << std::setprecision(3) << results[n].pvalue_mc;
+         outfile << std::fixed << std::setw(12)                         << results[n].cnt;
+         outfile << std::endl;
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // ShardFileName
+   //--------------------------------------------------------------------------
+   std::string ShardFileName( const EngineOptions& options )
+   {
+      std::ostringstream os;
+      os << "Aakozi_shard_" << options.shard+1 << "_of_" << options.nshards << ".out";
+      return os.str();
+   }
+
+   //--------------------------------------------------------------------------
+   // WriteShard
+   //
+   //    Write the partial results of a shard for the merge subcommand: the
+   //    ShardHeader, followed by "index zhat xi cnt" for each observation
+   //    kriged by this shard, in full precision.
+   //--------------------------------------------------------------------------
+   void WriteShard( std::ostream& outfile, const ShardHeader& header, const std::vector<Boomerang>& results )
+   {
+      const int N = results.size();
+
+      WriteShardHeader( outfile, header );
+
+      for( int n=0; n<N; ++n )
+      {
+         if( results[n].cnt == 0 )
+            continue;
+
+         outfile << n << ' '
+                 << std::scientific << std::setprecision(17) << results[n].zhat << ' ' << results[n].xi << ' '
+                 << results[n].cnt << std::endl;
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // RunVariogram
+   //
+   //    The "variogram" subcommand: compute the empirical variogram of the
+   //    data and write it to "Aakozi.vgm".
+   //--------------------------------------------------------------------------
+   int RunVariogram( const std::vector<std::string>& args, const EngineOptions& options )
+   {
+      // Get and check the number of bins, and the maximum lag.
+      int nbins = atoi( args[2].c_str() );
+      if( nbins <= 0 )
+      {
+         std::cerr << "ERROR: number of bins = " << args[2] << " is not valid;  0 < nbins." << std::endl;
+         std::cerr << std::endl;
+         Usage();
+         return 2;
+      }
+
+      double maxlag = 0.0;
+      if( args.size() == 4 )
+      {
+         maxlag = atof( args[3].c_str() );
+         if( maxlag <= 0.0 )
+         {
+            std::cerr << "ERROR: maximum lag = " << args[3] << " is not valid;  0 < maxlag." << std::endl;
+            std::cerr << std::endl;
+            Usage();
+            return 2;
+         }
+      }
+
+      // Open the specified data file.
+      std::string inpfilename = args[1];
+      std::ifstream inpfile( inpfilename );
+      if( inpfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the specified input file <" << inpfilename << "> for input." << std::endl;
+         Usage();
+         return 3;
+      }
+
+      // Open the specified output file.
+      std::string outfilename = "Aakozi.vgm";
+      std::ofstream outfile( outfilename );
+      if( outfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the output file <" << outfilename << "> for output." << std::endl;
+         Usage();
+         return 4;
+      }
+
+      // Read in the observation data from the specified data file.
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> z;
+      std::vector<int>   id;
+
+      ReadData( inpfile, id, x, y, z );
+      inpfile.close();
+
+      std::cout << std::endl << x.size() << " data read from <" << inpfilename << ">. \n";
+
+      // Fill the output file with the results.
+      std::vector<VariogramBin> bins = EmpiricalVariogram( x, y, z, nbins, maxlag, options.threads );
+
+      for( int b=0; b<nbins; ++b )
+      {
+         outfile << std::fixed << std::setw(12)                         << b;
+         outfile << std::fixed << std::setw(16) << std::setprecision(4) << bins[b].lag;
+         outfile << std::fixed << std::setw(16) << std::setprecision(4) << bins[b].gamma;
+         outfile << std::fixed << std::setw(16)                         << bins[b].count;
+         outfile << std::endl;
+      }
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // WriteRaster
+   //
+   //    Write the values, stored row by row from the top row, as an ESRI
+   //    ASCII grid.  Return false if the file could not be opened.
+   //--------------------------------------------------------------------------
+   bool WriteRaster( const std::string& filename, const TargetGrid& grid, const std::vector<double>& values )
+   {
+      std::ofstream outfile( filename );
+      if( outfile.fail() )
+         return false;
+
+      outfile << "ncols        " << grid.ncols << std::endl;
+      outfile << "nrows        " << grid.nrows << std::endl;
+      outfile << "xllcenter    " << std::fixed << std::setprecision(4) << grid.xll << std::endl;
+      outfile << "yllcenter    " << std::fixed << std::setprecision(4) << grid.yll << std::endl;
+      outfile << "cellsize     " << std::fixed << std::setprecision(4) << grid.cellsize << std::endl;
+      outfile << "NODATA_value -9999" << std::endl;
+
+      for( int r=0; r<grid.nrows; ++r )
+      {
+         for( int c=0; c<grid.ncols; ++c )
+         {
+            double v = values[r*grid.ncols + c];
+            outfile << ( c > 0 ? " " : "" ) << std::fixed << std::setprecision(4) << ( std::isnan(v) ? -9999.0 : v );
+         }
+         outfile << std::endl;
+      }
+      return true;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunPredict
+   //
+   //    The "predict" subcommand: krige the data onto a raster, and write
+   //    the kriged values and the kriging variances to "Aakozi_zhat.asc"
+   //    and "Aakozi_variance.asc".  The optional last argument is the slope
+   //    of the variogram, or its partial sill for the bounded models.
+   //--------------------------------------------------------------------------
+   int RunPredict( const std::vector<std::string>& args, const EngineOptions& options, const ModelSpec& model )
+   {
+      // Get and check the target grid.
+      TargetGrid grid;
+      grid.xll      = atof( args[2].c_str() );
+      grid.yll      = atof( args[3].c_str() );
+      grid.cellsize = atof( args[4].c_str() );
+      grid.ncols    = atoi( args[5].c_str() );
+      grid.nrows    = atoi( args[6].c_str() );
+
+      if( grid.cellsize <= 0.0 || grid.ncols <= 0 || grid.nrows <= 0 )
+      {
+         std::cerr << "ERROR: the target grid is not valid;  0 < cellsize, 0 < ncols, 0 < nrows." << std::endl;
+         std::cerr << std::endl;
+         Usage();
+         return 2;
+      }
+
+      const bool bounded = ( model.type != MODEL_LINEAR && model.type != MODEL_POWER );
+      const char* scale_name = ( bounded ? "partial sill" : "slope" );
+
+      double scale = 0.0;
+      if( args.size() == 8 )
+      {
+         scale = atof( args[7].c_str() );
+         if( scale <= 0.0 )
+         {
+            std::cerr << "ERROR: variogram " << scale_name << " = " << args[7] << " is not valid;  0 < " << scale_name << "." << std::endl;
+            std::cerr << std::endl;
+            Usage();
+            return 2;
+         }
+      }
+
+      // Open the specified data file.
+      std::string inpfilename = args[1];
+      std::ifstream inpfile( inpfilename );
+      if( inpfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the specified input file <" << inpfilename << "> for input." << std::endl;
+         Usage();
+         return 3;
+      }
+
+      // Read in the observation data from the specified data file.
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> z;
+      std::vector<int>   id;
+
+      ReadData( inpfile, id, x, y, z );
+      inpfile.close();
+
+      std::cout << std::endl << x.size() << " data read from <" << inpfilename << ">. \n";
+
+      // Krige onto the grid, with the variogram model chosen once.
+      std::vector<double> zhat, variance;
+      bool solved;
+      switch( model.type )
+      {
+      case MODEL_POWER:
+         solved = KrigeGrid( x, y, z, grid, options.threads, PowerVariogram( model.exponent, model.nugget ), scale, zhat, variance );
+         break;
+      case MODEL_EXPONENTIAL:
+         solved = KrigeGrid( x, y, z, grid, options.threads, ExponentialVariogram( model.range, model.nugget ), scale, zhat, variance );
+         break;
+      case MODEL_SPHERICAL:
+         solved = KrigeGrid( x, y, z, grid, options.threads, SphericalVariogram( model.range, model.nugget ), scale, zhat, variance );
+         break;
+      case MODEL_GAUSSIAN:
+         solved = KrigeGrid( x, y, z, grid, options.threads, GaussianVariogram( model.range, model.nugget ), scale, zhat, variance );
+         break;
+      default:
+         solved = KrigeGrid( x, y, z, grid, options.threads, LinearVariogram( model.nugget ), scale, zhat, variance );
+         break;
+      }
+      if( !solved )
+      {
+         std::cerr << "ERROR: the kriging system is singular; check for duplicate locations." << std::endl;
+         return 5;
+      }
+      std::cout << "variogram " << scale_name << ": " << scale << ( args.size() == 8 ? "" : " (estimated)" ) << std::endl;
+
+      // Write the rasters.
+      const std::string zhatfilename = "Aakozi_zhat.asc";
+      const std::string varfilename  = "Aakozi_variance.asc";
+
+      if( !WriteRaster( zhatfilename, grid, zhat ) )
+      {
+         std::cerr << "ERROR: could not open the output file <" << zhatfilename << "> for output." << std::endl;
+         return 4;
+      }
+      if( !WriteRaster( varfilename, grid, variance ) )
+      {
+         std::cerr << "ERROR: could not open the output file <" << varfilename << "> for output." << std::endl;
+         return 4;
+      }
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunCrossValidation
+   //
+   //    The "cv" subcommand: spatial block k-fold cross-validation, written
+   //    to "Aakozi_cv.out".
+   //--------------------------------------------------------------------------
+   int RunCrossValidation( const std::vector<std::string>& args, const EngineOptions& options, const ModelSpec& model )
+   {
+      // Get and check the block size, and the number of folds.
+      double blocksize = atof( args[2].c_str() );
+      if( blocksize <= 0.0 )
+      {
+         std::cerr << "ERROR: block size = " << args[2] << " is not valid;  0 < blocksize." << std::endl;
+         std::cerr << std::endl;
+         Usage();
+         return 2;
+      }
+
+      int nfolds = atoi( args[3].c_str() );
+      if( nfolds < 2 )
+      {
+         std::cerr << "ERROR: number of folds = " << args[3] << " is not valid;  2 <= folds." << std::endl;
+         std::cerr << std::endl;
+         Usage();
+         return 2;
+      }
+
+      // Open the specified data file.
+      std::string inpfilename = args[1];
+      std::ifstream inpfile( inpfilename );
+      if( inpfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the specified input file <" << inpfilename << "> for input." << std::endl;
+         Usage();
+         return 3;
+      }
+
+      // Open the specified output file.
+      std::string outfilename = "Aakozi_cv.out";
+      std::ofstream outfile( outfilename );
+      if( outfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the output file <" << outfilename << "> for output." << std::endl;
+         Usage();
+         return 4;
+      }
+
+      // Read in the observation data from the specified data file.
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> z;
+      std::vector<int>   id;
+
+      ReadData( inpfile, id, x, y, z );
+      inpfile.close();
+
+      const int N = x.size();
+      std::cout << std::endl << N << " data read from <" << inpfilename << ">. \n";
+
+      // Assign the blocks to the folds.
+      std::vector<int> fold;
+      int nblocks = SpatialFolds( x, y, blocksize, nfolds, options.seed, fold );
+      std::cout << nblocks << " blocks in " << nfolds << " folds." << std::endl;
+      if( nblocks < nfolds )
+         std::cerr << "WARNING: fewer blocks than folds; some folds are empty." << std::endl;
+
+      // Cross-validate.
+      std::vector<Boomerang> results;
+      switch( model.type )
+      {
+      case MODEL_POWER:
+         results = BlockCrossValidation( x, y, z, fold, options, PowerVariogram( model.exponent, model.nugget ) );
+         break;
+      case MODEL_EXPONENTIAL:
+         results = BlockCrossValidation( x, y, z, fold, options, ExponentialVariogram( model.range, model.nugget ) );
+         break;
+      case MODEL_SPHERICAL:
+         results = BlockCrossValidation( x, y, z, fold, options, SphericalVariogram( model.range, model.nugget ) );
+         break;
+      case MODEL_GAUSSIAN:
+         results = BlockCrossValidation( x, y, z, fold, options, GaussianVariogram( model.range, model.nugget ) );
+         break;
+      default:
+         results = BlockCrossValidation( x, y, z, fold, options, LinearVariogram( model.nugget ) );
+         break;
+      }
+
+      // The root mean square prediction error.
+      double sse = 0.0;
+      int n = 0;
+      for( int k=0; k<N; ++k )
+      {
+         if( results[k].cnt > 0 )
+         {
+            sse += ( z[k] - results[k].zhat )*( z[k] - results[k].zhat );
+            ++n;
+         }
+      }
+      std::cout << "root mean square prediction error: " << std::fixed << std::setprecision(4) << sqrt( sse/n ) << std::endl;
+
+      for( int k=0; k<N; ++k )
+      {
+         outfile << std::fixed << std::setw(12)                         << id[k];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << x[k];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << y[k];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << z[k];
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[k].zhat;
+         outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[k].zeta;
+         outfile << std::fixed << std::setw(12) << std::setprecision(3) << results[k].pvalue;
+         outfile << std::fixed << std::setw(12)                         << fold[k];
+         outfile << std::fixed << std::setw(12)                         << results[k].cnt;
+         outfile << std::endl;
+      }
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunMerge
+   //
+   //    The "merge" subcommand: combine the shard files of a sharded run of
+   //    the data, normalize the xi by the summed partial sums, and write
+   //    "Aakozi.out" as the unsharded run would have.  The shards must all
+   //    be of these data, and of one run: the same radius, model, and
+   //    options, as recorded in their headers.
+   //--------------------------------------------------------------------------
+   int RunMerge( const std::vector<std::string>& args, bool volumetric )
+   {
+      // Open the specified data file.
+      std::string inpfilename = args[1];
+      std::ifstream inpfile( inpfilename );
+      if( inpfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the specified input file <" << inpfilename << "> for input." << std::endl;
+         Usage();
+         return 3;
+      }
+
+      // Read in the observation data from the specified data file.
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> elev;
+      std::vector<double> z;
+      std::vector<int>   id;
+
+      if( volumetric )
+         ReadData( inpfile, id, x, y, elev, z );
+      else
+         ReadData( inpfile, id, x, y, z );
+      inpfile.close();
+
+      const int N = x.size();
+      std::cout << std::endl << N << " data read from <" << inpfilename << ">. \n";
+
+      // Gather the shards.
+      Boomerang none;
+      none.zhat = none.zeta = none.pvalue = none.pvalue_mc = none.xi = NAN;
+      none.cnt  = 0;
+
+      std::vector<Boomerang> results( N, none );
+      std::vector<char> filled( N, 0 );
+      std::set<int> shards;
+      XiSums total;
+      int nshards = 0;
+
+      const uint64_t data = DataHash( x, y, elev, z );
+      ShardHeader first;
+
+      for( size_t f=2; f<args.size(); ++f )
+      {
+         const std::string& shardfilename = args[f];
+         std::ifstream shardfile( shardfilename );
+         if( shardfile.fail() )
+         {
+            std::cerr << "ERROR: could not open the shard file <" << shardfilename << "> for input." << std::endl;
+            return 3;
+         }
+
+         std::string line;
+         ShardHeader header;
+         std::getline( shardfile, line );
+         if( !ReadShardHeader( line, header ) )
+         {
+            std::cerr << "ERROR: <" << shardfilename << "> is not a shard file." << std::endl;
+            return 5;
+         }
+         if( header.N != N || header.data != data )
+         {
+            std::cerr << "ERROR: the shard file <" << shardfilename << "> was not computed from the data in <" << inpfilename << ">." << std::endl;
+            return 5;
+         }
+         if( nshards != 0 && !SameRun( first, header ) )
+         {
+            std::cerr << "ERROR: the shard file <" << shardfilename << "> is not from the same run as <" << args[2]
+                      << ">; the radius, the model, or another option differs." << std::endl;
+            return 5;
+         }
+         if( !shards.insert( header.shard ).second )
+         {
+            std::cerr << "ERROR: shard " << header.shard << " was given twice." << std::endl;
+            return 5;
+         }
+         if( nshards == 0 )
+            first = header;
+         nshards = header.nshards;
+         total.sum   += header.sums.sum;
+         total.count += header.sums.count;
+
+         while( std::getline( shardfile, line ) )
+         {
+            std::istringstream is( line );
+            std::string zhat, xi;
+            int k, cnt;
+            if( !( is >> k >> zhat >> xi >> cnt ) || k < 0 || k >= N || filled[k] )
+            {
+               std::cerr << "ERROR: bad line in the shard file <" << shardfilename << ">: " << line << std::endl;
+               return 5;
+            }
+            results[k].zhat = strtod( zhat.c_str(), nullptr );
+            results[k].xi   = strtod( xi.c_str(), nullptr );
+            results[k].cnt  = cnt;
+            filled[k] = 1;
+         }
+      }
+
+      if( int( shards.size() ) != nshards )
+      {
+         std::cerr << "ERROR: " << shards.size() << " of the " << nshards << " shards were given." << std::endl;
+         return 5;
+      }
+      std::cout << nshards << " shards merged." << std::endl;
+
+      // The global normalization.
+      NormalizeXi( total, results );
+
+      // Open the output file, and fill it with the results.
+      std::string outfilename = "Aakozi.out";
+      std::ofstream outfile( outfilename );
+      if( outfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the output file <" << outfilename << "> for output." << std::endl;
+         Usage();
+         return 4;
+      }
+
+      WriteResults( outfile, id, x, y, elev, z, results, false );
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // BatchFile
+   //
+   //    One line of a batch manifest, and its data.
+   //--------------------------------------------------------------------------
+   struct BatchFile
+   {
+      std::string         inpfilename;
+      std::string         outfilename;
+      double              radius = 0.0;
+      int                 status = 0;
+      double              cost   = 0.0;
+
+      std::vector<int>    id;
+      std::vector<double> x, y, elev, z;
+   };
+
+   //--------------------------------------------------------------------------
+   // ReadManifest
+   //
+   //    Read the batch manifest, one "<filename> <radius> [outfile]" per
+   //    line; blank lines and lines starting with '#' are skipped.  The
+   //    output file defaults to the input file name with ".out" appended.
+   //    Return 0, or the exit status for a bad manifest.
+   //--------------------------------------------------------------------------
+   int ReadManifest( const std::string& manifest, std::vector<BatchFile>& files )
+   {
+      std::ifstream inpfile( manifest );
+      if( inpfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the manifest <" << manifest << "> for input." << std::endl;
+         return 3;
+      }
+
+      std::set<std::string> names;
+      std::string line;
+      for( int number=1; std::getline( inpfile, line ); ++number )
+      {
+         std::istringstream is( line );
+         std::string first;
+         if( !( is >> first ) || first[0] == '#' )
+            continue;
+
+         BatchFile file;
+         file.inpfilename = first;
+         if( !( is >> file.radius ) || file.radius <= 0.0 )
+         {
+            std::cerr << "ERROR: line " << number << " of <" << manifest << ">: the radius is missing or not valid;  0 < radius." << std::endl;
+            return 2;
+         }
+         if( !( is >> file.outfilename ) )
+            file.outfilename = file.inpfilename + ".out";
+
+         // Distinct output names, which do not overwrite any input.
+         if( !names.insert( file.outfilename ).second )
+         {
+            std::cerr << "ERROR: line " << number << " of <" << manifest << ">: the output file <" << file.outfilename
+                      << "> is named twice; name the outputs in a third column." << std::endl;
+            return 2;
+         }
+         files.push_back( file );
+      }
+
+      for( const auto& file : files )
+      {
+         if( names.count( file.inpfilename ) )
+         {
+            std::cerr << "ERROR: the input file <" << file.inpfilename << "> in <" << manifest << "> is also an output file." << std::endl;
+            return 2;
+         }
+      }
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // ScreenFile
+   //
+   //    Plan, run and write one file of a batch, on the given number of
+   //    threads.  Return 0, or the exit status for the file.
+   //--------------------------------------------------------------------------
+   int ScreenFile( BatchFile& file, EngineOptions options, const ModelSpec& model, const PlanSpec& planspec, double memory_limit, bool volumetric, int threads )
+   {
+      options.threads = threads;
+
+      Plan plan;
+      MakePlan( file.x, file.y, ( volumetric ? &file.elev : nullptr ), file.radius, options, memory_limit, planspec.automatic, plan );
+      ApplyPlan( plan, options );
+
+      if( planspec.gridded && !volumetric && !options.geographic )
+      {
+         RegularGrid grid;
+         if( !DetectRegularGrid( file.x, file.y, grid ) )
+         {
+            std::cerr << "ERROR: the data in <" << file.inpfilename << "> are not on a regular grid." << std::endl;
+            return 5;
+         }
+      }
+
+      if( !options.checkpoint.empty() || options.resume )
+         options.checkpoint = file.outfilename + ".ckpt";
+
+      std::vector<Boomerang> results = RunEngine( file.x, file.y, file.elev, file.z, file.radius, options, model );
+
+      std::ofstream outfile( file.outfilename );
+      if( outfile.fail() )
+      {
+         std::cerr << "ERROR: could not open the output file <" << file.outfilename << "> for output." << std::endl;
+         return 4;
+      }
+      WriteResults( outfile, file.id, file.x, file.y, file.elev, file.z, results, options.simulations > 0 );
+
+      outfile.close();
+      if( outfile.fail() )
+         return 4;
+      if( !options.checkpoint.empty() )
+         std::remove( options.checkpoint.c_str() );
+      return 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunBatch
+   //
+   //    The "batch" subcommand: screen every file in a manifest, in one
+   //    process, writing each to its own output file.
+   //
+   // Notes:
+   //
+   // o  The cost of a file is taken as N^3, for its N Cholesky
+   //    decompositions of order N.  A file is big if it costs more than
+   //    the fair share of one thread of the whole batch.
+   //
+   // o  The big files run one after the other, each on all of the threads.
+   //    The small files are then packed together: each runs on one
+   //    thread, the costliest first, handed out to the threads as they
+   //    become free.  The memory limit of the plan is split between them.
+   //    Under --affinity, the file on thread t is pinned to the processor
+   //    of thread t, not to that of thread 0 of a one-thread run.
+   //
+   // o  A file that fails does not stop the others.  The exit status is
+   //    that of the first file, in manifest order, that failed.
+   //--------------------------------------------------------------------------
+   int RunBatch( const std::vector<std::string>& args, const EngineOptions& options, const ModelSpec& model, const PlanSpec& planspec, bool volumetric )
+   {
+      if( options.nshards > 1 )
+      {
+         std::cerr << "ERROR: --shard does not apply to the batch subcommand." << std::endl;
+         return 1;
+      }
+
+      std::vector<BatchFile> files;
+      int status = ReadManifest( args[1], files );
+      if( status != 0 )
+         return status;
+
+      // Read in the observation data from every file.
+      double total = 0.0;
+      for( auto& file : files )
+      {
+         std::ifstream inpfile( file.inpfilename );
+         if( inpfile.fail() )
+         {
+            std::cerr << "ERROR: could not open the specified input file <" << file.inpfilename << "> for input." << std::endl;
+            file.status = 3;
+            continue;
+         }
+
+         if( volumetric )
+            ReadData( inpfile, file.id, file.x, file.y, file.elev, file.z );
+         else
+            ReadData( inpfile, file.id, file.x, file.y, file.z );
+
+         if( file.x.size() < 2 )
+         {
+            std::cerr << "ERROR: fewer than two data in <" << file.inpfilename << ">." << std::endl;
+            file.status = 5;
+            continue;
+         }
+
+         file.cost = pow( double( file.x.size() ), 3 );
+         total += file.cost;
+      }
+
+      // Divide the files into big and small, each the costliest first.
+      const int T = ThreadCount( options.threads );
+      std::vector<BatchFile*> big, small;
+      for( auto& file : files )
+      {
+         if( file.status == 0 )
+            ( T > 1 && file.cost > total/T ? big : small ).push_back( &file );
+      }
+
+      auto costlier = []( const BatchFile* a, const BatchFile* b ){ return a->cost > b->cost; };
+      std::stable_sort( big.begin(), big.end(), costlier );
+      std::stable_sort( small.begin(), small.end(), costlier );
+
+      std::cout << std::endl << files.size() << " files in <" << args[1] << ">: " << big.size() << " big, "
+                << small.size() << " small, on " << T << " thread" << ( T == 1 ? "" : "s" ) << "." << std::endl;
+
+      const double memory_limit = ( planspec.memory > 0 ? planspec.memory*1024*1024 : PhysicalMemory() );
+
+      std::mutex mutex;
+      auto Screen = [&]( BatchFile& file, double limit, int threads )
+      {
+         file.status = ScreenFile( file, options, model, planspec, limit, volumetric, threads );
+
+         std::lock_guard<std::mutex> lock( mutex );
+         if( file.status == 0 )
+            std::cout << file.x.size() << " data read from <" << file.inpfilename << ">, written to <" << file.outfilename << ">." << std::endl;
+
+         // The data are no longer needed.
+         std::vector<int>().swap( file.id );
+         std::vector<double>().swap( file.x );
+         std::vector<double>().swap( file.y );
+         std::vector<double>().swap( file.elev );
+         std::vector<double>().swap( file.z );
+      };
+
+      for( auto file : big )
+         Screen( *file, memory_limit, T );
+
+      ParallelFor( int(small.size()), T, [&]( int k, int thread )
+      {
+         ProcessorShare share( thread, T );
+         Screen( *small[k], memory_limit / T, 1 );
+      });
+
+      // The exit status.
+      int done = 0;
+      status = 0;
+      for( const auto& file : files )
+      {
+         if( file.status == 0 )
+            ++done;
+         else if( status == 0 )
+            status = file.status;
+      }
+      std::cout << std::endl << done << " of " << files.size() << " files screened." << std::endl;
+      return status;
+   }
+
+   //--------------------------------------------------------------------------
+   // RunPrepared
+   //
+   //    Run the prepared Engine with the variogram model.
+   //--------------------------------------------------------------------------
+   std::vector<Boomerang> RunPrepared(
+      const BoomerangEngine& engine,
+      const std::vector<double>& z,
+      double radius,
+      const EngineOptions& options,
+      const ModelSpec& model )
+   {
+      switch( model.type )
+      {
+      case MODEL_POWER:
+         return engine.Run( z, radius, options, PowerVariogram( model.exponent, model.nugget ) );
+      case MODEL_EXPONENTIAL:
+         return engine.Run( z, radius, options, ExponentialVariogram( model.range, model.nugget ) );
+      case MODEL_SPHERICAL:
+         return engine.Run( z, radius, options, SphericalVariogram( model.range, model.nugget ) );
+      case MODEL_GAUSSIAN:
+         return engine.Run( z, radius, options, GaussianVariogram( model.range, model.nugget ) );
+      default:
+         return engine.Run( z, radius, options, LinearVariogram( model.nugget ) );
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // GeometryCache
+   //
+   //    The most recently used prepared Engines of the server, keyed by the
+   //    hash of the locations and of the options that Prepare fixes.  An
+   //    Engine is prepared outside of the lock, so a slow preparation does
+   //    not hold up the jobs on other data.
+   //--------------------------------------------------------------------------
+   class GeometryCache
+   {
+   public:
+      explicit GeometryCache( int capacity )
+      :  m_Capacity( std::max( capacity, 1 ) )
+      {
+      }
+
+      std::shared_ptr<const BoomerangEngine> Get(
+         const std::vector<double>& x,
+         const std::vector<double>& y,
+         const std::vector<double>& elev,
+         const EngineOptions& options,
+         bool& warm )
+      {
+         const uint64_t key = Key( x, y, elev, options );
+
+         {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            for( auto it = m_Engines.begin(); it != m_Engines.end(); ++it )
+            {
+               if( it->first == key )
+               {
+                  m_Engines.splice( m_Engines.begin(), m_Engines, it );
+                  warm = true;
+                  return m_Engines.front().second;
+               }
+            }
+         }
+
+         std::shared_ptr<BoomerangEngine> engine( new BoomerangEngine );
+         if( elev.empty() )
+            engine->Prepare( x, y, options );
+         else
+            engine->Prepare( x, y, elev, options );
+
+         std::lock_guard<std::mutex> lock( m_Mutex );
+         m_Engines.emplace_front( key, engine );
+         if( int(m_Engines.size()) > m_Capacity )
+            m_Engines.pop_back();
+         warm = false;
+         return engine;
+      }
+
+   private:
+      static uint64_t Key( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, const EngineOptions& options )
+      {
+         uint64_t hash = HashBytes( x );
+         hash = HashBytes( y, hash );
+         hash = HashBytes( elev, hash );
+
+         const double settings[] = {
+            double( options.grid_mode ),
+            options.anisotropy.angle,
+            options.anisotropy.ratio,
+            options.anisotropy.vertical,
+            double( options.geographic ),
+            double( options.single_precision ),
+            double( options.pages ),
+            options.duplicate_tolerance
+         };
+         return HashBytes( settings, sizeof(settings), hash );
+      }
+
+      const int m_Capacity;
+      std::mutex m_Mutex;
+      std::list< std::pair< uint64_t, std::shared_ptr<const BoomerangEngine> > > m_Engines;
+   };
+
+   //--------------------------------------------------------------------------
+   // ServeJob
+   //
+   //    Run one job of the server: read the data, plan, prepare or reuse
+   //    the Engine, and run it on a pooled thread.  Write a progress line
+   //    about once a second, and then the results, as "Aakozi.out" would
+   //    have them, and "done <N>".  The job is cancelled if this client
+   //    goes away; a job that is running when the server is stopped is
+   //    finished.  Return false if the client is gone.
+   //--------------------------------------------------------------------------
+   bool ServeJob(
+      Connection& connection,
+      const std::vector<std::string>& jobargs,
+      const std::string& filename,
+      const std::string& data,
+      double radius,
+      EngineOptions options,
+      ModelSpec model,
+      PlanSpec planspec,
+      bool volumetric,
+      GeometryCache& cache )
+   {
+      // The options of the job add to those of the server.
+      const std::string distance_cache = options.distance_cache;
+      std::vector<char*> argv( 1, nullptr );
+      for( auto& arg : jobargs )
+         argv.push_back( const_cast<char*>( arg.c_str() ) );
+
+      std::vector<std::string> args;
+      if( !ParseOptions( int(argv.size()), argv.data(), args, options, model, planspec, volumetric ) || !args.empty() )
+         return connection.Write( "error invalid option\n" );
+
+      if( volumetric && options.geographic )
+         return connection.Write( "error --3d and --geographic may not be combined\n" );
+
+      if( radius <= 0.0 )
+         return connection.Write( "error the radius must be positive\n" );
+
+      // The server writes no files, but those of the distance cache given
+      // when it was started; a job may not name another directory.
+      options.distance_cache = distance_cache;
+      options.shard = 0;
+      options.nshards = 1;
+      options.checkpoint.clear();
+      options.resume = false;
+      options.distance_error = nullptr;
+      options.xi_sums = nullptr;
+
+      // The jobs of the clients run side by side, each on all of the
+      // threads, so pinning would stack them on the same processors.
+      options.affinity = AFFINITY_NONE;
+
+      // Read in the observation data.
+      std::vector<double> x, y, elev, z;
+      std::vector<int> id;
+      {
+         std::ifstream inpfile;
+         std::istringstream inline_data( data );
+         if( !filename.empty() )
+         {
+            inpfile.open( filename );
+            if( inpfile.fail() )
+               return connection.Write( "error could not open <" + filename + ">\n" );
+         }
+
+         std::istream& input = filename.empty() ? static_cast<std::istream&>( inline_data ) : inpfile;
+         if( volumetric )
+            ReadData( input, id, x, y, elev, z );
+         else
+            ReadData( input, id, x, y, z );
+      }
+
+      if( x.size() < 2 )
+         return connection.Write( "error fewer than two data\n" );
+
+      // Choose the strategy.
+      Plan plan;
+      double memory_limit = ( planspec.memory > 0 ? planspec.memory*1024*1024 : PhysicalMemory() );
+      MakePlan( x, y, ( volumetric ? &elev : nullptr ), radius, options, memory_limit, planspec.automatic, plan );
+      ApplyPlan( plan, options );
+
+      if( planspec.gridded && !volumetric && !options.geographic )
+      {
+         RegularGrid grid;
+         if( !DetectRegularGrid( x, y, grid ) )
+            return connection.Write( "error the data are not on a regular grid\n" );
+      }
+
+      // Prepare the Engine, or reuse the one for these locations.
+      bool warm = false;
+      std::shared_ptr<const BoomerangEngine> engine = cache.Get( x, y, elev, options, warm );
+      if( !connection.Write( std::string( warm ? "cached" : "prepared" ) + " geometry\n" ) )
+         return false;
+
+      // Run it on a pooled thread.
+      auto progress = std::make_shared<EngineProgress>();
+      progress->total = engine->size();
+      options.progress = progress.get();
+
+      auto task = std::make_shared< std::packaged_task< std::vector<Boomerang>() > >(
+         [engine, z, radius, options, model]()
+         {
+            return RunPrepared( *engine, z, radius, options, model );
+         } );
+
+      std::shared_future< std::vector<Boomerang> > result = task->get_future().share();
+      EngineJob job( progress, result );
+      RunAsync( [task]{ (*task)(); } );
+
+      bool connected = true;
+      while( !job.Ready() )
+      {
+         std::ostringstream line;
+         line << "progress " << job.Completed() << ' ' << job.Total() << '\n';
+         if( connected && !connection.Write( line.str() ) )
+            connected = false;
+
+         if( !connected && !job.Cancelled() )
+            job.Cancel();
+
+         result.wait_for( PROGRESS_INTERVAL );
+      }
+
+      std::vector<Boomerang> results = job.Get();
+      if( !connected )
+         return false;
+      if( job.Cancelled() )
+         return connection.Write( "error cancelled\n" );
+
+      std::ostringstream output;
+      WriteResults( output, id, x, y, elev, z, results, options.simulations > 0 );
+      output << "done " << x.size() << '\n';
+      return connection.Write( output.str() );
+   }
+
+   //--------------------------------------------------------------------------
+   // RunServer
+   //
+   //    The "serve" subcommand: a daemon on a Unix domain socket.  Each
+   //    client sends lines of requests; a job is
+   //
+   //       radius <r>
+   //       option <--name=value>        (any number)
+   //       file <path>                  (or)
+   //       data
+   //       <id x y z, or id x y elev z, per line>
+   //       end
+   //       run
+   //
+   //    The options apply to the one job, on top of the options given to
+   //    the server, except --cache: only the server's directory is used.
+   //    The jobs run side by side, so they are not pinned (--affinity).
+   //    A client may run any number of jobs, one after the other;
+   //    "shutdown" stops the server once the running jobs end.
+   //--------------------------------------------------------------------------
+   int RunServer( const std::vector<std::string>& args, const EngineOptions& options, const ModelSpec& model, const PlanSpec& planspec, bool volumetric )
+   {
+      int capacity = DEFAULT_GEOMETRIES;
+      if( args.size() == 3 )
+      {
+         capacity = atoi( args[2].c_str() );
+         if( capacity < 1 )
+         {
+            std::cerr << "ERROR: the number of cached geometries = " << args[2] << " is not valid;  0 < ngeometries." << std::endl;
+            Usage();
+            return 2;
+         }
+      }
+
+      GeometryCache cache( capacity );
+      std::atomic<bool> stop( false );
+
+      auto handler = [&]( Connection& connection )
+      {
+         std::vector<std::string> jobargs;
+         std::string filename, data;
+         double radius = 0.0;
+
+         std::string line;
+         while( connection.ReadLine( line ) )
+         {
+            std::istringstream is( line );
+            std::string command, value;
+            is >> command;
+            std::getline( is >> std::ws, value );
+
+            bool connected = true;
+            if( command.empty() )
+               continue;
+            else if( command == "radius" )
+               radius = atof( value.c_str() );
+            else if( command == "option" )
+               jobargs.push_back( value );
+            else if( command == "file" )
+            {
+               filename = value;
+               data.clear();
+            }
+            else if( command == "data" )
+            {
+               filename.clear();
+               data.clear();
+               while( connection.ReadLine( line ) && line != "end" )
+                  data += line + '\n';
+            }
+            else if( command == "run" )
+            {
+               connected = ServeJob( connection, jobargs, filename, data, radius, options, model, planspec, volumetric, cache );
+               jobargs.clear();
+               filename.clear();
+               data.clear();
+               radius = 0.0;
+            }
+            else if( command == "shutdown" )
+            {
+               stop = true;
+               connection.Write( "bye\n" );
+               break;
+            }
+            else
+               connected = connection.Write( "error unknown request <" + command + ">\n" );
+
+            if( !connected )
+               break;
+         }
+      };
+
+      std::cout << std::endl << "serving on <" << args[1] << ">." << std::endl;
+      if( !ServeUnixSocket( args[1], handler, stop ) )
+         return 4;
+
+      std::cout << "shut down." << std::endl;
+      return 0;
+   }
 }
 
 
@@ -56,7 +1601,164 @@ namespace{
 int main(int argc, char* argv[])
 {
    // Check the command line.
-   if( argc != 3 )
+   std::vector<std::string> args;
+   EngineOptions options;
+   ModelSpec model;
+   PlanSpec planspec;
+   bool volumetric = false;
+
+   if( !ParseOptions(argc, argv, args, options, model, planspec, volumetric) )
+   {
+      Usage();
+      return 1;
+   }
+
+   if( volumetric && options.geographic )
+   {
+      std::cerr << "ERROR: --3d and --geographic may not be combined." << std::endl;
+      Usage();
+      return 1;
+   }
+
+   // The empirical variogram subcommand.
+   if( !args.empty() && args[0] == "variogram" )
+   {
+      if( args.size() != 3 && args.size() != 4 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+
+      if( !options.anisotropy.IsIsotropic() )
+         std::cerr << "WARNING: the anisotropy applies to the boomerang statistics only." << std::endl;
+
+      if( volumetric || options.geographic )
+      {
+         std::cerr << "ERROR: --3d and --geographic apply to the boomerang statistics only." << std::endl;
+         return 1;
+      }
+
+      int status = RunVariogram( args, options );
+      if( status == 0 )
+      {
+         double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
+         std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
+      }
+      return status;
+   }
+
+   // The prediction subcommand.
+   if( !args.empty() && args[0] == "predict" )
+   {
+      if( args.size() != 7 && args.size() != 8 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+
+      if( !options.anisotropy.IsIsotropic() )
+         std::cerr << "WARNING: the anisotropy applies to the boomerang statistics only." << std::endl;
+
+      if( volumetric || options.geographic )
+      {
+         std::cerr << "ERROR: --3d and --geographic apply to the boomerang statistics only." << std::endl;
+         return 1;
+      }
+
+      int status = RunPredict( args, options, model );
+      if( status == 0 )
+      {
+         double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
+         std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
+      }
+      return status;
+   }
+
+   // The block cross-validation subcommand.
+   if( !args.empty() && args[0] == "cv" )
+   {
+      if( args.size() != 4 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+
+      if( volumetric || options.geographic )
+      {
+         std::cerr << "ERROR: --3d and --geographic apply to the boomerang statistics only." << std::endl;
+         return 1;
+      }
+
+      int status = RunCrossValidation( args, options, model );
+      if( status == 0 )
+      {
+         double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
+         std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
+      }
+      return status;
+   }
+
+   // The shard merge subcommand.
+   if( !args.empty() && args[0] == "merge" )
+   {
+      if( args.size() < 3 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+
+      int status = RunMerge( args, volumetric );
+      if( status == 0 )
+      {
+         double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
+         std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
+      }
+      return status;
+   }
+
+   // The batch subcommand.
+   if( !args.empty() && args[0] == "batch" )
+   {
+      if( args.size() != 2 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+
+      int status = RunBatch( args, options, model, planspec, volumetric );
+      if( status == 0 )
+      {
+         double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
+         std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
+      }
+      return status;
+   }
+
+   // The daemon.
+   if( !args.empty() && args[0] == "serve" )
+   {
+      if( args.size() != 2 && args.size() != 3 )
+      {
+         Usage();
+         return 1;
+      }
+
+      Banner( std::cout );
+      return RunServer( args, options, model, planspec, volumetric );
+   }
+
+   // The boomerang statistics.
+   if( args.size() != 2 )
    {
       Usage();
       return 1;
@@ -67,27 +1769,33 @@ int main(int argc, char* argv[])
    }
 
    // Get and check the buffer radius.
-   double radius = atof( argv[2] );
+   double radius = atof( args[1].c_str() );
    if( radius <= 0.0 )
    {
-      std::cerr << "ERROR: buffer radius = " << argv[2] << " is not valid;  0 < radius." << std::endl;
+      std::cerr << "ERROR: buffer radius = " << args[1] << " is not valid;  0 < radius." << std::endl;
       std::cerr << std::endl;
       Usage();
       return 2;
    }
 
    // Open the specified data file.
-   std::string inpfilename = argv[1];
-   std::ifstream inpfile( argv[1] );
+   std::string inpfilename = args[0];
+   std::ifstream inpfile( inpfilename );
    if( inpfile.fail() )
    {
-      std::cerr << "ERROR: could not open the specified input file <" << argv[1] << "> for input." << std::endl;
+      std::cerr << "ERROR: could not open the specified input file <" << inpfilename << "> for input." << std::endl;
       Usage();
       return 3;
    }
 
+   if( options.nshards > 1 && options.simulations > 0 )
+   {
+      std::cerr << "ERROR: --shard and --simulations may not be combined." << std::endl;
+      return 1;
+   }
+
    // Open the specified output file.
-   std::string outfilename = "Aakozi.out";
+   std::string outfilename = ( options.nshards > 1 ? ShardFileName( options ) : "Aakozi.out" );
    std::ofstream outfile( outfilename );
    if( outfile.fail() )
    {
@@ -96,49 +1804,88 @@ int main(int argc, char* argv[])
       return 4;
    }
 
+   // The checkpoint file, next to the output file.
+   if( !options.checkpoint.empty() || options.resume )
+   {
+      options.checkpoint = outfilename + ".ckpt";
+      if( options.resume && std::ifstream( options.checkpoint ).good() )
+         std::cout << std::endl << "resuming from <" << options.checkpoint << ">." << std::endl;
+   }
+
    // Read in the observation data from the specified data file.
    std::vector<double> x;
    std::vector<double> y;
+   std::vector<double> elev;
    std::vector<double> z;
    std::vector<int>   id;
 
-   std::string line;
+   if( volumetric )
+      ReadData( inpfile, id, x, y, elev, z );
+   else
+      ReadData( inpfile, id, x, y, z );
+   inpfile.close();
+
+   int N = x.size();
+   std::cout << std::endl << N << " data read from <" << inpfilename << ">. \n";
+
+   // Choose the strategy, and explain the choice.
+   Plan plan;
+   double memory_limit = ( planspec.memory > 0 ? planspec.memory*1024*1024 : PhysicalMemory() );
+   MakePlan( x, y, ( volumetric ? &elev : nullptr ), radius, options, memory_limit, planspec.automatic, plan );
+   ApplyPlan( plan, options );
+   Explain( plan, std::cout );
 
-   double xx, yy, zz;
-   int ii;
-   while( std::getline(inpfile, line) )
+   // Check the declared grid.
+   if( options.grid_mode != GRID_OFF && !volumetric && !options.geographic )
    {
-      std::istringstream is(line);
-      if( is >> ii >> xx >> yy >> zz )
+      RegularGrid grid;
+      if( DetectRegularGrid(x, y, grid) )
+      {
+         std::cout << "regular " << grid.nx << " x " << grid.ny << " grid detected; using the FFT solver." << std::endl;
+      }
+      else if( planspec.gridded )
       {
-         id.push_back(ii);
-         x.push_back(xx);
-         y.push_back(yy);
-         z.push_back(zz);
+         std::cerr << "ERROR: the data in <" << inpfilename << "> are not on a regular grid." << std::endl;
+         return 5;
       }
    }
-   inpfile.close();
-
-   int N = x.size();
-   std::cout << std::endl << N << " data read from <" << argv[1] << ">. \n";
 
    // Fill the output file with the results.
-   std::vector<Boomerang> results = Engine(x,y,z,radius);
+   double distance_error = NAN;
+   options.distance_error = &distance_error;
+
+   XiSums xi_sums;
+   options.xi_sums = &xi_sums;
 
-   for( int n=1; n<N; ++n )
+   std::vector<Boomerang> results = RunEngine(x,y,elev,z,radius,options,model);
+
+   if( !std::isnan( distance_error ) )
+      std::cout << "single precision distances: maximum error = " << std::scientific << std::setprecision(3) << distance_error << std::endl;
+
+   if( options.nshards > 1 )
    {
-      outfile << std::fixed << std::setw(12)                         << id[n];
-      outfile << std::fixed << std::setw(12) << std::setprecision(2) << x[n];
-      outfile << std::fixed << std::setw(12) << std::setprecision(2) << y[n];
-      outfile << std::fixed << std::setw(12) << std::setprecision(2) << z[n];
-      outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[n].zhat;
-      outfile << std::fixed << std::setw(12) << std::setprecision(2) << results[n].zeta;
-      outfile << std::fixed << std::setw(12) << std::setprecision(3) << results[n].pvalue;
-      outfile << std::fixed << std::setw(12)                         << results[n].cnt;
-      outfile << std::endl;
+      ShardHeader header;
+      header.shard   = options.shard+1;
+      header.nshards = options.nshards;
+      header.N       = N;
+      header.data    = DataHash( x, y, elev, z );
+      header.key     = RunKey( header.data, radius, options, model.type, model.range, model.exponent, model.nugget );
+      header.sums    = xi_sums;
+
+      WriteShard( outfile, header, results );
+      std::cout << "shard " << options.shard+1 << " of " << options.nshards << " written to <" << outfilename << ">." << std::endl;
+   }
+   else
+   {
+      WriteResults( outfile, id, x, y, elev, z, results, options.simulations > 0 );
    }
    inpfile.close();
 
+   // The checkpoint is no longer needed.
+   outfile.close();
+   if( !options.checkpoint.empty() && !outfile.fail() )
+      std::remove( options.checkpoint.c_str() );
+
    // Successful termination.
    double elapsed = static_cast<double>(clock())/CLOCKS_PER_SEC;
    std::cout << std::endl << "elapsed time: " << std::fixed << elapsed << " seconds." << std::endl;
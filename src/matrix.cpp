@@ -662,6 +662,34 @@ void Slice( const Matrix& A, const std::vector<int>& row_flag, const std::vector
    }
 }
 
+//-----------------------------------------------------------------------------
+// Slice Matrix operations, with packed flags.  Only the set bits are
+// visited; the column indices are gathered once.
+//-----------------------------------------------------------------------------
+void Slice( const Matrix& A, const BitMask& row_mask, const BitMask& col_mask, Matrix& C )
+{
+   assert( row_mask.size() == A.nRows() );
+   assert( col_mask.size() == A.nCols() );
+
+   std::vector<int> cols;
+   col_mask.Indices( cols );
+
+   const int nCols = cols.size();
+   C.Resize( row_mask.Count(), nCols );
+   if( nCols == 0 )
+      return;
+
+   int row = 0;
+   row_mask.ForEach( [&]( int i )
+   {
+      const double* Ai = A.Base(i,0);
+      double*       Ci = C.Base(row,0);
+      for( int c=0; c<nCols; ++c )
+         Ci[c] = Ai[ cols[c] ];
+      ++row;
+   });
+}
+
 
 //=============================================================================
 // scalar/Matrix arithmetic routines.
@@ -15,6 +15,8 @@
 #include <iostream>
 #include <vector>
 
+#include "bit_mask.h"
+
 //=============================================================================
 // Matrix
 //=============================================================================
@@ -101,6 +103,7 @@ void Identity( Matrix& A, int n );                                   // A = I(n)
 // Slice Matrix operations.
 //=============================================================================
 void Slice( const Matrix& A, const std::vector<int>& row_flag, const std::vector<int>& col_flag, Matrix& C );
+void Slice( const Matrix& A, const BitMask& row_mask, const BitMask& col_mask, Matrix& C );
 
 //=============================================================================
 // scalar/Matrix arithmetic routines.
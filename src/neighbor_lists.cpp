@@ -0,0 +1,180 @@
+//=============================================================================
+// neighbor_lists.cpp
+//
+//    Pre-sorted, per-observation neighbor lists truncated at a maximum
+//    radius.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "neighbor_lists.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "parallel.h"
+#include "spatial_index.h"
+
+//-----------------------------------------------------------------------------
+// Constructors.
+//-----------------------------------------------------------------------------
+NeighborLists::NeighborLists( const std::vector<double>& x, const std::vector<double>& y, double maxradius, int nthreads, const Anisotropy& anisotropy )
+:  m_MaxRadius( maxradius ),
+   m_Anisotropy( anisotropy ),
+   m_Volumetric( false ),
+   m_start(),
+   m_index(),
+   m_distance()
+{
+   Build( x, y, nullptr, nthreads );
+}
+
+//-----------------------------------------------------------------------------
+NeighborLists::NeighborLists( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, double maxradius, int nthreads, const Anisotropy& anisotropy )
+:  m_MaxRadius( maxradius ),
+   m_Anisotropy( anisotropy ),
+   m_Volumetric( true ),
+   m_start(),
+   m_index(),
+   m_distance()
+{
+   assert( elev.size() == x.size() );
+   Build( x, y, &elev, nthreads );
+}
+
+//-----------------------------------------------------------------------------
+// Build
+//
+//    The candidates for each observation come from a bucket grid with cells
+//    of size maxradius.  The separation distances are computed exactly as in
+//    Engine(), from the same centered coordinates with the same kernels, so
+//    a neighbor is in the buffer set here if, and only if, it is outside of
+//    the active set there.
+//
+//    With an anisotropy, the search radius is stretched to maxradius/ratio
+//    (and maxradius/vertical in 3-D), which bounds the Euclidean length of
+//    any neighbor's separation.
+//-----------------------------------------------------------------------------
+void NeighborLists::Build( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* elev, int nthreads )
+{
+   assert( x.size() == y.size() );
+   assert( m_MaxRadius > 0 );
+   const int N = x.size();
+   const double maxradius = m_MaxRadius;
+   const Anisotropy& anisotropy = m_Anisotropy;
+
+   std::vector<double> X, Y;
+   CenterCoordinates( x, y, X, Y );
+
+   double search = maxradius/anisotropy.ratio;
+   if( elev != nullptr )
+      search = std::max( search, maxradius/anisotropy.vertical );
+
+   std::unique_ptr<SpatialIndex> grid( elev == nullptr ? new SpatialIndex( X, Y, search ) : new SpatialIndex( X, Y, *elev, search ) );
+
+   // Build each list separately, in parallel.
+   std::vector< std::vector< std::pair<double,int> > > lists( N );
+   ParallelFor( N, nthreads, [&]( int k, int )
+   {
+      std::vector<int> runs;
+      if( elev == nullptr )
+         grid->Query( X[k], Y[k], search, runs );
+      else
+         grid->Query( X[k], Y[k], (*elev)[k], search, runs );
+
+      std::vector< std::pair<double,int> >& list = lists[k];
+      std::vector<double> dist;
+      for( unsigned r=0; r<runs.size(); r += 2 )
+      {
+         // Each run is contiguous in the index's coordinate arrays.
+         const int n = runs[r+1] - runs[r];
+         const int b = runs[r];
+         dist.resize( n );
+         if( elev != nullptr )
+            Distances( X[k], Y[k], (*elev)[k], grid->X()+b, grid->Y()+b, grid->Z()+b, n, anisotropy, dist.data() );
+         else if( anisotropy.IsIsotropic() )
+            Distances( X[k], Y[k], grid->X()+b, grid->Y()+b, n, dist.data() );
+         else
+            Distances( X[k], Y[k], grid->X()+b, grid->Y()+b, n, anisotropy, dist.data() );
+
+         for( int p=b; p<runs[r+1]; ++p )
+         {
+            if( dist[ p-b ] <= maxradius )
+               list.push_back( std::make_pair( dist[ p-b ], grid->Original(p) ) );
+         }
+      }
+      std::sort( list.begin(), list.end() );
+   });
+
+   // Pack the lists into contiguous storage.
+   m_start.assign( N+1, 0 );
+   for( int k=0; k<N; ++k )
+      m_start[k+1] = m_start[k] + lists[k].size();
+
+   m_index.resize( m_start[N] );
+   m_distance.resize( m_start[N] );
+   for( int k=0; k<N; ++k )
+   {
+      for( unsigned i=0; i<lists[k].size(); ++i )
+      {
+         m_distance[ m_start[k]+i ] = lists[k][i].first;
+         m_index[ m_start[k]+i ]    = lists[k][i].second;
+      }
+      std::vector< std::pair<double,int> >().swap( lists[k] );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Number of observations.
+//-----------------------------------------------------------------------------
+int NeighborLists::size() const
+{
+   return m_start.size()-1;
+}
+
+//-----------------------------------------------------------------------------
+// The truncation radius.
+//-----------------------------------------------------------------------------
+double NeighborLists::MaxRadius() const
+{
+   return m_MaxRadius;
+}
+
+//-----------------------------------------------------------------------------
+const Anisotropy& NeighborLists::GetAnisotropy() const
+{
+   return m_Anisotropy;
+}
+
+//-----------------------------------------------------------------------------
+bool NeighborLists::IsVolumetric() const
+{
+   return m_Volumetric;
+}
+
+//-----------------------------------------------------------------------------
+// Buffer
+//
+//    Return the number of observations within the given radius of
+//    observation k (i.e. distance <= radius), and set index to point at
+//    their indices, nearest first.  The observation k itself is included.
+//    The radius must not exceed MaxRadius().
+//-----------------------------------------------------------------------------
+int NeighborLists::Buffer( int k, double radius, const int*& index ) const
+{
+   assert( radius <= m_MaxRadius );
+
+   const double* begin = m_distance.data() + m_start[k];
+   const double* end   = m_distance.data() + m_start[k+1];
+
+   index = m_index.data() + m_start[k];
+   return std::upper_bound( begin, end, radius ) - begin;
+}
@@ -0,0 +1,51 @@
+//=============================================================================
+// neighbor_lists.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef NEIGHBOR_LISTS_H
+#define NEIGHBOR_LISTS_H
+
+#include <vector>
+#include "distance.h"
+
+//=============================================================================
+// NeighborLists
+//
+//    For each observation, the indices of all of the observations within a
+//    maximum radius (including itself), sorted by separation distance.  The
+//    buffer set for any radius <= the maximum is then a prefix of the list.
+//=============================================================================
+class NeighborLists
+{
+public:
+   NeighborLists( const std::vector<double>& x, const std::vector<double>& y, double maxradius, int nthreads, const Anisotropy& anisotropy = Anisotropy() );
+   NeighborLists( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& elev, double maxradius, int nthreads, const Anisotropy& anisotropy = Anisotropy() );
+
+   int    size() const;                               // number of observations
+   double MaxRadius() const;                          // the truncation radius
+   const Anisotropy& GetAnisotropy() const;           // the distance metric
+   bool   IsVolumetric() const;                       // built from 3-D observations
+
+   int Buffer( int k, double radius, const int*& index ) const;
+
+private:
+   double                  m_MaxRadius;
+   Anisotropy              m_Anisotropy;
+   bool                    m_Volumetric;
+   std::vector<long long>  m_start;                   // first entry of each list
+   std::vector<int>        m_index;                   // neighbor indices
+   std::vector<double>     m_distance;                // neighbor distances
+
+   void Build( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* elev, int nthreads );
+};
+
+
+//=============================================================================
+#endif  // NEIGHBOR_LISTS_H
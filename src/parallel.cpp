@@ -0,0 +1,393 @@
+//=============================================================================
+// parallel.cpp
+//
+//    A minimal set of shared-memory parallel loop constructs built on the
+//    standard library threads.  The threads are kept in a pool and reused
+//    by later loops.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#define PARALLEL_PTHREAD_AFFINITY
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#define PARALLEL_WIN32_AFFINITY
+#endif
+
+namespace{
+   // The share of the processors given to the loops started on this
+   // thread; see ProcessorShare.  A total of zero means no share.
+   thread_local int share_first = 0;
+   thread_local int share_total = 0;
+
+   //--------------------------------------------------------------------------
+   // Affinity
+   //
+   //    Pin the calling thread to the logical processor cpu (none if cpu is
+   //    negative) for the duration of a loop, and restore its previous
+   //    affinity afterwards.  Pinning is best effort: a failure
+   //    leaves the thread unpinned.
+   //--------------------------------------------------------------------------
+   class Affinity
+   {
+   public:
+      explicit Affinity( int cpu )
+      :  m_Pinned( false )
+      {
+         if( cpu < 0 )
+            return;
+
+#if defined(PARALLEL_PTHREAD_AFFINITY)
+         if( cpu >= CPU_SETSIZE || pthread_getaffinity_np( pthread_self(), sizeof(m_Saved), &m_Saved ) != 0 )
+            return;
+
+         cpu_set_t set;
+         CPU_ZERO( &set );
+         CPU_SET( cpu, &set );
+         m_Pinned = ( pthread_setaffinity_np( pthread_self(), sizeof(set), &set ) == 0 );
+#elif defined(PARALLEL_WIN32_AFFINITY)
+         if( cpu >= int(8*sizeof(DWORD_PTR)) )
+            return;
+
+         m_Saved  = SetThreadAffinityMask( GetCurrentThread(), DWORD_PTR(1) << cpu );
+         m_Pinned = ( m_Saved != 0 );
+#else
+         (void) cpu;
+#endif
+      }
+
+      ~Affinity()
+      {
+         if( !m_Pinned )
+            return;
+
+#if defined(PARALLEL_PTHREAD_AFFINITY)
+         pthread_setaffinity_np( pthread_self(), sizeof(m_Saved), &m_Saved );
+#elif defined(PARALLEL_WIN32_AFFINITY)
+         SetThreadAffinityMask( GetCurrentThread(), m_Saved );
+#endif
+      }
+
+   private:
+      bool m_Pinned;
+
+#if defined(PARALLEL_PTHREAD_AFFINITY)
+      cpu_set_t m_Saved;
+#elif defined(PARALLEL_WIN32_AFFINITY)
+      DWORD_PTR m_Saved;
+#endif
+   };
+
+   //--------------------------------------------------------------------------
+   // ThreadPool
+   //
+   //    Idle worker threads waiting for a task.  Acquire hands out an idle
+   //    worker, starting a new one only if there is none, so the pool grows
+   //    to the largest number of tasks that have run at once.  Loops running
+   //    concurrently on different threads, or nested, each get their own
+   //    workers.
+   //--------------------------------------------------------------------------
+   class ThreadPool
+   {
+   public:
+      class Worker
+      {
+      public:
+         Worker( ThreadPool& pool )
+         :  m_Pool( pool ),
+            m_Stop( false ),
+            m_Thread( &Worker::Loop, this )
+         {
+         }
+
+         // Run the task, then return to the pool, and then call finish.
+         void Run( const std::function<void()>& task, const std::function<void()>& finish )
+         {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_Task   = task;
+            m_Finish = finish;
+            m_Ready.notify_one();
+         }
+
+         void Stop()
+         {
+            {
+               std::lock_guard<std::mutex> lock( m_Mutex );
+               m_Stop = true;
+               m_Ready.notify_one();
+            }
+            m_Thread.join();
+         }
+
+      private:
+         void Loop()
+         {
+            for(;;)
+            {
+               std::function<void()> task, finish;
+               {
+                  std::unique_lock<std::mutex> lock( m_Mutex );
+                  m_Ready.wait( lock, [this]{ return m_Stop || m_Task; } );
+                  if( !m_Task )
+                     return;
+                  task.swap( m_Task );
+                  finish.swap( m_Finish );
+               }
+
+               task();
+               m_Pool.Release( this );
+
+               if( finish )
+                  finish();
+            }
+         }
+
+         ThreadPool&             m_Pool;
+         bool                    m_Stop;
+         std::function<void()>   m_Task;
+         std::function<void()>   m_Finish;
+         std::mutex              m_Mutex;
+         std::condition_variable m_Ready;
+         std::thread             m_Thread;
+      };
+
+      ~ThreadPool()
+      {
+         std::vector<Worker*> all;
+         {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            for( auto& w : m_All )
+               all.push_back( w.get() );
+         }
+
+         for( auto w : all )
+            w->Stop();
+      }
+
+      Worker* Acquire()
+      {
+         std::lock_guard<std::mutex> lock( m_Mutex );
+         if( m_Idle.empty() )
+         {
+            m_All.emplace_back( new Worker(*this) );
+            return m_All.back().get();
+         }
+
+         Worker* w = m_Idle.back();
+         m_Idle.pop_back();
+         return w;
+      }
+
+      void Release( Worker* w )
+      {
+         std::lock_guard<std::mutex> lock( m_Mutex );
+         m_Idle.push_back( w );
+      }
+
+   private:
+      std::mutex                            m_Mutex;
+      std::vector< std::unique_ptr<Worker> > m_All;
+      std::vector<Worker*>                  m_Idle;
+   };
+
+   ThreadPool& Pool()
+   {
+      static ThreadPool pool;
+      return pool;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// ThreadCount
+//
+//    Return the number of worker threads to use.  A requested count of zero
+//    (or less) means all of the hardware threads.
+//-----------------------------------------------------------------------------
+int ThreadCount( int requested )
+{
+   if( requested > 0 )
+      return requested;
+
+   int n = std::thread::hardware_concurrency();
+   return std::max( n, 1 );
+}
+
+//=============================================================================
+// Processor
+//
+//    The logical processor to which thread t of a loop of nthreads threads,
+//    started on the calling thread, is pinned under the policy; or -1 if it
+//    is not pinned.  Under a ProcessorShare the thread is numbered as
+//    thread first+t of total.  ncpu is the number of logical processors;
+//    zero means those of the hardware.
+//
+//    Scatter relies on the usual numbering of the logical processors
+//    socket by socket, so evenly spaced processors alternate sockets.
+//=============================================================================
+int Processor( int thread, int nthreads, AffinityPolicy affinity, int ncpu )
+{
+   if( affinity == AFFINITY_NONE )
+      return -1;
+
+   if( ncpu <= 0 )
+      ncpu = ThreadCount( 0 );
+
+   if( share_total > 0 )
+   {
+      thread  += share_first;
+      nthreads = share_total;
+   }
+
+   if( affinity == AFFINITY_SCATTER && nthreads < ncpu )
+      return int( (long long)(thread) * ncpu / nthreads );
+   else
+      return thread % ncpu;
+}
+
+//=============================================================================
+// ProcessorShare
+//
+//    Jobs that run side by side, each on its own thread of an outer loop,
+//    would otherwise each pin their thread 0 to the same processor.
+//=============================================================================
+ProcessorShare::ProcessorShare( int first, int total )
+:  m_First( share_first ),
+   m_Total( share_total )
+{
+   share_first = first;
+   share_total = total;
+}
+
+ProcessorShare::~ProcessorShare()
+{
+   share_first = m_First;
+   share_total = m_Total;
+}
+
+//=============================================================================
+// ParallelFor
+//
+//    Execute body(k, thread) for k = 0, 1, ..., n-1 using nthreads threads.
+//
+// Arguments:
+//
+//    n        number of iterations.
+//
+//    nthreads number of threads; zero means all of the hardware threads.
+//
+//    body     the loop body.  The second argument is the index of the
+//             executing thread, 0 <= thread < nthreads, which may be used
+//             to select per-thread workspace.
+//
+// Notes:
+//
+// o  The iterations are handed out one at a time from a shared counter, so
+//    iterations with very different costs are load balanced.
+//
+// o  The calling thread participates as thread 0.  The other threads come
+//    from a pool, and are reused by later calls.
+//
+// o  The iterations must be independent.
+//
+// o  Under an affinity policy each thread, including the caller, is pinned
+//    to a logical processor for the duration of the loop.  Memory first
+//    written in the body is then placed on that processor's NUMA node.
+//=============================================================================
+void ParallelFor( int n, int nthreads, const std::function<void(int k, int thread)>& body, AffinityPolicy affinity )
+{
+   nthreads = std::min( ThreadCount(nthreads), std::max(n, 1) );
+
+   std::atomic<int> next( 0 );
+   ParallelRun( nthreads, [&]( int thread )
+   {
+      for( int k = next++; k < n; k = next++ )
+         body( k, thread );
+   }, affinity );
+}
+
+//=============================================================================
+// ParallelRun
+//
+//    Execute body(thread) once on each of nthreads threads, for
+//    thread = 0, 1, ..., nthreads-1.
+//
+// Notes:
+//
+// o  Unlike ParallelFor, the work is not shared out: the body divides it
+//    by the thread index.  Two calls with the same number of threads and
+//    the same affinity policy therefore give the same part of the work to
+//    the same logical processor.  This is what placing memory by the first
+//    write needs.
+//
+// o  The calling thread participates as thread 0, and the threads are
+//    pinned as in ParallelFor, within the calling thread's ProcessorShare
+//    if it has one.
+//=============================================================================
+void ParallelRun( int nthreads, const std::function<void(int thread)>& body, AffinityPolicy affinity )
+{
+   nthreads = ThreadCount( nthreads );
+
+   // The processors are chosen here, on the calling thread, for its share.
+   std::vector<int> cpu( nthreads );
+   for( int t=0; t<nthreads; ++t )
+      cpu[t] = Processor( t, nthreads, affinity );
+
+   auto worker = [&]( int thread )
+   {
+      Affinity pin( cpu[thread] );
+      body( thread );
+   };
+
+   std::mutex mutex;
+   std::condition_variable done;
+   int running = nthreads-1;
+
+   auto finish = [&]()
+   {
+      std::lock_guard<std::mutex> lock( mutex );
+      if( --running == 0 )
+         done.notify_one();
+   };
+
+   for( int t=1; t<nthreads; ++t )
+      Pool().Acquire()->Run( [&worker, t]{ worker(t); }, finish );
+
+   worker( 0 );
+
+   std::unique_lock<std::mutex> lock( mutex );
+   done.wait( lock, [&]{ return running == 0; } );
+}
+
+//=============================================================================
+// RunAsync
+//
+//    Execute the task on a thread from the pool, and return immediately.
+//    The task must not throw; wrap it in a std::packaged_task to carry a
+//    result or an exception back to the caller.
+//=============================================================================
+void RunAsync( const std::function<void()>& task )
+{
+   Pool().Acquire()->Run( task, std::function<void()>() );
+}
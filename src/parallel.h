@@ -0,0 +1,64 @@
+//=============================================================================
+// parallel.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+//=============================================================================
+// AffinityPolicy
+//=============================================================================
+enum AffinityPolicy
+{
+   AFFINITY_NONE,                   // leave the threads to the operating system
+   AFFINITY_COMPACT,                // pin thread t to logical processor t
+   AFFINITY_SCATTER                 // pin the threads evenly spaced over the processors
+};
+
+//=============================================================================
+//
+//=============================================================================
+int ThreadCount( int requested );
+
+void ParallelFor( int n, int nthreads, const std::function<void(int k, int thread)>& body, AffinityPolicy affinity = AFFINITY_NONE );
+
+void ParallelRun( int nthreads, const std::function<void(int thread)>& body, AffinityPolicy affinity = AFFINITY_NONE );
+
+void RunAsync( const std::function<void()>& task );
+
+int Processor( int thread, int nthreads, AffinityPolicy affinity, int ncpu = 0 );
+
+//=============================================================================
+// ProcessorShare
+//
+//    While it is in scope, the loops started on the calling thread pin
+//    their threads t = 0, 1, ... as threads first+t of total, rather than
+//    of their own number of threads.  A job running on slot k of T,
+//    beside the others, then pins its thread 0 to the processor of slot k.
+//=============================================================================
+class ProcessorShare
+{
+public:
+   ProcessorShare( int first, int total );
+   ~ProcessorShare();
+
+private:
+   int m_First;
+   int m_Total;
+
+   ProcessorShare( const ProcessorShare& ) = delete;
+   ProcessorShare& operator=( const ProcessorShare& ) = delete;
+};
+
+
+//=============================================================================
+#endif  // PARALLEL_H
@@ -0,0 +1,357 @@
+//=============================================================================
+// planner.cpp
+//
+//    Estimate the work and the memory of each strategy the Engine offers,
+//    and choose the fastest one that fits in the memory limit, in the
+//    manner of a database query planner.
+//
+//    The estimates are deliberately coarse: leading-order operation counts
+//    and the large allocations.  They are meant to rank the strategies, not
+//    to predict the run time.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "planner.h"
+#include "distance.h"
+#include "fft.h"
+#include "grid.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace{
+   // Manifest constants.
+   const int    SAMPLE_ROWS     = 16;    // rows sampled for the buffer size
+   const double DISTANCE_FLOPS  = 10.0;  // per separation distance
+   const double VARIOGRAM_FLOPS = 10.0;  // per covariance entry
+   const double FFT_FLOPS       = 5.0;   // times L log2(L) per complex FFT
+   const double CG_ITERATIONS   = 4.0;   // times sqrt(M) per solve
+
+   //--------------------------------------------------------------------------
+   // SampleBuffer
+   //
+   //    The mean number of observations within the radius of an observation,
+   //    itself included, over evenly spaced sample rows.  The distances are
+   //    those the Engine would use.
+   //--------------------------------------------------------------------------
+   double SampleBuffer( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* elev, double radius, const EngineOptions& options )
+   {
+      const int N = x.size();
+      const int S = std::min( N, SAMPLE_ROWS );
+
+      std::vector<double> X, Y, Z;
+      if( options.geographic )
+         UnitVectors( x, y, X, Y, Z );
+
+      std::vector<double> d(N);
+      double total = 0.0;
+      for( int s=0; s<S; ++s )
+      {
+         const int k = int( (long long)(s) * N / S );
+
+         if( options.geographic )
+            GreatCircleDistances( X[k], Y[k], Z[k], X.data(), Y.data(), Z.data(), N, d.data() );
+         else if( elev != nullptr )
+            Distances( x[k], y[k], (*elev)[k], x.data(), y.data(), elev->data(), N, options.anisotropy, d.data() );
+         else
+            Distances( x[k], y[k], x.data(), y.data(), N, options.anisotropy, d.data() );
+
+         total += std::count_if( d.begin(), d.end(), [radius]( double dj ){ return dj <= radius; } );
+      }
+      return total / S;
+   }
+
+   //--------------------------------------------------------------------------
+   // Bytes
+   //
+   //    Format a number of bytes for people, right aligned in width.
+   //--------------------------------------------------------------------------
+   void Bytes( std::ostream& out, double bytes, int width )
+   {
+      static const char* units[] = { "B ", "KB", "MB", "GB", "TB" };
+
+      int u = 0;
+      while( bytes >= 1024.0 && u < 4 )
+      {
+         bytes /= 1024.0;
+         ++u;
+      }
+      out << std::fixed << std::setprecision(1) << std::setw(width) << bytes << ' ' << units[u];
+   }
+}
+
+//-----------------------------------------------------------------------------
+// PhysicalMemory
+//
+//    The installed memory in bytes, or 0 if it cannot be determined.
+//-----------------------------------------------------------------------------
+double PhysicalMemory()
+{
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGE_SIZE)
+   long pages = sysconf( _SC_PHYS_PAGES );
+   long size  = sysconf( _SC_PAGE_SIZE );
+   if( pages > 0 && size > 0 )
+      return double(pages) * double(size);
+   return 0.0;
+#elif defined(_WIN32)
+   MEMORYSTATUSEX status;
+   status.dwLength = sizeof(status);
+   if( GlobalMemoryStatusEx( &status ) )
+      return double( status.ullTotalPhys );
+   return 0.0;
+#else
+   return 0.0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// StrategyName
+//-----------------------------------------------------------------------------
+const char* StrategyName( Strategy strategy )
+{
+   switch( strategy )
+   {
+      case STRATEGY_DENSE:    return "dense";
+      case STRATEGY_SINGLE:   return "single";
+      case STRATEGY_GRID:     return "grid";
+   }
+   return "unknown";
+}
+
+//=============================================================================
+// MakePlan
+//
+//    Estimate each strategy for these data, and choose one.
+//
+// Arguments:
+//
+//    x, y, elev     the locations, as for the Engine (elev may be nullptr).
+//
+//    radius         the buffer radius.
+//
+//    options        the Engine options.
+//
+//    memory_limit   the memory available, in bytes; 0 means no limit.
+//
+//    automatic      if true, choose the feasible strategy with the fewest
+//                   flops, preferring double precision on a tie; if none
+//                   is feasible, the viable one with the least memory.  If
+//                   false, the strategy is the one the options select.
+//
+//    plan           the estimates and the choice.
+//
+// Notes:
+//
+// o  M = N - buffer is the typical size of a kriging system.  Each dense
+//    system costs M^3/3 for the Cholesky decomposition, plus the assembly
+//    and the solves; every thread holds one system and its factor.
+//
+// o  The grid strategy costs two conjugate gradient solves per system,
+//    each iteration an FFT and an inverse FFT over the circulant
+//    embedding.  The iteration count is taken as 4 sqrt(M), capped by the
+//    iteration limit.
+//
+// o  Simulations add a Cholesky decomposition of the full N x N
+//    covariance, which needs the distance matrix even on a grid.
+//
+// o  Duplicate observations are not removed before the estimates.
+//=============================================================================
+void MakePlan(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>* elev,
+   double radius,
+   const EngineOptions& options,
+   double memory_limit,
+   bool automatic,
+   Plan& plan )
+{
+   const double N = x.size();
+   const double R = std::max( options.simulations, 0 );
+   const double P = R + 1;
+
+   plan.N            = x.size();
+   plan.buffer       = SampleBuffer( x, y, elev, radius, options );
+   plan.threads      = std::min( ThreadCount( options.threads ), plan.N );
+   plan.memory_limit = memory_limit;
+   plan.forced       = !automatic;
+   plan.estimates.clear();
+
+   const double T = plan.threads;
+   const double M = std::max( N - plan.buffer, 0.0 );
+
+   const bool planar = ( elev == nullptr && !options.geographic );
+
+   // The simulations, if any.
+   double sim_flops = 0.0, sim_bytes = 0.0;
+   if( R > 0 )
+   {
+      sim_flops = N*N*N/3 + N*N*R + N*N*VARIOGRAM_FLOPS/2;
+      sim_bytes = 2*8*N*N + 8*N*R;
+   }
+
+   // Dense, in double and in single precision.
+   const double dense_flops = N*N*DISTANCE_FLOPS/2 + N*( N + M*M*VARIOGRAM_FLOPS/2 + M*M*M/3 + 4*M*M + 2*M*P ) + sim_flops;
+   const double work_bytes  = T*( 8*( 2*M*M + M*(P+4) ) + 4*N ) + 3*8*N*P;
+
+   StrategyEstimate dense;
+   dense.strategy = STRATEGY_DENSE;
+   dense.viable   = true;
+   dense.flops    = dense_flops;
+   dense.bytes    = 8*N*N + work_bytes + sim_bytes;
+   plan.estimates.push_back( dense );
+
+   StrategyEstimate single;
+   single.strategy = STRATEGY_SINGLE;
+   single.viable   = planar;
+   single.flops    = dense_flops;
+   single.bytes    = 4*N*N + work_bytes + sim_bytes;
+   plan.estimates.push_back( single );
+
+   // The FFT solver.
+   StrategyEstimate gridded;
+   gridded.strategy = STRATEGY_GRID;
+   gridded.viable   = false;
+   gridded.flops    = 0.0;
+   gridded.bytes    = 0.0;
+
+   RegularGrid grid;
+   if( planar && DetectRegularGrid( x, y, grid ) )
+   {
+      const double L = double( NextPowerOfTwo( 2*grid.ny - 1 ) ) * double( NextPowerOfTwo( 2*grid.nx - 1 ) );
+      const double maxit = options.cg_max_iter > 0 ? options.cg_max_iter : M;
+      const double iterations = std::min( maxit, ceil( CG_ITERATIONS*sqrt(M) ) );
+
+      gridded.viable = true;
+      gridded.flops  = L*FFT_FLOPS*log2(L) + N*( N*DISTANCE_FLOPS + 2*iterations*( 2*FFT_FLOPS*L*log2(L) + 12*N ) + 2*N*P ) + sim_flops;
+      gridded.bytes  = 16*L + 8*double(grid.ny)*(2*grid.nx-1) + 8*N + T*( 16*L + 8*8*N ) + 3*8*N*P + ( R > 0 ? 8*N*N : 0.0 ) + sim_bytes;
+   }
+   plan.estimates.push_back( gridded );
+
+   for( auto& e : plan.estimates )
+      e.feasible = e.viable && ( memory_limit <= 0 || e.bytes <= memory_limit );
+
+   // The strategy selected by the options.
+   if( !automatic )
+   {
+      Strategy s = STRATEGY_DENSE;
+      if( options.grid_mode != GRID_OFF && gridded.viable )
+         s = STRATEGY_GRID;
+      else if( options.single_precision && single.viable )
+         s = STRATEGY_SINGLE;
+      plan.chosen = int(s);
+      return;
+   }
+
+   // The fastest feasible strategy, else the smallest viable one.
+   plan.chosen = -1;
+   for( int i=0; i<int(plan.estimates.size()); ++i )
+   {
+      const StrategyEstimate& e = plan.estimates[i];
+      if( e.feasible && ( plan.chosen < 0 || e.flops < plan.estimates[plan.chosen].flops ) )
+         plan.chosen = i;
+   }
+
+   if( plan.chosen < 0 )
+   {
+      for( int i=0; i<int(plan.estimates.size()); ++i )
+      {
+         const StrategyEstimate& e = plan.estimates[i];
+         if( e.viable && ( plan.chosen < 0 || e.bytes < plan.estimates[plan.chosen].bytes ) )
+            plan.chosen = i;
+      }
+   }
+   assert( plan.chosen >= 0 );
+}
+
+//-----------------------------------------------------------------------------
+// ApplyPlan
+//
+//    Set the options for the chosen strategy.
+//-----------------------------------------------------------------------------
+void ApplyPlan( const Plan& plan, EngineOptions& options )
+{
+   if( plan.forced )
+      return;
+
+   switch( plan.estimates[plan.chosen].strategy )
+   {
+      case STRATEGY_DENSE:
+         options.grid_mode        = GRID_OFF;
+         options.single_precision = false;
+         break;
+
+      case STRATEGY_SINGLE:
+         options.grid_mode        = GRID_OFF;
+         options.single_precision = true;
+         break;
+
+      case STRATEGY_GRID:
+         options.grid_mode        = GRID_ON;
+         options.single_precision = false;
+         break;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Explain
+//
+//    Print the estimates and the choice.
+//-----------------------------------------------------------------------------
+void Explain( const Plan& plan, std::ostream& out )
+{
+   out << std::endl << "execution plan: N = " << plan.N
+       << ", mean buffer = " << std::fixed << std::setprecision(1) << plan.buffer
+       << ", " << plan.threads << " thread" << ( plan.threads == 1 ? "" : "s" )
+       << ", memory limit ";
+   if( plan.memory_limit > 0 )
+      Bytes( out, plan.memory_limit, 0 );
+   else
+      out << "none";
+   out << std::endl;
+
+   out << "   strategy         flops        memory" << std::endl;
+   for( int i=0; i<int(plan.estimates.size()); ++i )
+   {
+      const StrategyEstimate& e = plan.estimates[i];
+      out << "   " << std::left << std::setw(8) << StrategyName( e.strategy ) << std::right;
+
+      if( !e.viable )
+      {
+         out << "    not applicable" << std::endl;
+         continue;
+      }
+
+      out << std::scientific << std::setprecision(3) << std::setw(14) << e.flops << "   ";
+      Bytes( out, e.bytes, 8 );
+
+      if( i == plan.chosen )
+         out << ( plan.forced ? "   <-- selected by the options" : "   <-- chosen" );
+      else if( !e.feasible )
+         out << "   (exceeds the memory limit)";
+      out << std::endl;
+   }
+
+   if( !plan.estimates[plan.chosen].feasible )
+      std::cerr << "WARNING: the plan exceeds the memory limit." << std::endl;
+}
@@ -0,0 +1,74 @@
+//=============================================================================
+// planner.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "engine.h"
+
+//=============================================================================
+// Strategy
+//=============================================================================
+enum Strategy
+{
+   STRATEGY_DENSE,                  // per-k Cholesky, double precision distances
+   STRATEGY_SINGLE,                 // per-k Cholesky, single precision distances
+   STRATEGY_GRID                    // matrix-free FFT and conjugate gradients
+};
+
+//=============================================================================
+// StrategyEstimate
+//
+//    The estimated floating point operations and peak memory of one
+//    strategy.  A strategy is viable if it applies to the data at all, and
+//    feasible if it is viable and fits in the memory limit.
+//=============================================================================
+struct StrategyEstimate
+{
+   Strategy strategy;
+   bool     viable;
+   bool     feasible;
+   double   flops;
+   double   bytes;
+};
+
+//=============================================================================
+// Plan
+//=============================================================================
+struct Plan
+{
+   int      N;                      // number of observations
+   double   buffer;                 // mean sampled buffer size, including k
+   int      threads;                // number of worker threads
+   double   memory_limit;           // bytes; 0 --> no limit
+   bool     forced;                 // the options set the strategy
+
+   std::vector<StrategyEstimate> estimates;
+   int      chosen;                 // index into estimates
+};
+
+//=============================================================================
+double PhysicalMemory();
+
+void MakePlan( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* elev, double radius, const EngineOptions& options, double memory_limit, bool automatic, Plan& plan );
+
+void ApplyPlan( const Plan& plan, EngineOptions& options );
+
+void Explain( const Plan& plan, std::ostream& out );
+
+const char* StrategyName( Strategy strategy );
+
+
+//=============================================================================
+#endif  // PLANNER_H
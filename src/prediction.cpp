@@ -0,0 +1,252 @@
+//=============================================================================
+// prediction.cpp
+//
+//    Ordinary Kriging, with any of the variogram models, of all of the data
+//    onto a raster of target locations.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "prediction.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "distance.h"
+#include "linear_systems.h"
+#include "matrix.h"
+#include "parallel.h"
+#include "variogram_models.h"
+
+namespace{
+   const int BLOCK_SIZE = 256;      // targets per multi-RHS solve
+}
+
+//=============================================================================
+// KrigeGrid
+//
+//    Krige the value, and the kriging variance, at the center of every cell
+//    of the target grid.
+//
+// Arguments:
+//
+//    x, y, z  observation coordinates and values.
+//
+//    grid     the target raster.
+//
+//    nthreads number of threads; zero means all of the hardware threads.
+//
+//    model    the variogram model, from variogram_models.h, with a unit
+//             slope or partial sill.
+//
+//    scale    on entrance, the slope or partial sill of the variogram, or
+//             <= 0 to estimate it from the data; on exit, the one used.
+//
+//    zhat     on exit, the kriged values.
+//
+//    variance on exit, the kriging variances.
+//
+//             Both are (nrows*ncols), stored row by row, starting with the
+//             top (northernmost) row, as in an ESRI ASCII grid.
+//
+// Return:
+//
+//    true  if the kriging system was successfully factored;
+//    false if not.
+//
+// Notes:
+//
+// o  The system lambda - gamma(D) for all N observations is factored once.  The
+//    targets are then solved as blocks of right-hand sides, and the blocks
+//    are distributed over the threads.
+//
+// o  lambda is model.Lambda of the diagonal of the box containing both the
+//    data and the targets, which dominates every separation distance used.
+//
+// o  For each target, exactly as in Engine(),
+//
+//       u = B~c,  v = B~1,  beta = (1'u - 1)/(1'v),  w = u - beta v
+//
+//       zhat = w'z,  tau2 = lambda - c'w - beta
+//
+//    The variance is clipped at zero to absorb round-off at the data
+//    locations.
+//
+// o  The estimated scale is the mean squared standardized leave-one-out
+//    residual, using all of the other observations (no buffer).  It is
+//    computed from B~ without refactoring: with K the bordered Ordinary
+//    Kriging matrix [B 1; 1' 0],
+//
+//       K~(k,k)       = B~(k,k) - v(k)^2/(1'v)
+//       (K~[z;0])(k)  = (B~z)(k) - v(k)(v'z)/(1'v)
+//
+//    and the leave-one-out residual of observation k is (K~[z;0])(k)/K~(k,k)
+//    with unit-slope variance 1/K~(k,k).
+//=============================================================================
+bool KrigeGrid(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   const TargetGrid& grid,
+   int nthreads,
+   double& slope,
+   std::vector<double>& zhat,
+   std::vector<double>& variance )
+{
+   return KrigeGrid( x, y, z, grid, nthreads, LinearVariogram(), slope, zhat, variance );
+}
+
+template<class Variogram>
+bool KrigeGrid(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   const TargetGrid& grid,
+   int nthreads,
+   const Variogram& model,
+   double& scale,
+   std::vector<double>& zhat,
+   std::vector<double>& variance )
+{
+   const int N = x.size();
+   const int T = grid.ncols * grid.nrows;
+   assert( N > 1 );
+   assert( T > 0 );
+
+   // Center all of the coordinates on the data.
+   const double xm = 0.5*( *std::min_element(x.begin(), x.end()) + *std::max_element(x.begin(), x.end()) );
+   const double ym = 0.5*( *std::min_element(y.begin(), y.end()) + *std::max_element(y.begin(), y.end()) );
+
+   std::vector<double> xc(N), yc(N);
+   for( int i=0; i<N; ++i )
+   {
+      xc[i] = x[i] - xm;
+      yc[i] = y[i] - ym;
+   }
+
+   // The diagonal of the box containing both the data and the targets.
+   const double xlo = std::min( *std::min_element(xc.begin(), xc.end()), grid.xll - xm );
+   const double xhi = std::max( *std::max_element(xc.begin(), xc.end()), grid.xll + (grid.ncols-1)*grid.cellsize - xm );
+   const double ylo = std::min( *std::min_element(yc.begin(), yc.end()), grid.yll - ym );
+   const double yhi = std::max( *std::max_element(yc.begin(), yc.end()), grid.yll + (grid.nrows-1)*grid.cellsize - ym );
+   const double lambda = model.Lambda( sqrt( (xhi-xlo)*(xhi-xlo) + (yhi-ylo)*(yhi-ylo) ) );
+
+   // Setup and factor the kriging system for all of the data.
+   Matrix B(N, N);
+   for( int i=0; i<N; ++i )
+   {
+      Distances( xc[i], yc[i], xc.data(), yc.data(), N, B.Base(i,0) );
+      for( int j=0; j<N; ++j )
+         B(i,j) = lambda - model( B(i,j) );
+   }
+
+   Matrix L;
+   if( !CholeskyDecomposition(B, L) )
+      return false;
+
+   Matrix ones(N, 1, 1.0), v;
+   CholeskySolve( L, ones, v );
+   const double sv = Sum(v);
+
+   Matrix Z(N, 1, z.data());
+
+   // Estimate the scale from the leave-one-out residuals.
+   if( !( scale > 0 ) )
+   {
+      Matrix Binv, Bz;
+      RSPDInv( B, Binv );
+      CholeskySolve( L, Z, Bz );
+      const double vz = DotProduct( v, Z );
+
+      double sum = 0.0;
+      for( int k=0; k<N; ++k )
+      {
+         double Kkk = Binv(k,k) - v(k,0)*v(k,0)/sv;
+         double Kz  = Bz(k,0) - v(k,0)*vz/sv;
+         double e   = Kz/Kkk;
+         sum += e*e*Kkk;
+      }
+      scale = sum/N;
+   }
+
+   // Solve for the targets, a block at a time.
+   zhat.assign( T, 0.0 );
+   variance.assign( T, 0.0 );
+
+   const int nblocks = ( T + BLOCK_SIZE - 1 )/BLOCK_SIZE;
+   ParallelFor( nblocks, nthreads, [&]( int block, int )
+   {
+      const int t0 = block*BLOCK_SIZE;
+      const int nt = std::min( BLOCK_SIZE, T-t0 );
+
+      // The right-hand sides: C(i,t) = lambda - gamma(|target t - observation i|).
+      Matrix Ct(nt, N), C, U;
+      for( int t=0; t<nt; ++t )
+      {
+         const int r = (t0+t) / grid.ncols;
+         const int c = (t0+t) % grid.ncols;
+         const double xt = grid.xll + c*grid.cellsize - xm;
+         const double yt = grid.yll + (grid.nrows-1-r)*grid.cellsize - ym;
+
+         double* ct = Ct.Base(t,0);
+         Distances( xt, yt, xc.data(), yc.data(), N, ct );
+         for( int i=0; i<N; ++i )
+            ct[i] = lambda - model( ct[i] );
+      }
+      Transpose( Ct, C );
+
+      CholeskySolve( L, C, U );
+
+      for( int t=0; t<nt; ++t )
+      {
+         double su = 0.0;
+         for( int i=0; i<N; ++i )
+            su += U(i,t);
+
+         const double beta = ( su - 1 ) / sv;
+
+         double zt = 0.0;
+         double cw = 0.0;
+         for( int i=0; i<N; ++i )
+         {
+            double w = U(i,t) - beta*v(i,0);
+            zt += w * z[i];
+            cw += w * C(i,t);
+         }
+
+         zhat[t0+t]     = zt;
+         variance[t0+t] = scale * std::max( lambda - cw - beta, 0.0 );
+      }
+   });
+
+   return true;
+}
+
+//=============================================================================
+// Explicit instantiations for the variogram models in variogram_models.h.
+//=============================================================================
+#define INSTANTIATE_KRIGE_GRID( Variogram ) \
+   template bool KrigeGrid<Variogram>(    \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const std::vector<double>&,         \
+      const TargetGrid&,                  \
+      int,                                \
+      const Variogram&,                   \
+      double&,                            \
+      std::vector<double>&,               \
+      std::vector<double>& );
+
+INSTANTIATE_KRIGE_GRID( LinearVariogram )
+INSTANTIATE_KRIGE_GRID( PowerVariogram )
+INSTANTIATE_KRIGE_GRID( ExponentialVariogram )
+INSTANTIATE_KRIGE_GRID( SphericalVariogram )
+INSTANTIATE_KRIGE_GRID( GaussianVariogram )
+
+#undef INSTANTIATE_KRIGE_GRID
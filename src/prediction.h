@@ -0,0 +1,42 @@
+//=============================================================================
+// prediction.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef PREDICTION_H
+#define PREDICTION_H
+
+#include <vector>
+
+//=============================================================================
+// TargetGrid
+//
+//    A raster of prediction locations, defined by the center of the
+//    lower-left cell, as in an ESRI ASCII grid.
+//=============================================================================
+struct TargetGrid
+{
+   int      ncols;
+   int      nrows;
+   double   xll;                    // x-coordinate of the lower-left cell center
+   double   yll;                    // y-coordinate of the lower-left cell center
+   double   cellsize;
+};
+
+//=============================================================================
+// Prediction with the LinearVariogram, or with any of the models in
+// variogram_models.h (instantiated in prediction.cpp).
+bool KrigeGrid( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, const TargetGrid& grid, int nthreads, double& slope, std::vector<double>& zhat, std::vector<double>& variance );
+
+template<class Variogram>
+bool KrigeGrid( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, const TargetGrid& grid, int nthreads, const Variogram& model, double& scale, std::vector<double>& zhat, std::vector<double>& variance );
+
+
+//=============================================================================
+#endif  // PREDICTION_H
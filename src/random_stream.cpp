@@ -0,0 +1,132 @@
+//=============================================================================
+// random_stream.cpp
+//
+//    A block-oriented pseudo-random number generator.
+//
+// references:
+// o  Blackman, D., and Vigna, S., 2021, Scrambled linear pseudorandom number
+//    generators, ACM Transactions on Mathematical Software, v. 47, no. 4,
+//    pp. 1-32.
+//
+// o  Box, G.E.P., and Muller, M.E., 1958, A note on the generation of random
+//    normal deviates, The Annals of Mathematical Statistics, v. 29, no. 2,
+//    pp. 610-611.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "random_stream.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "numerical_constants.h"
+
+namespace{
+   //--------------------------------------------------------------------------
+   // SplitMix64
+   //
+   //    Used only to expand the user's seed into the generator state.
+   //--------------------------------------------------------------------------
+   uint64_t SplitMix64( uint64_t& x )
+   {
+      uint64_t z = ( x += 0x9e3779b97f4a7c15ULL );
+      z = ( z ^ (z >> 30) ) * 0xbf58476d1ce4e5b9ULL;
+      z = ( z ^ (z >> 27) ) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+   }
+
+   inline uint64_t Rotl( uint64_t x, int k )
+   {
+      return ( x << k ) | ( x >> (64 - k) );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Constructor.
+//
+//    Streams with different seeds are, for all practical purposes,
+//    independent.
+//-----------------------------------------------------------------------------
+RandomStream::RandomStream( uint64_t seed )
+{
+   for( int j=0; j<LANES; ++j )
+   {
+      m_s0[j] = SplitMix64( seed );
+      m_s1[j] = SplitMix64( seed );
+      m_s2[j] = SplitMix64( seed );
+      m_s3[j] = SplitMix64( seed );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Uniform
+//
+//    Fill u[0..n-1] with uniform deviates on the open interval (0,1).
+//-----------------------------------------------------------------------------
+void RandomStream::Uniform( double* u, int n )
+{
+   assert( n >= 0 );
+
+   const double SCALE = 1.0 / 9007199254740992.0;     // 2^-53
+
+   uint64_t r[LANES];
+   for( int i=0; i<n; i += LANES )
+   {
+      // The xoshiro256+ step, for all of the lanes at once.
+      for( int j=0; j<LANES; ++j )
+      {
+         r[j] = m_s0[j] + m_s3[j];
+
+         uint64_t t = m_s1[j] << 17;
+         m_s2[j] ^= m_s0[j];
+         m_s3[j] ^= m_s1[j];
+         m_s1[j] ^= m_s2[j];
+         m_s0[j] ^= m_s3[j];
+         m_s2[j] ^= t;
+         m_s3[j]  = Rotl( m_s3[j], 45 );
+      }
+
+      // The upper 53 bits, offset by half a unit to exclude 0.
+      int m = ( n-i < LANES ) ? n-i : LANES;
+      for( int j=0; j<m; ++j )
+         u[i+j] = ( double(r[j] >> 11) + 0.5 ) * SCALE;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Gaussian
+//
+//    Fill g[0..n-1] with standard normal deviates using the Box-Muller
+//    transformation.
+//-----------------------------------------------------------------------------
+void RandomStream::Gaussian( double* g, int n )
+{
+   assert( n >= 0 );
+
+   const int BLOCK = 256;
+   double u[BLOCK];
+
+   for( int i=0; i<n; i += BLOCK )
+   {
+      int m = ( n-i < BLOCK ) ? n-i : BLOCK;
+      int h = ( m+1 )/2;
+
+      Uniform( u, 2*h );
+
+      for( int j=0; j<h; ++j )
+      {
+         double r = sqrt( -2.0*log(u[j]) );
+         double t = TWO_PI*u[h+j];
+
+         g[i+j] = r*cos(t);
+         if( h+j < m )
+            g[i+h+j] = r*sin(t);
+      }
+   }
+}
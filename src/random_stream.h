@@ -0,0 +1,43 @@
+//=============================================================================
+// random_stream.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <cstdint>
+
+//=============================================================================
+// RandomStream
+//
+//    A fast pseudo-random number generator that fills whole blocks at a
+//    time.  Four independent xoshiro256+ generators are interleaved so the
+//    inner loops vectorize.
+//=============================================================================
+class RandomStream
+{
+public:
+   explicit RandomStream( uint64_t seed );
+
+   void Uniform( double* u, int n );      // uniform on (0,1)
+   void Gaussian( double* g, int n );     // standard normal
+
+private:
+   static const int LANES = 4;
+
+   uint64_t m_s0[LANES];
+   uint64_t m_s1[LANES];
+   uint64_t m_s2[LANES];
+   uint64_t m_s3[LANES];
+};
+
+
+//=============================================================================
+#endif  // RANDOM_STREAM_H
@@ -0,0 +1,194 @@
+//=============================================================================
+// shard.cpp
+//
+//    The spatially balanced assignment of the locations to the shards of a
+//    job split over several processes.
+//
+//    The cost of a kriging system depends upon the number of observations
+//    outside of the buffer, which varies with the local density.  Giving
+//    each shard a contiguous region would leave one shard with the dense
+//    clusters.  Instead, the locations are put in Morton (Z-curve) order,
+//    and dealt out in turn, so each shard samples every part of the region.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "shard.h"
+
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <numeric>
+#include <sstream>
+
+namespace{
+   // Manifest constants.
+   const int    MORTON_BITS  = 16;                         // per coordinate
+   const double MORTON_CELLS = double( (1u << MORTON_BITS) - 1 );
+
+   //--------------------------------------------------------------------------
+   // Spread
+   //
+   //    Put the 16 bits of v in the even bit positions.
+   //--------------------------------------------------------------------------
+   uint32_t Spread( uint32_t v )
+   {
+      v = ( v | (v << 8) ) & 0x00FF00FFu;
+      v = ( v | (v << 4) ) & 0x0F0F0F0Fu;
+      v = ( v | (v << 2) ) & 0x33333333u;
+      v = ( v | (v << 1) ) & 0x55555555u;
+      return v;
+   }
+
+   //--------------------------------------------------------------------------
+   // Quantize
+   //
+   //    The cell of v in [vmin, vmax], 0..2^16-1.
+   //--------------------------------------------------------------------------
+   uint32_t Quantize( double v, double vmin, double vmax )
+   {
+      if( vmax <= vmin )
+         return 0;
+      return uint32_t( (v - vmin) / (vmax - vmin) * MORTON_CELLS + 0.5 );
+   }
+}
+
+//-----------------------------------------------------------------------------
+// AssignShards
+//
+// notes:
+// o  Ties in the Morton key are broken by the index, so the order, and
+//    hence the assignment, is fully determined by the input.
+//-----------------------------------------------------------------------------
+void AssignShards(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   int nshards,
+   std::vector<int>& shard )
+{
+   assert( nshards >= 1 );
+   assert( y.size() == x.size() );
+
+   const int N = x.size();
+   shard.assign( N, 0 );
+   if( N == 0 || nshards == 1 )
+      return;
+
+   const auto xr = std::minmax_element( x.begin(), x.end() );
+   const auto yr = std::minmax_element( y.begin(), y.end() );
+
+   std::vector<uint32_t> key(N);
+   for( int i=0; i<N; ++i )
+   {
+      key[i] = Spread( Quantize( x[i], *xr.first, *xr.second ) ) |
+               Spread( Quantize( y[i], *yr.first, *yr.second ) ) << 1;
+   }
+
+   std::vector<int> order(N);
+   std::iota( order.begin(), order.end(), 0 );
+   std::sort( order.begin(), order.end(), [&key]( int a, int b )
+   {
+      return key[a] < key[b] || ( key[a] == key[b] && a < b );
+   });
+
+   for( int r=0; r<N; ++r )
+      shard[ order[r] ] = r % nshards;
+}
+
+//=============================================================================
+// DataHash
+//
+//    The hash of the observation data, as read from the data file.
+//=============================================================================
+uint64_t DataHash(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z )
+{
+   uint64_t hash = HashBytes( x );
+   hash = HashBytes( y, hash );
+   hash = HashBytes( elev, hash );
+   return HashBytes( z, hash );
+}
+
+//=============================================================================
+// RunKey
+//
+//    The hash of a run: the data hash, and everything else that changes
+//    the estimates or the xi; the radius, the variogram model (its type
+//    and parameters), the anisotropy, the duplicate policy and tolerance,
+//    and the geometry and solver settings.  The shard, the threads, and
+//    the other settings that only change where or how fast the work is
+//    done are left out, so every shard of a run has the same key.
+//=============================================================================
+uint64_t RunKey(
+   uint64_t data,
+   double radius,
+   const EngineOptions& options,
+   int model,
+   double range,
+   double exponent,
+   double nugget )
+{
+   const double settings[] = {
+      radius,
+      double( model ),
+      range,
+      exponent,
+      nugget,
+      options.anisotropy.angle,
+      options.anisotropy.ratio,
+      options.anisotropy.vertical,
+      double( options.duplicates ),
+      options.duplicate_tolerance,
+      double( options.geographic ),
+      double( options.grid_mode ),
+      double( options.single_precision ),
+      options.cg_tolerance,
+      double( options.cg_max_iter )
+   };
+   return HashBytes( settings, sizeof(settings), data );
+}
+
+//=============================================================================
+// WriteShardHeader
+//=============================================================================
+void WriteShardHeader( std::ostream& os, const ShardHeader& header )
+{
+   os << "AAKOZI-SHARD " << header.shard << ' ' << header.nshards << ' ' << header.N << ' '
+      << std::hex << header.data << ' ' << header.key << std::dec << ' '
+      << std::scientific << std::setprecision(17) << header.sums.sum << ' ' << header.sums.count << std::endl;
+}
+
+//=============================================================================
+// ReadShardHeader
+//
+//    Return false if the line is not a shard header.
+//=============================================================================
+bool ReadShardHeader( const std::string& line, ShardHeader& header )
+{
+   std::istringstream is( line );
+   std::string tag;
+   is >> tag >> header.shard >> header.nshards >> header.N >> std::hex >> header.data >> header.key >> std::dec >> header.sums.sum >> header.sums.count;
+   return !is.fail() && tag == "AAKOZI-SHARD" && header.nshards > 0 && header.shard >= 1 && header.shard <= header.nshards;
+}
+
+//=============================================================================
+// SameRun
+//
+//    True if the two shards come from the same run, of the same data.
+//=============================================================================
+bool SameRun( const ShardHeader& a, const ShardHeader& b )
+{
+   return a.nshards == b.nshards && a.N == b.N && a.data == b.data && a.key == b.key;
+}
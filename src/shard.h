@@ -0,0 +1,79 @@
+//=============================================================================
+// shard.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+//=============================================================================
+// AssignShards
+//
+//    Deal the locations out to nshards shards, so that each shard gets an
+//    even share spread over the whole region.  shard[i] is the shard, in
+//    0..nshards-1, of location i.  The assignment depends only upon the
+//    coordinates, so every process computes the same one.
+//=============================================================================
+void AssignShards(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   int nshards,
+   std::vector<int>& shard );
+
+
+//=============================================================================
+// ShardHeader
+//
+//    The first line of a shard file,
+//
+//       AAKOZI-SHARD <i> <n> <N> <data> <key> <sum of Xi^2> <count>
+//
+//    for shard i of n, with N data.  data is the DataHash of the
+//    observations as read, and key the RunKey of the run; both are in
+//    hexadecimal.  Only the shards of one run may be merged.
+//=============================================================================
+struct ShardHeader
+{
+   int      shard   = 1;       // 1, ..., nshards
+   int      nshards = 1;
+   int      N       = 0;
+   uint64_t data    = 0;
+   uint64_t key     = 0;
+   XiSums   sums;
+};
+
+uint64_t DataHash(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& elev,
+   const std::vector<double>& z );
+
+uint64_t RunKey(
+   uint64_t data,
+   double radius,
+   const EngineOptions& options,
+   int model,
+   double range,
+   double exponent,
+   double nugget );
+
+void WriteShardHeader( std::ostream& os, const ShardHeader& header );
+bool ReadShardHeader( const std::string& line, ShardHeader& header );
+bool SameRun( const ShardHeader& a, const ShardHeader& b );
+
+
+//=============================================================================
+#endif  // SHARD_H
@@ -0,0 +1,264 @@
+//=============================================================================
+// spatial_index.cpp
+//
+//    A uniform bucket grid for fixed-radius neighbor searches.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace{
+   const int MAXIMUM_CELLS_PER_POINT = 4;
+}
+
+//-----------------------------------------------------------------------------
+// Constructors.
+//-----------------------------------------------------------------------------
+SpatialIndex::SpatialIndex( const std::vector<double>& x, const std::vector<double>& y, double cellsize )
+:  m_nx( 1 ),
+   m_ny( 1 ),
+   m_nz( 1 ),
+   m_x0( 0.0 ),
+   m_y0( 0.0 ),
+   m_z0( 0.0 ),
+   m_cellsize( cellsize ),
+   m_start(),
+   m_order(),
+   m_x(),
+   m_y(),
+   m_z()
+{
+   Build( x, y, nullptr );
+}
+
+//-----------------------------------------------------------------------------
+SpatialIndex::SpatialIndex( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double cellsize )
+:  m_nx( 1 ),
+   m_ny( 1 ),
+   m_nz( 1 ),
+   m_x0( 0.0 ),
+   m_y0( 0.0 ),
+   m_z0( 0.0 ),
+   m_cellsize( cellsize ),
+   m_start(),
+   m_order(),
+   m_x(),
+   m_y(),
+   m_z()
+{
+   assert( z.size() == x.size() );
+   Build( x, y, &z );
+}
+
+//-----------------------------------------------------------------------------
+// Build
+//
+//    The cells are squares (cubes) of the given size.  If that would give
+//    many more cells than observations, the cells are enlarged.  The
+//    observations are counting sorted into cell order.
+//-----------------------------------------------------------------------------
+void SpatialIndex::Build( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* z )
+{
+   assert( x.size() == y.size() );
+   assert( m_cellsize > 0 );
+   const int N = x.size();
+
+   if( N == 0 )
+   {
+      m_start.assign( 2, 0 );
+      return;
+   }
+
+   // Size the grid.
+   m_x0 = *std::min_element( x.begin(), x.end() );
+   m_y0 = *std::min_element( y.begin(), y.end() );
+   const double Lx = *std::max_element( x.begin(), x.end() ) - m_x0;
+   const double Ly = *std::max_element( y.begin(), y.end() ) - m_y0;
+
+   double Lz = 0.0;
+   if( z != nullptr )
+   {
+      m_z0 = *std::min_element( z->begin(), z->end() );
+      Lz   = *std::max_element( z->begin(), z->end() ) - m_z0;
+   }
+
+   const double maxcells = double(MAXIMUM_CELLS_PER_POINT) * N;
+   while( (floor(Lx/m_cellsize)+1) * (floor(Ly/m_cellsize)+1) * (floor(Lz/m_cellsize)+1) > maxcells )
+      m_cellsize *= 2;
+
+   m_nx = int( floor(Lx/m_cellsize) ) + 1;
+   m_ny = int( floor(Ly/m_cellsize) ) + 1;
+   m_nz = int( floor(Lz/m_cellsize) ) + 1;
+
+   // Counting sort of the observations into cell order.
+   std::vector<int> cell( N );
+   m_start.assign( m_nx*m_ny*m_nz + 1, 0 );
+   for( int i=0; i<N; ++i )
+   {
+      int layer = ( z != nullptr ) ? Layer( (*z)[i] ) : 0;
+      cell[i] = ( layer*m_ny + Row(y[i]) )*m_nx + Column(x[i]);
+      ++m_start[ cell[i]+1 ];
+   }
+
+   for( int c=0; c<m_nx*m_ny*m_nz; ++c )
+      m_start[c+1] += m_start[c];
+
+   std::vector<int> next( m_start.begin(), m_start.end()-1 );
+   m_order.resize( N );
+   m_x.resize( N );
+   m_y.resize( N );
+   if( z != nullptr )
+      m_z.resize( N );
+   for( int i=0; i<N; ++i )
+   {
+      int p = next[ cell[i] ]++;
+      m_order[p] = i;
+      m_x[p] = x[i];
+      m_y[p] = y[i];
+      if( z != nullptr )
+         m_z[p] = (*z)[i];
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Number of observations.
+//-----------------------------------------------------------------------------
+int SpatialIndex::size() const
+{
+   return m_order.size();
+}
+
+//-----------------------------------------------------------------------------
+// Original index of the observation at position p.
+//-----------------------------------------------------------------------------
+int SpatialIndex::Original( int p ) const
+{
+   return m_order[p];
+}
+
+//-----------------------------------------------------------------------------
+// Read only access to the x-coordinates in cell order.
+//-----------------------------------------------------------------------------
+const double* SpatialIndex::X() const
+{
+   return m_x.data();
+}
+
+//-----------------------------------------------------------------------------
+// Read only access to the y-coordinates in cell order.
+//-----------------------------------------------------------------------------
+const double* SpatialIndex::Y() const
+{
+   return m_y.data();
+}
+
+//-----------------------------------------------------------------------------
+// Read only access to the z-coordinates in cell order; 3-D only.
+//-----------------------------------------------------------------------------
+const double* SpatialIndex::Z() const
+{
+   return m_z.data();
+}
+
+//-----------------------------------------------------------------------------
+// Query
+//
+//    On exit, runs holds the pairs begin0, end0, begin1, end1, ... of the
+//    positions in the cells that intersect the square [x0-r, x0+r] x
+//    [y0-r, y0+r].  There is one run per row of cells.  The caller must
+//    still test the actual distances.
+//-----------------------------------------------------------------------------
+void SpatialIndex::Query( double x0, double y0, double r, std::vector<int>& runs ) const
+{
+   runs.clear();
+   if( m_order.empty() )
+      return;
+
+   const int c0 = Column( x0-r );
+   const int c1 = Column( x0+r );
+   const int r0 = Row( y0-r );
+   const int r1 = Row( y0+r );
+
+   for( int row=r0; row<=r1; ++row )
+   {
+      int begin = m_start[ row*m_nx + c0 ];
+      int end   = m_start[ row*m_nx + c1 + 1 ];
+      if( begin < end )
+      {
+         runs.push_back( begin );
+         runs.push_back( end );
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+// Query
+//
+//    The 3-D version: one run per row of cells in each layer that
+//    intersects the cube [x0-r, x0+r] x [y0-r, y0+r] x [z0-r, z0+r].
+//-----------------------------------------------------------------------------
+void SpatialIndex::Query( double x0, double y0, double z0, double r, std::vector<int>& runs ) const
+{
+   runs.clear();
+   if( m_order.empty() )
+      return;
+
+   const int c0 = Column( x0-r );
+   const int c1 = Column( x0+r );
+   const int r0 = Row( y0-r );
+   const int r1 = Row( y0+r );
+   const int l0 = Layer( z0-r );
+   const int l1 = Layer( z0+r );
+
+   for( int layer=l0; layer<=l1; ++layer )
+   {
+      for( int row=r0; row<=r1; ++row )
+      {
+         int base  = ( layer*m_ny + row )*m_nx;
+         int begin = m_start[ base + c0 ];
+         int end   = m_start[ base + c1 + 1 ];
+         if( begin < end )
+         {
+            runs.push_back( begin );
+            runs.push_back( end );
+         }
+      }
+   }
+}
+
+//-----------------------------------------------------------------------------
+// The cell column containing the x-coordinate, clamped to the grid.
+//-----------------------------------------------------------------------------
+int SpatialIndex::Column( double x ) const
+{
+   double t = floor( (x - m_x0)/m_cellsize );
+   return int( std::min( std::max( t, 0.0 ), double(m_nx-1) ) );
+}
+
+//-----------------------------------------------------------------------------
+// The cell row containing the y-coordinate, clamped to the grid.
+//-----------------------------------------------------------------------------
+int SpatialIndex::Row( double y ) const
+{
+   double t = floor( (y - m_y0)/m_cellsize );
+   return int( std::min( std::max( t, 0.0 ), double(m_ny-1) ) );
+}
+
+//-----------------------------------------------------------------------------
+// The cell layer containing the z-coordinate, clamped to the grid.
+//-----------------------------------------------------------------------------
+int SpatialIndex::Layer( double z ) const
+{
+   double t = floor( (z - m_z0)/m_cellsize );
+   return int( std::min( std::max( t, 0.0 ), double(m_nz-1) ) );
+}
@@ -0,0 +1,69 @@
+//=============================================================================
+// spatial_index.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <vector>
+
+//=============================================================================
+// SpatialIndex
+//
+//    A uniform bucket grid over the observations.  The observations are
+//    stored in cell order, so the observations in a cell, and in a run of
+//    adjacent cells in the same row, are contiguous in memory.
+//
+//    For 3-D observations the cells are cubes, stacked in layers; a 2-D
+//    index is a single layer.
+//=============================================================================
+class SpatialIndex
+{
+public:
+   SpatialIndex( const std::vector<double>& x, const std::vector<double>& y, double cellsize );
+   SpatialIndex( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, double cellsize );
+
+   // The observations in cell order.
+   int size() const;                                  // number of observations
+   int Original( int p ) const;                       // original index of position p
+   const double* X() const;                           // x in cell order
+   const double* Y() const;                           // y in cell order
+   const double* Z() const;                           // z in cell order (3-D only)
+
+   // All positions whose cells intersect the square (cube) of half-width r
+   // centered at (x0,y0) or (x0,y0,z0), as a list of [begin,end) runs.
+   void Query( double x0, double y0, double r, std::vector<int>& runs ) const;
+   void Query( double x0, double y0, double z0, double r, std::vector<int>& runs ) const;
+
+private:
+   int                 m_nx;                          // number of cell columns
+   int                 m_ny;                          // number of cell rows
+   int                 m_nz;                          // number of cell layers
+   double              m_x0;                          // lower-left(-bottom) corner
+   double              m_y0;
+   double              m_z0;
+   double              m_cellsize;
+
+   std::vector<int>    m_start;                       // first position of each cell
+   std::vector<int>    m_order;                       // original index of each position
+   std::vector<double> m_x;                           // coordinates in cell order
+   std::vector<double> m_y;
+   std::vector<double> m_z;
+
+   void Build( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>* z );
+
+   int Column( double x ) const;
+   int Row( double y ) const;
+   int Layer( double z ) const;
+};
+
+
+//=============================================================================
+#endif  // SPATIAL_INDEX_H
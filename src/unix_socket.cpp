@@ -0,0 +1,256 @@
+//=============================================================================
+// unix_socket.cpp
+//
+//    A line-oriented server on a Unix domain socket.
+//
+// notes:
+// o  Unix domain sockets are used on the POSIX systems.  Elsewhere
+//    ServeUnixSocket reports failure.
+//
+// o  The listening loop, and a connection waiting for input, poll the
+//    socket with a short timeout, so that they notice the stop flag.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "unix_socket.h"
+#include "parallel.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define UNIX_SOCKET_POSIX
+#endif
+
+namespace{
+   // Manifest constants.
+   const int POLL_MILLISECONDS = 250;
+   const int BACKLOG           = 64;
+   const int CHUNK             = 4096;
+
+   //--------------------------------------------------------------------------
+   // Handlers
+   //
+   //    The count of the handlers still running.
+   //--------------------------------------------------------------------------
+   struct Handlers
+   {
+      std::mutex              mutex;
+      std::condition_variable idle;
+      int                     running = 0;
+   };
+}
+
+//=============================================================================
+// Connection
+//=============================================================================
+Connection::Connection( int socket, const std::atomic<bool>& stop )
+:  m_Socket( socket ),
+   m_Stop( stop ),
+   m_Buffer()
+{
+}
+
+Connection::~Connection()
+{
+#ifdef UNIX_SOCKET_POSIX
+   close( m_Socket );
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// ReadLine
+//
+//    A last line without an end of line is returned as a line.
+//-----------------------------------------------------------------------------
+bool Connection::ReadLine( std::string& line )
+{
+#ifdef UNIX_SOCKET_POSIX
+   size_t end;
+   while( ( end = m_Buffer.find('\n') ) == std::string::npos )
+   {
+      if( m_Stop )
+         return false;
+
+      pollfd ready;
+      ready.fd      = m_Socket;
+      ready.events  = POLLIN;
+      ready.revents = 0;
+      int events = poll( &ready, 1, POLL_MILLISECONDS );
+      if( events == 0 || ( events < 0 && errno == EINTR ) )
+         continue;
+
+      char chunk[CHUNK];
+      ssize_t n = recv( m_Socket, chunk, sizeof(chunk), 0 );
+      if( n < 0 && errno == EINTR )
+         continue;
+
+      if( n <= 0 )
+      {
+         if( m_Buffer.empty() )
+            return false;
+         line.swap( m_Buffer );
+         m_Buffer.clear();
+         return true;
+      }
+      m_Buffer.append( chunk, size_t(n) );
+   }
+
+   line.assign( m_Buffer, 0, end );
+   m_Buffer.erase( 0, end+1 );
+   if( !line.empty() && line.back() == '\r' )
+      line.pop_back();
+   return true;
+#else
+   (void) line;
+   return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Write
+//-----------------------------------------------------------------------------
+bool Connection::Write( const std::string& text )
+{
+#ifdef UNIX_SOCKET_POSIX
+   size_t sent = 0;
+   while( sent < text.size() )
+   {
+#ifdef MSG_NOSIGNAL
+      ssize_t n = send( m_Socket, text.data() + sent, text.size() - sent, MSG_NOSIGNAL );
+#else
+      ssize_t n = send( m_Socket, text.data() + sent, text.size() - sent, 0 );
+#endif
+      if( n < 0 && errno == EINTR )
+         continue;
+      if( n <= 0 )
+         return false;
+      sent += size_t(n);
+   }
+   return true;
+#else
+   (void) text;
+   return false;
+#endif
+}
+
+//=============================================================================
+// ServeUnixSocket
+//=============================================================================
+bool ServeUnixSocket( const std::string& path, const std::function<void(Connection&)>& handler, const std::atomic<bool>& stop )
+{
+#ifdef UNIX_SOCKET_POSIX
+   sockaddr_un address;
+   memset( &address, 0, sizeof(address) );
+   address.sun_family = AF_UNIX;
+   if( path.size() >= sizeof(address.sun_path) )
+   {
+      std::cerr << "ERROR: the socket path <" << path << "> is too long." << std::endl;
+      return false;
+   }
+   strncpy( address.sun_path, path.c_str(), sizeof(address.sun_path) - 1 );
+
+   // A peer that goes away must not kill the server.
+#ifndef MSG_NOSIGNAL
+   signal( SIGPIPE, SIG_IGN );
+#endif
+
+   // Replace a socket left behind by a server that died, but no other
+   // file, and not the socket of a server that is still listening.
+   struct stat info;
+   if( lstat( path.c_str(), &info ) == 0 && S_ISSOCK( info.st_mode ) )
+   {
+      int probe = socket( AF_UNIX, SOCK_STREAM, 0 );
+      if( probe < 0 )
+         return false;
+
+      int error = 0;
+      if( connect( probe, reinterpret_cast<sockaddr*>(&address), sizeof(address) ) != 0 )
+         error = errno;
+      close( probe );
+
+      if( error == ECONNREFUSED )
+         unlink( path.c_str() );
+      else
+      {
+         if( error == 0 )
+            std::cerr << "ERROR: a server is already serving <" << path << ">." << std::endl;
+         else
+            std::cerr << "ERROR: could not check the socket <" << path << ">: " << strerror(error) << std::endl;
+         return false;
+      }
+   }
+
+   int listener = socket( AF_UNIX, SOCK_STREAM, 0 );
+   if( listener < 0 )
+      return false;
+
+   if( bind( listener, reinterpret_cast<sockaddr*>(&address), sizeof(address) ) != 0 || listen( listener, BACKLOG ) != 0 )
+   {
+      std::cerr << "ERROR: could not listen on <" << path << ">: " << strerror(errno) << std::endl;
+      close( listener );
+      return false;
+   }
+
+   auto handlers = std::make_shared<Handlers>();
+
+   while( !stop )
+   {
+      pollfd ready;
+      ready.fd      = listener;
+      ready.events  = POLLIN;
+      ready.revents = 0;
+      if( poll( &ready, 1, POLL_MILLISECONDS ) <= 0 )
+         continue;
+
+      int peer = accept( listener, nullptr, nullptr );
+      if( peer < 0 )
+         continue;
+
+      {
+         std::lock_guard<std::mutex> lock( handlers->mutex );
+         ++handlers->running;
+      }
+
+      RunAsync( [peer, handler, handlers, &stop]()
+      {
+         {
+            Connection connection( peer, stop );
+            handler( connection );
+         }
+
+         std::lock_guard<std::mutex> lock( handlers->mutex );
+         --handlers->running;
+         handlers->idle.notify_all();
+      });
+   }
+
+   close( listener );
+   unlink( path.c_str() );
+
+   std::unique_lock<std::mutex> lock( handlers->mutex );
+   handlers->idle.wait( lock, [&handlers]{ return handlers->running == 0; } );
+   return true;
+#else
+   (void) handler;
+   (void) stop;
+   std::cerr << "ERROR: Unix domain sockets are not available; cannot serve <" << path << ">." << std::endl;
+   return false;
+#endif
+}
@@ -0,0 +1,62 @@
+//=============================================================================
+// unix_socket.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef UNIX_SOCKET_H
+#define UNIX_SOCKET_H
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+//=============================================================================
+// Connection
+//
+//    One end of a connected stream socket, read and written a line at a
+//    time.  The socket is closed by the destructor.  Once the server is
+//    stopped, ReadLine returns false instead of waiting for more input.
+//=============================================================================
+class Connection
+{
+public:
+   Connection( int socket, const std::atomic<bool>& stop );
+   ~Connection();
+
+   // The next line, without its end of line.  Return false at the end of
+   // the stream, on an error, or once the server is stopped.
+   bool ReadLine( std::string& line );
+
+   // Return false if the peer has gone away.
+   bool Write( const std::string& text );
+
+private:
+   int                      m_Socket;
+   const std::atomic<bool>& m_Stop;
+   std::string              m_Buffer;   // read but not yet returned
+
+   Connection( const Connection& ) = delete;
+   Connection& operator=( const Connection& ) = delete;
+};
+
+//=============================================================================
+// ServeUnixSocket
+//
+//    Listen on the Unix domain socket at path, and hand each connection to
+//    the handler on a pooled thread, until stop is set.  Then wait for the
+//    handlers to return.  A stale socket file left at path, one that
+//    refuses connections, is replaced, and the file is removed on return.
+//    Return false if another server is listening at path, if the socket
+//    could not be set up, or if Unix domain sockets are not available.
+//=============================================================================
+bool ServeUnixSocket( const std::string& path, const std::function<void(Connection&)>& handler, const std::atomic<bool>& stop );
+
+
+//=============================================================================
+#endif  // UNIX_SOCKET_H
@@ -0,0 +1,215 @@
+//=============================================================================
+// variogram.cpp
+//
+//    Compute the isotropic empirical (experimental) variogram of the
+//    observations by binning all pairs by their separation distance.
+//
+// references:
+// o  Cressie, N.A.C., 1993, STATISTICS FOR SPATIAL DATA, Revised Edition,
+//    John Wiley and Sons, New York, 900 pp.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "variogram.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "distance.h"
+#include "parallel.h"
+#include "spatial_index.h"
+
+namespace{
+   //--------------------------------------------------------------------------
+   // Histogram
+   //
+   //    The running sums for each bin; one per thread, so the threads never
+   //    write to shared memory.
+   //--------------------------------------------------------------------------
+   struct Histogram
+   {
+      std::vector<double>     lag;
+      std::vector<double>     gamma;
+      std::vector<long long>  count;
+      std::vector<double>     d;        // distance workspace
+      std::vector<int>        runs;     // spatial index query workspace
+
+      explicit Histogram( int nbins )
+      :  lag( nbins, 0.0 ),
+         gamma( nbins, 0.0 ),
+         count( nbins, 0 ),
+         d(),
+         runs()
+      {
+      }
+
+      //-----------------------------------------------------------------------
+      // Accumulate the pairs between observation (x0,y0,z0) and the n
+      // observations starting at x, y, z.
+      //-----------------------------------------------------------------------
+      void Add( double x0, double y0, double z0, const double* x, const double* y, const double* z, int n, double maxlag, double width )
+      {
+         const int nbins = lag.size();
+
+         if( int(d.size()) < n )
+            d.resize( n );
+         Distances( x0, y0, x, y, n, d.data() );
+
+         for( int j=0; j<n; ++j )
+         {
+            if( d[j] > maxlag )
+               continue;
+
+            int b = std::min( int(d[j]/width), nbins-1 );
+            double dz = z[j] - z0;
+
+            lag[b]   += d[j];
+            gamma[b] += 0.5*dz*dz;
+            ++count[b];
+         }
+      }
+   };
+}
+
+//=============================================================================
+// EmpiricalVariogram
+//
+//    Compute the empirical variogram of the observations.
+//
+// Arguments:
+//
+//    x, y     observation coordinates.
+//
+//    z        observation values.
+//
+//    nbins    number of equal-width distance bins.
+//
+//    maxlag   the largest separation distance considered.  If maxlag <= 0,
+//             all pairs are used and the bins span the diagonal of the
+//             bounding box of the observations.
+//
+//    nthreads number of threads; zero means all of the hardware threads.
+//
+// Return:
+//
+//    The nbins bins.  The lag of an empty bin is its midpoint, and its
+//    gamma is NAN.
+//
+// Notes:
+//
+// o  The coordinates are centered before the distances are computed.
+//
+// o  With a positive maxlag, only the pairs found through a bucket grid
+//    with cells of size maxlag are examined, so the work is proportional
+//    to the number of pairs within maxlag rather than N^2/2.
+//
+// o  Each thread accumulates its own histogram; the histograms are summed
+//    at the end.
+//=============================================================================
+std::vector<VariogramBin> EmpiricalVariogram(
+   const std::vector<double>& x,
+   const std::vector<double>& y,
+   const std::vector<double>& z,
+   int nbins,
+   double maxlag,
+   int nthreads )
+{
+   assert( x.size() == y.size() && x.size() == z.size() );
+   assert( nbins > 0 );
+   const int N = x.size();
+
+   // Center the coordinates.
+   std::vector<double> xc( x ), yc( y );
+   if( N > 0 )
+   {
+      const double xm = 0.5*( *std::min_element(x.begin(), x.end()) + *std::max_element(x.begin(), x.end()) );
+      const double ym = 0.5*( *std::min_element(y.begin(), y.end()) + *std::max_element(y.begin(), y.end()) );
+      for( int i=0; i<N; ++i )
+      {
+         xc[i] -= xm;
+         yc[i] -= ym;
+      }
+   }
+
+   const bool allpairs = !( maxlag > 0 );
+   if( allpairs )
+   {
+      maxlag = 0.0;
+      if( N > 0 )
+      {
+         const double Lx = *std::max_element(xc.begin(), xc.end()) - *std::min_element(xc.begin(), xc.end());
+         const double Ly = *std::max_element(yc.begin(), yc.end()) - *std::min_element(yc.begin(), yc.end());
+         maxlag = sqrt( Lx*Lx + Ly*Ly );
+      }
+      if( maxlag <= 0.0 )
+         maxlag = 1.0;
+   }
+   const double width = maxlag/nbins;
+
+   nthreads = ThreadCount( nthreads );
+   std::vector<Histogram> histograms( nthreads, Histogram(nbins) );
+
+   if( allpairs )
+   {
+      // Every pair (i,j) with j > i is contiguous in memory.
+      ParallelFor( N, nthreads, [&]( int i, int thread )
+      {
+         histograms[thread].Add( xc[i], yc[i], z[i], xc.data()+i+1, yc.data()+i+1, z.data()+i+1, N-i-1, maxlag, width );
+      });
+   }
+   else
+   {
+      // Work in cell order; each pair is counted once, from the lower
+      // position.
+      SpatialIndex index( xc, yc, maxlag );
+
+      std::vector<double> zs( N );
+      for( int p=0; p<N; ++p )
+         zs[p] = z[ index.Original(p) ];
+
+      const double* xs = index.X();
+      const double* ys = index.Y();
+
+      ParallelFor( N, nthreads, [&]( int p, int thread )
+      {
+         std::vector<int>& runs = histograms[thread].runs;
+         index.Query( xs[p], ys[p], maxlag, runs );
+
+         for( unsigned r=0; r<runs.size(); r += 2 )
+         {
+            int begin = std::max( runs[r], p+1 );
+            int end   = runs[r+1];
+            if( begin < end )
+               histograms[thread].Add( xs[p], ys[p], zs[p], xs+begin, ys+begin, zs.data()+begin, end-begin, maxlag, width );
+         }
+      });
+   }
+
+   // Sum the per-thread histograms.
+   std::vector<VariogramBin> bins( nbins );
+   for( int b=0; b<nbins; ++b )
+   {
+      double lag = 0.0;
+      double gamma = 0.0;
+      long long count = 0;
+      for( int t=0; t<nthreads; ++t )
+      {
+         lag   += histograms[t].lag[b];
+         gamma += histograms[t].gamma[b];
+         count += histograms[t].count[b];
+      }
+
+      bins[b].count = count;
+      bins[b].lag   = ( count > 0 ) ? lag/count : (b+0.5)*width;
+      bins[b].gamma = ( count > 0 ) ? gamma/count : NAN;
+   }
+
+   return bins;
+}
@@ -0,0 +1,32 @@
+//=============================================================================
+// variogram.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef VARIOGRAM_H
+#define VARIOGRAM_H
+
+#include <vector>
+
+//=============================================================================
+// VariogramBin
+//=============================================================================
+struct VariogramBin
+{
+   double      lag;                 // mean separation distance of the pairs
+   double      gamma;               // semivariance: mean of (z[i]-z[j])^2 / 2
+   long long   count;               // number of pairs
+};
+
+//=============================================================================
+std::vector<VariogramBin> EmpiricalVariogram( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, int nbins, double maxlag, int nthreads );
+
+
+//=============================================================================
+#endif  // VARIOGRAM_H
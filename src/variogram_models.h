@@ -0,0 +1,175 @@
+//=============================================================================
+// variogram_models.h
+//
+//    Variogram model policies for the Engine.
+//
+//    Each policy is a small value type with an inline operator() that
+//    returns gamma(h), and a Lambda(hmax) that returns a constant lambda
+//    such that lambda - gamma(h) is a valid (pseudo-) covariance for all
+//    separations up to hmax.  The Engine is a template over the policy, so
+//    the model is inlined into the matrix assembly with no per-element
+//    dispatch.
+//
+// notes:
+// o  The overall scale (slope or sill) of the variogram is irrelevant: it
+//    is absorbed by the stdXi normalization in the Engine.  So the nugget
+//    is given relative to the slope (linear, power) or to the partial sill
+//    (exponential, spherical, Gaussian), and the partial sill is 1.
+//
+// o  gamma(0) = 0 for every model; the nugget applies for h > 0 only.
+//
+// o  The range of the bounded models is the practical range; i.e. the
+//    exponential and Gaussian models reach 95% of the sill at h = range.
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef VARIOGRAM_MODELS_H
+#define VARIOGRAM_MODELS_H
+
+#include <cassert>
+#include <cmath>
+
+//=============================================================================
+// LinearVariogram:  gamma(h) = nugget + h
+//=============================================================================
+struct LinearVariogram
+{
+   double nugget;
+
+   explicit LinearVariogram( double nugget_ = 0.0 )
+   :  nugget( nugget_ )
+   {
+   }
+
+   double operator()( double h ) const
+   {
+      return ( h > 0 ) ? nugget + h : 0.0;
+   }
+
+   double Lambda( double hmax ) const
+   {
+      return (*this)( hmax );
+   }
+};
+
+//=============================================================================
+// PowerVariogram:  gamma(h) = nugget + h^exponent,  0 < exponent < 2
+//=============================================================================
+struct PowerVariogram
+{
+   double nugget;
+   double exponent;
+
+   PowerVariogram( double exponent_, double nugget_ = 0.0 )
+   :  nugget( nugget_ ),
+      exponent( exponent_ )
+   {
+      assert( exponent > 0 && exponent < 2 );
+   }
+
+   double operator()( double h ) const
+   {
+      return ( h > 0 ) ? nugget + pow( h, exponent ) : 0.0;
+   }
+
+   double Lambda( double hmax ) const
+   {
+      return (*this)( hmax );
+   }
+};
+
+//=============================================================================
+// ExponentialVariogram:  gamma(h) = nugget + 1 - exp(-3h/range)
+//=============================================================================
+struct ExponentialVariogram
+{
+   double nugget;
+   double scale;                    // 3/range
+
+   ExponentialVariogram( double range, double nugget_ = 0.0 )
+   :  nugget( nugget_ ),
+      scale( 3.0/range )
+   {
+      assert( range > 0 );
+   }
+
+   double operator()( double h ) const
+   {
+      return ( h > 0 ) ? nugget + 1.0 - exp( -scale*h ) : 0.0;
+   }
+
+   double Lambda( double ) const
+   {
+      return nugget + 1.0;
+   }
+};
+
+//=============================================================================
+// SphericalVariogram:  gamma(h) = nugget + 1.5(h/range) - 0.5(h/range)^3
+//                                 for h < range, and nugget + 1 beyond.
+//=============================================================================
+struct SphericalVariogram
+{
+   double nugget;
+   double range;
+
+   SphericalVariogram( double range_, double nugget_ = 0.0 )
+   :  nugget( nugget_ ),
+      range( range_ )
+   {
+      assert( range > 0 );
+   }
+
+   double operator()( double h ) const
+   {
+      if( !( h > 0 ) )
+         return 0.0;
+
+      double t = h/range;
+      return ( t < 1.0 ) ? nugget + t*( 1.5 - 0.5*t*t ) : nugget + 1.0;
+   }
+
+   double Lambda( double ) const
+   {
+      return nugget + 1.0;
+   }
+};
+
+//=============================================================================
+// GaussianVariogram:  gamma(h) = nugget + 1 - exp(-3(h/range)^2)
+//
+//    Without a nugget the Gaussian model gives notoriously ill-conditioned
+//    kriging systems; a small nugget is strongly recommended.
+//=============================================================================
+struct GaussianVariogram
+{
+   double nugget;
+   double scale;                    // 3/range^2
+
+   GaussianVariogram( double range, double nugget_ = 0.0 )
+   :  nugget( nugget_ ),
+      scale( 3.0/(range*range) )
+   {
+      assert( range > 0 );
+   }
+
+   double operator()( double h ) const
+   {
+      return ( h > 0 ) ? nugget + 1.0 - exp( -scale*h*h ) : 0.0;
+   }
+
+   double Lambda( double ) const
+   {
+      return nugget + 1.0;
+   }
+};
+
+
+//=============================================================================
+#endif  // VARIOGRAM_MODELS_H
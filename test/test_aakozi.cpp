@@ -0,0 +1,176 @@
+//=============================================================================
+// test_aakozi.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_aakozi.h"
+
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "test_data.h"
+#include "unit_test.h"
+#include "..\src\aakozi.h"
+#include "..\src\engine.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   //--------------------------------------------------------------------------
+   // Same
+   //
+   //    The C interface results are those of the Engine.
+   //--------------------------------------------------------------------------
+   bool Same( const std::vector<Boomerang>& expected, const std::vector<double>& zhat, const std::vector<double>& zeta, const std::vector<double>& pvalue, const std::vector<int>& cnt )
+   {
+      bool same = true;
+      for( size_t k=0; k<expected.size(); ++k )
+         same &= ( expected[k].zhat == zhat[k] && expected[k].zeta == zeta[k] && expected[k].pvalue == pvalue[k] && expected[k].cnt == cnt[k] );
+      return same;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestRun
+   //
+   //    A prepared engine reproduces the Engine, for two radii and a
+   //    second model, and the caller's arrays are used in place.
+   //--------------------------------------------------------------------------
+   bool TestRun()
+   {
+      std::vector<double> x, y, z;
+      TestData( 60, 0, x, y, z );
+      const int N = x.size();
+
+      EngineOptions options;
+      options.threads = 2;
+
+      aakozi_engine* engine = aakozi_create();
+      bool flag = CHECK( engine != nullptr );
+
+      flag &= CHECK( aakozi_set_threads( engine, 2 ) == AAKOZI_OK );
+      flag &= CHECK( aakozi_size( engine ) == 0 );
+      flag &= CHECK( aakozi_prepare( engine, x.data(), y.data(), nullptr, N ) == AAKOZI_OK );
+      flag &= CHECK( aakozi_size( engine ) == N );
+
+      std::vector<double> zhat(N), zeta(N), pvalue(N), pvalue_mc(N);
+      std::vector<int> cnt(N);
+      for( double radius : { 30.0, 60.0 } )
+      {
+         flag &= CHECK( aakozi_run( engine, z.data(), radius, zhat.data(), zeta.data(), pvalue.data(), pvalue_mc.data(), cnt.data() ) == AAKOZI_OK );
+         flag &= CHECK( Same( Engine( x, y, z, radius, options ), zhat, zeta, pvalue, cnt ) );
+         flag &= CHECK( std::isnan( pvalue_mc[0] ) );
+      }
+
+      flag &= CHECK( aakozi_set_model( engine, AAKOZI_MODEL_SPHERICAL, 150.0, 1.0, 0.1 ) == AAKOZI_OK );
+      flag &= CHECK( aakozi_run( engine, z.data(), 40.0, zhat.data(), zeta.data(), pvalue.data(), nullptr, cnt.data() ) == AAKOZI_OK );
+      flag &= CHECK( Same( Engine( x, y, z, 40.0, options, SphericalVariogram( 150.0, 0.1 ) ), zhat, zeta, pvalue, cnt ) );
+
+      aakozi_destroy( engine );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestErrors
+   //--------------------------------------------------------------------------
+   bool TestErrors()
+   {
+      std::vector<double> x, y, z;
+      TestData( 60, 0, x, y, z );
+
+      aakozi_engine* engine = aakozi_create();
+      std::vector<double> zhat( x.size() );
+
+      bool flag = true;
+      flag &= CHECK( aakozi_run( engine, z.data(), 30.0, zhat.data(), nullptr, nullptr, nullptr, nullptr ) == AAKOZI_NOT_PREPARED );
+      flag &= CHECK( aakozi_prepare( engine, x.data(), y.data(), nullptr, 1 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_prepare( engine, nullptr, y.data(), nullptr, 2 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_set_model( engine, AAKOZI_MODEL_GAUSSIAN, 0.0, 1.0, 0.0 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_set_model( engine, AAKOZI_MODEL_POWER, 0.0, 2.0, 0.0 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_set_model( engine, 7, 1.0, 1.0, 0.0 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_set_anisotropy( engine, 30.0, 0.0, 1.0 ) == AAKOZI_INVALID_ARGUMENT );
+      flag &= CHECK( aakozi_set_threads( nullptr, 1 ) == AAKOZI_INVALID_ARGUMENT );
+
+      flag &= CHECK( aakozi_prepare( engine, x.data(), y.data(), nullptr, int(x.size()) ) == AAKOZI_OK );
+      flag &= CHECK( aakozi_run( engine, z.data(), 0.0, zhat.data(), nullptr, nullptr, nullptr, nullptr ) == AAKOZI_INVALID_ARGUMENT );
+
+      aakozi_destroy( engine );
+      aakozi_destroy( nullptr );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestConcurrent
+   //
+   //    Independent engines on different threads at the same time give the
+   //    results each gives alone.
+   //--------------------------------------------------------------------------
+   bool TestConcurrent()
+   {
+      const int E = 4;
+
+      std::vector< std::vector<double> > x(E), y(E), z(E), zhat(E), zeta(E), pvalue(E);
+      std::vector< std::vector<int> > cnt(E);
+      std::vector<int> status(E, -1);
+      for( int e=0; e<E; ++e )
+      {
+         TestData( 60, e, x[e], y[e], z[e] );
+         zhat[e].resize( x[e].size() );
+         zeta[e].resize( x[e].size() );
+         pvalue[e].resize( x[e].size() );
+         cnt[e].resize( x[e].size() );
+      }
+
+      std::vector<std::thread> threads;
+      for( int e=0; e<E; ++e )
+      {
+         threads.emplace_back( [&, e]
+         {
+            aakozi_engine* engine = aakozi_create();
+            status[e] = aakozi_set_threads( engine, 2 );
+            if( status[e] == AAKOZI_OK )
+               status[e] = aakozi_prepare( engine, x[e].data(), y[e].data(), nullptr, int(x[e].size()) );
+            if( status[e] == AAKOZI_OK )
+               status[e] = aakozi_run( engine, z[e].data(), 45.0, zhat[e].data(), zeta[e].data(), pvalue[e].data(), nullptr, cnt[e].data() );
+            aakozi_destroy( engine );
+         });
+      }
+      for( auto& t : threads )
+         t.join();
+
+      EngineOptions options;
+      options.threads = 1;
+
+      bool flag = true;
+      for( int e=0; e<E; ++e )
+      {
+         flag &= CHECK( status[e] == AAKOZI_OK );
+         flag &= CHECK( Same( Engine( x[e], y[e], z[e], 45.0, options ), zhat[e], zeta[e], pvalue[e], cnt[e] ) );
+      }
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Aakozi
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Aakozi()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestRun() );
+   TALLY( TestErrors() );
+   TALLY( TestConcurrent() );
+
+   return std::make_pair( nsucc, nfail );
+}
@@ -0,0 +1,21 @@
+//=============================================================================
+// test_aakozi.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_AAKOZI_H
+#define TEST_AAKOZI_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Aakozi();
+
+//=============================================================================
+#endif  // TEST_AAKOZI_H
@@ -0,0 +1,116 @@
+//=============================================================================
+// test_bit_mask.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_bit_mask.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\bit_mask.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   //--------------------------------------------------------------------------
+   // TestCount
+   //
+   //    Count, ForEach and Indices agree with the flags; Resize keeps the
+   //    unused bits of the last word clear.
+   //--------------------------------------------------------------------------
+   bool TestCount()
+   {
+      bool flag = true;
+
+      BitMask all( 70, true );
+      flag &= CHECK( all.size() == 70 && all.nWords() == 2 );
+      flag &= CHECK( all.Count() == 70 );
+
+      all.Clear(3);
+      all.Clear(64);
+      all.Clear(69);
+      flag &= CHECK( all.Count() == 67 );
+      flag &= CHECK( !all[3] && !all[64] && all[65] );
+
+      std::vector<int> index;
+      all.Indices( index );
+      flag &= CHECK( index.size() == 67 );
+      flag &= CHECK( index[3] == 4 && index[63] == 65 && index.back() == 68 );
+
+      BitMask none( 64 );
+      flag &= CHECK( none.Count() == 0 );
+      none.Set(63);
+      int visited = -1;
+      none.ForEach( [&visited]( int i ){ visited = i; } );
+      flag &= CHECK( visited == 63 );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestGreaterThan
+   //
+   //    The vectorized compare matches the scalar compare, for any length,
+   //    in double and in single precision, and with NaN.
+   //--------------------------------------------------------------------------
+   bool TestGreaterThan()
+   {
+      bool flag = true;
+
+      for( int n=0; n<140; n += 7 )
+      {
+         std::vector<double> d(n);
+         std::vector<float>  f(n);
+         for( int j=0; j<n; ++j )
+         {
+            d[j] = 10.0 + 10.0*sin( 0.37*j*j );
+            f[j] = float( d[j] );
+         }
+         if( n > 5 )
+         {
+            d[5] = NAN;
+            f[5] = NAN;
+         }
+
+         BitMask a, b;
+         GreaterThan( d.data(), n, 10.0, a );
+         GreaterThan( f.data(), n, 10.0, b );
+
+         int count = 0, fcount = 0;
+         for( int j=0; j<n; ++j )
+         {
+            flag &= CHECK( a[j] == ( d[j] > 10.0 ) );
+            flag &= CHECK( b[j] == ( double(f[j]) > 10.0 ) );
+            count  += ( d[j] > 10.0 );
+            fcount += ( double(f[j]) > 10.0 );
+         }
+         flag &= CHECK( a.Count() == count && b.Count() == fcount );
+      }
+
+      return flag;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// test_BitMask
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_BitMask()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestCount() );
+   TALLY( TestGreaterThan() );
+
+   return std::make_pair( nsucc, nfail );
+}
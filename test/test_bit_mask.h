@@ -0,0 +1,21 @@
+//=============================================================================
+// test_bit_mask.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_BIT_MASK_H
+#define TEST_BIT_MASK_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_BitMask();
+
+//=============================================================================
+#endif  // TEST_BIT_MASK_H
@@ -0,0 +1,150 @@
+//=============================================================================
+// test_checkpoint.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_checkpoint.h"
+
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+#include "test_data.h"
+#include "unit_test.h"
+#include "..\src\checkpoint.h"
+#include "..\src\engine.h"
+#include "..\src\matrix.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const char* FILENAME = "test_checkpoint.ckpt";
+
+   //--------------------------------------------------------------------------
+   // TestSaveLoad
+   //
+   //    Only the finished rows are saved and restored, and only for the
+   //    same hash.
+   //--------------------------------------------------------------------------
+   bool TestSaveLoad()
+   {
+      const int N = 7, P = 2;
+
+      Matrix Zhat(N, P), Xi(N, P), Tau(N, 1);
+      std::vector<int> cnt(N, 0);
+      for( int k=0; k<N; ++k )
+      {
+         Zhat(k,0) = k;      Zhat(k,1) = 10.0*k;
+         Xi(k,0)   = -k;     Xi(k,1)   = ( k == 3 ? NAN : 0.5*k );
+         Tau(k,0)  = 1.0 + k;
+         cnt[k]    = 100 + k;
+      }
+
+      bool flag = true;
+      {
+         Checkpoint checkpoint( FILENAME, 12345, 1e9, Zhat, Xi, Tau, cnt );
+         checkpoint.Finished( 1 );
+         checkpoint.Finished( 3 );
+         checkpoint.Finished( 6 );
+         flag &= CHECK( checkpoint.Save() );
+      }
+
+      Matrix Zhat2(N, P), Xi2(N, P), Tau2(N, 1);
+      std::vector<int> cnt2(N, 0);
+      {
+         Checkpoint checkpoint( FILENAME, 12346, 1e9, Zhat2, Xi2, Tau2, cnt2 );
+         flag &= CHECK( checkpoint.Load() == 0 );
+      }
+      {
+         Checkpoint checkpoint( FILENAME, 12345, 1e9, Zhat2, Xi2, Tau2, cnt2 );
+         flag &= CHECK( checkpoint.Load() == 3 );
+
+         bool same = true;
+         for( int k=0; k<N; ++k )
+         {
+            const bool saved = ( k == 1 || k == 3 || k == 6 );
+            same &= ( checkpoint.IsFinished(k) == saved );
+            if( saved )
+            {
+               same &= ( Zhat2(k,0) == Zhat(k,0) && Zhat2(k,1) == Zhat(k,1) );
+               same &= ( Xi2(k,0) == Xi(k,0) && ( k == 3 ? std::isnan( Xi2(k,1) ) : Xi2(k,1) == Xi(k,1) ) );
+               same &= ( Tau2(k,0) == Tau(k,0) && cnt2[k] == cnt[k] );
+            }
+            else
+            {
+               same &= ( cnt2[k] == 0 );
+            }
+         }
+         flag &= CHECK( same );
+      }
+
+      std::remove( FILENAME );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestResume
+   //
+   //    A run resumed from a complete checkpoint restores every observation,
+   //    solves nothing, and gives the same results.  Another radius does not
+   //    match the checkpoint.
+   //--------------------------------------------------------------------------
+   bool TestResume()
+   {
+      std::vector<double> x, y, z;
+      TestData( 60, 0, x, y, z );
+
+      EngineOptions options;
+      options.checkpoint = FILENAME;
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, options );
+
+      EngineProgress progress;
+      options.resume   = true;
+      options.progress = &progress;
+      std::vector<Boomerang> B = Engine( x, y, z, 30.0, options );
+
+      bool flag = true;
+      flag &= CHECK( progress.completed == int( x.size() ) );
+
+      bool same = true;
+      for( size_t k=0; k<x.size(); ++k )
+         same &= ( A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta && A[k].cnt == B[k].cnt );
+      flag &= CHECK( same );
+
+      // The checkpoint for radius 30 does not apply at radius 40.
+      EngineOptions fresh;
+      std::vector<Boomerang> C = Engine( x, y, z, 40.0, fresh );
+      std::vector<Boomerang> D = Engine( x, y, z, 40.0, options );
+
+      same = true;
+      for( size_t k=0; k<x.size(); ++k )
+         same &= ( C[k].zhat == D[k].zhat && C[k].zeta == D[k].zeta && C[k].cnt == D[k].cnt );
+      flag &= CHECK( same );
+
+      std::remove( FILENAME );
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Checkpoint
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Checkpoint()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestSaveLoad() );
+   TALLY( TestResume() );
+
+   return std::make_pair( nsucc, nfail );
+}
@@ -0,0 +1,21 @@
+//=============================================================================
+// test_checkpoint.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_CHECKPOINT_H
+#define TEST_CHECKPOINT_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Checkpoint();
+
+//=============================================================================
+#endif  // TEST_CHECKPOINT_H
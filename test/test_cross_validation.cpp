@@ -0,0 +1,143 @@
+//=============================================================================
+// test_cross_validation.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_cross_validation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "test_data.h"
+#include "unit_test.h"
+#include "..\src\cross_validation.h"
+#include "..\src\engine.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const double TOLERANCE = 1e-6;
+
+   //--------------------------------------------------------------------------
+   // TestFolds
+   //
+   //    Every fold is used, and the observations in a block share a fold.
+   //--------------------------------------------------------------------------
+   bool TestFolds()
+   {
+      std::vector<double> x, y, z;
+      TestData( 80, 0, x, y, z );
+
+      std::vector<int> fold;
+      int B = SpatialFolds( x, y, 50.0, 4, 1234, fold );
+
+      bool flag = true;
+      flag &= CHECK( B >= 4 );
+      flag &= CHECK( fold.size() == x.size() );
+
+      // The blocks are anchored at the lower-left corner.
+      const double x0 = *std::min_element( x.begin(), x.end() );
+      const double y0 = *std::min_element( y.begin(), y.end() );
+
+      std::vector<int> used(4, 0);
+      for( unsigned i=0; i<x.size(); ++i )
+      {
+         flag &= CHECK( fold[i] >= 0 && fold[i] < 4 );
+         ++used[ fold[i] ];
+
+         for( unsigned j=0; j<i; ++j )
+         {
+            if( floor( (x[i]-x0)/50.0 ) == floor( (x[j]-x0)/50.0 ) && floor( (y[i]-y0)/50.0 ) == floor( (y[j]-y0)/50.0 ) )
+               flag &= CHECK( fold[i] == fold[j] );
+         }
+      }
+      for( int f=0; f<4; ++f )
+         flag &= CHECK( used[f] > 0 );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestLeaveOneOut
+   //
+   //    With one observation per fold, block cross-validation is the
+   //    Engine with a buffer radius that holds out only the observation.
+   //--------------------------------------------------------------------------
+   bool TestLeaveOneOut()
+   {
+      std::vector<double> x, y, z;
+      TestData( 80, 0, x, y, z );
+
+      std::vector<int> fold( x.size() );
+      for( unsigned i=0; i<x.size(); ++i )
+         fold[i] = i;
+
+      EngineOptions options;
+      std::vector<Boomerang> A = Engine( x, y, z, 1e-9, options );
+      std::vector<Boomerang> B = BlockCrossValidation( x, y, z, fold, options );
+
+      bool flag = true;
+      for( unsigned k=0; k<x.size(); ++k )
+      {
+         flag &= CHECK( A[k].cnt == B[k].cnt );
+         flag &= CHECK( fabs( A[k].zhat - B[k].zhat ) < TOLERANCE );
+         flag &= CHECK( fabs( A[k].zeta - B[k].zeta ) < TOLERANCE );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestThreads
+   //
+   //    The results do not depend upon the number of threads.
+   //--------------------------------------------------------------------------
+   bool TestThreads()
+   {
+      std::vector<double> x, y, z;
+      TestData( 80, 0, x, y, z );
+
+      std::vector<int> fold;
+      SpatialFolds( x, y, 40.0, 5, 99, fold );
+
+      EngineOptions one, three;
+      one.threads   = 1;
+      three.threads = 3;
+
+      std::vector<Boomerang> A = BlockCrossValidation( x, y, z, fold, one, ExponentialVariogram( 200.0, 0.0 ) );
+      std::vector<Boomerang> B = BlockCrossValidation( x, y, z, fold, three, ExponentialVariogram( 200.0, 0.0 ) );
+
+      bool flag = true;
+      for( unsigned k=0; k<x.size(); ++k )
+      {
+         flag &= CHECK( A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta );
+         flag &= CHECK( A[k].cnt > 0 && A[k].cnt < int( x.size() ) );
+      }
+
+      return flag;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// test_CrossValidation
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_CrossValidation()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestFolds() );
+   TALLY( TestLeaveOneOut() );
+   TALLY( TestThreads() );
+
+   return std::make_pair( nsucc, nfail );
+}
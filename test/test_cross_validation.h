@@ -0,0 +1,21 @@
+//=============================================================================
+// test_cross_validation.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_CROSS_VALIDATION_H
+#define TEST_CROSS_VALIDATION_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_CrossValidation();
+
+//=============================================================================
+#endif  // TEST_CROSS_VALIDATION_H
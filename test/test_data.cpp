@@ -0,0 +1,33 @@
+//=============================================================================
+// test_data.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_data.h"
+
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// TestData
+//
+//    A scattered set of n observations with a linear trend, shared by the
+//    tests.  Different seeds give different sets of the same shape.
+//-----------------------------------------------------------------------------
+void TestData( int n, int seed, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z )
+{
+   x.clear();
+   y.clear();
+   z.clear();
+   for( int i=0; i<n; ++i )
+   {
+      x.push_back( 100.0*sin(1.3*i + seed) + 3.0*i );
+      y.push_back( 100.0*cos(2.1*i - seed) - 2.0*i );
+      z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i + seed) );
+   }
+}
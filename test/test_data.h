@@ -0,0 +1,21 @@
+//=============================================================================
+// test_data.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_DATA_H
+#define TEST_DATA_H
+
+#include <vector>
+
+//-----------------------------------------------------------------------------
+void TestData( int n, int seed, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z );
+
+//=============================================================================
+#endif  // TEST_DATA_H
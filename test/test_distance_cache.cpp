@@ -0,0 +1,122 @@
+//=============================================================================
+// test_distance_cache.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_distance_cache.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "test_data.h"
+#include "unit_test.h"
+#include "..\src\distance_cache.h"
+#include "..\src\engine.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   //--------------------------------------------------------------------------
+   // TestStoreMap
+   //
+   //    A stored table maps back exactly, but only for its own hash, size
+   //    and entry size.
+   //--------------------------------------------------------------------------
+   bool TestStoreMap()
+   {
+      const int n = 5;
+      std::vector<double> table( n*n );
+      for( int i=0; i<n*n; ++i )
+         table[i] = 0.25*i;
+
+      const std::string filename = DistanceCacheName( ".", 777 );
+
+      bool flag = true;
+      flag &= CHECK( StoreDistances( filename, 777, n, sizeof(double), 6.0, 0.5, table.data() ) );
+
+      CachedDistances cached;
+      flag &= CHECK( !cached.Map( filename, 778, n, sizeof(double) ) );
+      flag &= CHECK( !cached.Map( filename, 777, n+1, sizeof(double) ) );
+      flag &= CHECK( !cached.Map( filename, 777, n, sizeof(float) ) );
+
+      flag &= CHECK( cached.Map( filename, 777, n, sizeof(double) ) );
+      flag &= CHECK( memcmp( cached.Data(), table.data(), sizeof(double)*n*n ) == 0 );
+      flag &= CHECK( cached.MaxEntry() == 6.0 && cached.Error() == 0.5 );
+
+      std::remove( filename.c_str() );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestEngineCache
+   //
+   //    The first run adds the table to the cache, the second maps it, and
+   //    the results are the same as without the cache, in double and in
+   //    single precision.
+   //--------------------------------------------------------------------------
+   bool TestEngineCache()
+   {
+      std::vector<double> x, y, z;
+      TestData( 70, 0, x, y, z );
+
+      bool flag = true;
+      for( int single=0; single<2; ++single )
+      {
+         EngineOptions plain;
+         plain.single_precision = ( single == 1 );
+
+         EngineOptions options = plain;
+         options.distance_cache = ".";
+
+         const size_t entry = ( single ? sizeof(float) : sizeof(double) );
+         const uint64_t hash = DistanceHash( x, y, std::vector<double>(), options.anisotropy, false, entry );
+         const std::string filename = DistanceCacheName( ".", hash );
+         std::remove( filename.c_str() );
+
+         std::vector<Boomerang> A = Engine( x, y, z, 30.0, plain );
+         std::vector<Boomerang> B = Engine( x, y, z, 30.0, options );
+
+         CachedDistances cached;
+         flag &= CHECK( cached.Map( filename, hash, x.size(), entry ) );
+
+         std::vector<Boomerang> C = Engine( x, y, z, 35.0, plain );
+         std::vector<Boomerang> D = Engine( x, y, z, 35.0, options );
+
+         bool same = true;
+         for( size_t k=0; k<x.size(); ++k )
+         {
+            same &= ( A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta && A[k].cnt == B[k].cnt );
+            same &= ( C[k].zhat == D[k].zhat && C[k].zeta == D[k].zeta && C[k].cnt == D[k].cnt );
+         }
+         flag &= CHECK( same );
+
+         std::remove( filename.c_str() );
+      }
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_DistanceCache
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_DistanceCache()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestStoreMap() );
+   TALLY( TestEngineCache() );
+
+   return std::make_pair( nsucc, nfail );
+}
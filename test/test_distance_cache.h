@@ -0,0 +1,21 @@
+//=============================================================================
+// test_distance_cache.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_DISTANCE_CACHE_H
+#define TEST_DISTANCE_CACHE_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_DistanceCache();
+
+//=============================================================================
+#endif  // TEST_DISTANCE_CACHE_H
@@ -0,0 +1,155 @@
+//=============================================================================
+// test_duplicates.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_duplicates.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\duplicates.h"
+#include "..\src\engine.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const double TOLERANCE = 1e-9;
+
+   //--------------------------------------------------------------------------
+   // TestExact
+   //--------------------------------------------------------------------------
+   bool TestExact()
+   {
+      std::vector<double> x = { 0.0, 1.0, 0.0, 2.0, 1.0, -0.0, 1.0 + 1e-12 };
+      std::vector<double> y = { 0.0, 1.0, 0.0, 2.0, 1.0,  0.0, 1.0 };
+      std::vector<int> group, first;
+
+      int G = FindDuplicates( x, y, nullptr, 0.0, group, first );
+
+      bool flag = true;
+      flag &= CHECK( G == 4 );
+      flag &= CHECK( group == std::vector<int>({ 0, 1, 0, 2, 1, 0, 3 }) );
+      flag &= CHECK( first == std::vector<int>({ 0, 1, 3, 6 }) );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestNear
+   //
+   //    Near duplicates are grouped transitively, across cell boundaries,
+   //    and in 3-D the elevations must also be close.
+   //--------------------------------------------------------------------------
+   bool TestNear()
+   {
+      std::vector<double> x = { 0.99, 1.01, 1.03, 5.0, 5.0 };
+      std::vector<double> y = { 0.0,  0.0,  0.0,  5.0, 5.0 };
+      std::vector<double> e = { 0.0,  0.0,  0.0,  0.0, 3.0 };
+      std::vector<int> group, first;
+
+      bool flag = true;
+
+      int G = FindDuplicates( x, y, nullptr, 0.025, group, first );
+      flag &= CHECK( G == 2 );
+      flag &= CHECK( group == std::vector<int>({ 0, 0, 0, 1, 1 }) );
+
+      G = FindDuplicates( x, y, &e, 0.025, group, first );
+      flag &= CHECK( G == 3 );
+      flag &= CHECK( group == std::vector<int>({ 0, 0, 0, 1, 2 }) );
+
+      G = FindDuplicates( x, y, nullptr, 0.015, group, first );
+      flag &= CHECK( G == 4 );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestPolicies
+   //
+   //    With duplicates the Engine must not attempt any singular system.
+   //    Each policy is checked against the Engine on the distinct locations.
+   //--------------------------------------------------------------------------
+   bool TestPolicies()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<60; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+      std::vector<double> xd = x, yd = y, zd = z;
+      for( int i=0; i<60; i += 6 )
+      {
+         xd.push_back( x[i] );
+         yd.push_back( y[i] );
+         zd.push_back( z[i] + 2.0 );
+      }
+
+      const int N = x.size();
+      const int ND = xd.size();
+
+      EngineOptions options;
+      std::vector<Boomerang> U = Engine( x, y, z, 20.0, options );
+
+      bool flag = true;
+
+      // First: the duplicates are dropped.
+      options.duplicates = DUPLICATES_FIRST;
+      std::vector<Boomerang> F = Engine( xd, yd, zd, 20.0, options );
+      for( int k=0; k<N; ++k )
+         flag &= CHECK( F[k].zhat == U[k].zhat && F[k].zeta == U[k].zeta );
+      for( int k=N; k<ND; ++k )
+         flag &= CHECK( F[k].cnt == 0 && std::isnan( F[k].zeta ) );
+
+      // Average: the duplicated locations take the mean value.
+      std::vector<double> zm = z;
+      for( int i=0; i<60; i += 6 )
+         zm[i] += 1.0;
+      std::vector<Boomerang> M = Engine( x, y, zm, 20.0, EngineOptions() );
+
+      options.duplicates = DUPLICATES_AVERAGE;
+      std::vector<Boomerang> A = Engine( xd, yd, zd, 20.0, options );
+      for( int k=0; k<N; ++k )
+         flag &= CHECK( A[k].zhat == M[k].zhat && A[k].zeta == M[k].zeta );
+      for( int k=N; k<ND; ++k )
+         flag &= CHECK( A[k].zeta == A[ (k-N)*6 ].zeta );
+
+      // Group: the replicates share the estimate, but not the residual.
+      options.duplicates = DUPLICATES_GROUP;
+      std::vector<Boomerang> G = Engine( xd, yd, zd, 20.0, options );
+      for( int k=N; k<ND; ++k )
+      {
+         int i = (k-N)*6;
+         flag &= CHECK( G[k].zhat == M[i].zhat );
+         flag &= CHECK( G[k].cnt == M[i].cnt );
+         flag &= CHECK( G[k].zeta > G[i].zeta );
+      }
+      flag &= CHECK( fabs( G[1].zhat - M[1].zhat ) < TOLERANCE );
+
+      return flag;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// test_Duplicates
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Duplicates()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestExact() );
+   TALLY( TestNear() );
+   TALLY( TestPolicies() );
+
+   return std::make_pair( nsucc, nfail );
+}
@@ -0,0 +1,21 @@
+//=============================================================================
+// test_duplicates.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_DUPLICATES_H
+#define TEST_DUPLICATES_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Duplicates();
+
+//=============================================================================
+#endif  // TEST_DUPLICATES_H
@@ -11,9 +11,15 @@
 //=============================================================================
 #include "test_engine.h"
 
+#include <algorithm>
+#include <cmath>
 #include <utility>
+#include <vector>
+#include "test_data.h"
 #include "unit_test.h"
+#include "..\src\distance.h"
 #include "..\src\engine.h"
+#include "..\src\neighbor_lists.h"
 
 //-----------------------------------------------------------------------------
 // Hide all of the testing details inside an unnamed namespace. This allows me
@@ -98,6 +104,645 @@ namespace{
 
       return true;
    }
+
+   //--------------------------------------------------------------------------
+   // TestGridEngine
+   //
+   //    The FFT/conjugate gradient solver for gridded data must reproduce
+   //    the dense solver.  The grid has a few no-data nodes.
+   //--------------------------------------------------------------------------
+   bool TestGridEngine()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<12; ++i )
+      {
+         for( int j=0; j<9; ++j )
+         {
+            if( (i*9 + j) % 17 == 5 ) continue;
+
+            x.push_back( 10.0*j );
+            y.push_back( 25.0*i );
+            z.push_back( 100.0 + 0.3*j - 0.2*i + 4.0*sin(1.7*i*j) );
+         }
+      }
+
+      EngineOptions dense;
+      EngineOptions grid;
+      grid.grid_mode = GRID_ON;
+
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, dense );
+      std::vector<Boomerang> B = Engine( x, y, z, 30.0, grid );
+
+      bool flag = true;
+
+      flag &= CHECK( A.size() == B.size() );
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].cnt == B[k].cnt );
+         flag &= CHECK( isClose(A[k].zhat, B[k].zhat, 1e-6) );
+         flag &= CHECK( isClose(A[k].zeta, B[k].zeta, 1e-6) );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestVariogramModels
+   //
+   //    The default Engine is the LinearVariogram instantiation, and the
+   //    FFT solver must reproduce the dense solver for a bounded model with
+   //    a nugget.
+   //--------------------------------------------------------------------------
+   bool TestVariogramModels()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<12; ++i )
+      {
+         for( int j=0; j<9; ++j )
+         {
+            if( (i*9 + j) % 17 == 5 ) continue;
+
+            x.push_back( 10.0*j );
+            y.push_back( 25.0*i );
+            z.push_back( 100.0 + 0.3*j - 0.2*i + 4.0*sin(1.7*i*j) );
+         }
+      }
+
+      bool flag = true;
+
+      // The policies.
+      SphericalVariogram spherical( 50.0, 0.2 );
+      flag &= CHECK( spherical(0.0) == 0.0 );
+      flag &= CHECK( isClose( spherical(50.0), 1.2, TOLERANCE ) );
+      flag &= CHECK( spherical(80.0) == spherical.Lambda(80.0) );
+      flag &= CHECK( isClose( ExponentialVariogram(50.0)(50.0), 1.0 - exp(-3.0), TOLERANCE ) );
+      flag &= CHECK( isClose( PowerVariogram(1.5)(4.0), 8.0, TOLERANCE ) );
+
+      // The default model.
+      EngineOptions dense;
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, dense );
+      std::vector<Boomerang> B = Engine( x, y, z, 30.0, dense, LinearVariogram() );
+
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].zhat == B[k].zhat );
+         flag &= CHECK( A[k].zeta == B[k].zeta );
+      }
+
+      // The FFT solver with a bounded model.
+      EngineOptions grid;
+      grid.grid_mode = GRID_ON;
+
+      ExponentialVariogram model( 120.0, 0.1 );
+      std::vector<Boomerang> C = Engine( x, y, z, 30.0, dense, model );
+      std::vector<Boomerang> D = Engine( x, y, z, 30.0, grid, model );
+
+      for( unsigned k=0; k<C.size(); ++k )
+      {
+         flag &= CHECK( C[k].cnt == D[k].cnt );
+         flag &= CHECK( isClose(C[k].zhat, D[k].zhat, 1e-6) );
+         flag &= CHECK( isClose(C[k].zeta, D[k].zeta, 1e-6) );
+         flag &= CHECK( C[k].zhat != A[k].zhat );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestAnisotropy
+   //
+   //    An anisotropic Engine must match the isotropic Engine applied to
+   //    rotated and scaled coordinates, for the dense solver, the FFT solver,
+   //    and the neighbor lists.
+   //--------------------------------------------------------------------------
+   bool TestAnisotropy()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<12; ++i )
+      {
+         for( int j=0; j<9; ++j )
+         {
+            if( (i*9 + j) % 17 == 5 ) continue;
+
+            x.push_back( 10.0*j );
+            y.push_back( 25.0*i );
+            z.push_back( 100.0 + 0.3*j - 0.2*i + 4.0*sin(1.7*i*j) );
+         }
+      }
+
+      const double angle = 30.0;
+      const double ratio = 0.4;
+      const double theta = angle * 3.14159265358979323846 / 180.0;
+
+      std::vector<double> u, v;
+      for( unsigned k=0; k<x.size(); ++k )
+      {
+         u.push_back( (  cos(theta)*x[k] + sin(theta)*y[k] ) );
+         v.push_back( ( -sin(theta)*x[k] + cos(theta)*y[k] ) / ratio );
+      }
+
+      EngineOptions iso;
+      EngineOptions dense;
+      dense.anisotropy.angle = angle;
+      dense.anisotropy.ratio = ratio;
+
+      EngineOptions grid = dense;
+      grid.grid_mode = GRID_ON;
+
+      NeighborLists neighbors( x, y, 100.0, 2, dense.anisotropy );
+      EngineOptions listed = dense;
+      listed.neighbors = &neighbors;
+
+      std::vector<Boomerang> A = Engine( u, v, z, 40.0, iso );
+      std::vector<Boomerang> B = Engine( x, y, z, 40.0, dense );
+      std::vector<Boomerang> C = Engine( x, y, z, 40.0, grid );
+      std::vector<Boomerang> D = Engine( x, y, z, 40.0, listed );
+
+      bool flag = true;
+
+      flag &= CHECK( isClose( Distance( 3.0, 4.0, Anisotropy() ), 5.0, TOLERANCE ) );
+
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].cnt == B[k].cnt );
+         flag &= CHECK( isClose(A[k].zhat, B[k].zhat, 1e-6) );
+         flag &= CHECK( isClose(A[k].zeta, B[k].zeta, 1e-6) );
+
+         flag &= CHECK( B[k].cnt == C[k].cnt );
+         flag &= CHECK( isClose(B[k].zhat, C[k].zhat, 1e-6) );
+
+         flag &= CHECK( B[k].cnt == D[k].cnt );
+         flag &= CHECK( B[k].zhat == D[k].zhat );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestVolumetric
+   //
+   //    The 3-D Engine must reduce to the 2-D Engine for flat data, honor
+   //    the vertical factor, and give the same results with 3-D neighbor
+   //    lists.
+   //--------------------------------------------------------------------------
+   bool TestVolumetric()
+   {
+      std::vector<double> x, y, elev, flat, stretched, z;
+      for( int i=0; i<90; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         elev.push_back( 5.0*(i % 7) );
+         flat.push_back( 12.0 );
+         stretched.push_back( 4.0*elev.back() );
+         z.push_back( 50.0 + 0.1*x.back() - 0.3*elev.back() + 5.0*sin(0.7*i) );
+      }
+
+      EngineOptions options;
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, options );
+      std::vector<Boomerang> B = Engine( x, y, flat, z, 30.0, options );
+
+      EngineOptions vertical;
+      vertical.anisotropy.vertical = 4.0;
+      std::vector<Boomerang> C = Engine( x, y, elev, z, 30.0, vertical );
+      std::vector<Boomerang> D = Engine( x, y, stretched, z, 30.0, options );
+
+      NeighborLists neighbors( x, y, elev, 50.0, 2, vertical.anisotropy );
+      EngineOptions listed = vertical;
+      listed.neighbors = &neighbors;
+      std::vector<Boomerang> E = Engine( x, y, elev, z, 30.0, listed );
+
+      bool flag = true;
+
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].cnt == B[k].cnt );
+         flag &= CHECK( isClose(A[k].zhat, B[k].zhat, 1e-8) );
+
+         flag &= CHECK( C[k].cnt == D[k].cnt );
+         flag &= CHECK( isClose(C[k].zhat, D[k].zhat, 1e-8) );
+
+         flag &= CHECK( C[k].cnt == E[k].cnt );
+         flag &= CHECK( C[k].zhat == E[k].zhat );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestGeographic
+   //
+   //    The vectorized great-circle distances must match the haversine
+   //    formula, and the geographic Engine must select its buffers by them.
+   //--------------------------------------------------------------------------
+   bool TestGeographic()
+   {
+      const double DEGREES = 3.14159265358979323846 / 180.0;
+
+      auto Haversine = []( double lon0, double lat0, double lon1, double lat1 )
+      {
+         const double D = 3.14159265358979323846 / 180.0;
+         double a = sin( 0.5*(lat1-lat0)*D );
+         double b = sin( 0.5*(lon1-lon0)*D );
+         double h = a*a + cos(lat0*D)*cos(lat1*D)*b*b;
+         return 2.0 * EARTH_RADIUS * asin( sqrt(h) );
+      };
+
+      std::vector<double> lon, lat, z;
+      for( int i=0; i<70; ++i )
+      {
+         lon.push_back( -93.0 + 2.5*sin(1.3*i) );
+         lat.push_back(  46.0 + 1.5*cos(2.1*i) );
+         z.push_back( 50.0 + 2.0*lon.back() + 5.0*sin(0.7*i) );
+      }
+
+      bool flag = true;
+
+      // One degree of longitude on the equator.
+      std::vector<double> X, Y, Z;
+      UnitVectors( std::vector<double>{0.0, 1.0}, std::vector<double>{0.0, 0.0}, X, Y, Z );
+
+      double d;
+      GreatCircleDistances( X[0], Y[0], Z[0], &X[1], &Y[1], &Z[1], 1, &d );
+      flag &= CHECK( isClose( d, EARTH_RADIUS*DEGREES, 1e-9 ) );
+
+      // Against the haversine formula, through both the vector and scalar paths.
+      UnitVectors( lon, lat, X, Y, Z );
+      std::vector<double> dist( lon.size() );
+      GreatCircleDistances( X[0], Y[0], Z[0], X.data(), Y.data(), Z.data(), lon.size(), dist.data() );
+      for( unsigned j=0; j<lon.size(); ++j )
+         flag &= CHECK( fabs( dist[j] - Haversine(lon[0], lat[0], lon[j], lat[j]) ) < 1e-8*( 1.0 + dist[j] ) );
+
+      // Far beyond the reach of the series, near and far lanes mixed, up to
+      // antipodal points.
+      std::vector<double> far_lon, far_lat;
+      for( int i=0; i<9; ++i )
+      {
+         far_lon.push_back( ( i % 2 == 0 ) ? 180.0 - 1.5*i : 0.3*i );
+         far_lat.push_back( 10.0 - 2.0*i );
+      }
+      far_lon.push_back( 180.0 );
+      far_lat.push_back( 0.0 );
+      far_lon.push_back( 0.0 );
+      far_lat.push_back( 0.0 );
+
+      UnitVectors( far_lon, far_lat, X, Y, Z );
+      std::vector<double> far( far_lon.size() );
+      GreatCircleDistances( X[9], Y[9], Z[9], X.data(), Y.data(), Z.data(), 9, far.data() );
+      for( unsigned j=0; j<9; ++j )
+         flag &= CHECK( fabs( far[j] - Haversine(far_lon[9], far_lat[9], far_lon[j], far_lat[j]) ) < 1e-8*( 1.0 + far[j] ) );
+
+      GreatCircleDistances( X[10], Y[10], Z[10], &X[9], &Y[9], &Z[9], 1, &d );
+      flag &= CHECK( isClose( d, EARTH_RADIUS*180.0*DEGREES, 1e-3 ) );
+
+      // The buffer counts.
+      const double radius = 60.0;
+      EngineOptions options;
+      options.geographic = true;
+      std::vector<Boomerang> B = Engine( lon, lat, z, radius, options );
+
+      for( unsigned k=0; k<lon.size(); ++k )
+      {
+         int M = 0;
+         for( unsigned j=0; j<lon.size(); ++j )
+         {
+            if( Haversine(lon[k], lat[k], lon[j], lat[j]) > radius )
+               ++M;
+         }
+         flag &= CHECK( B[k].cnt == M );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestSinglePrecision
+   //
+   //    Far from the origin, the centered single precision distances must
+   //    be accurate, and the results close to those in double precision.
+   //--------------------------------------------------------------------------
+   bool TestSinglePrecision()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<90; ++i )
+      {
+         x.push_back( 480000.0 + 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 4980000.0 + 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.001*(x.back()-480000.0) + 5.0*sin(0.7*i) );
+      }
+
+      double error = -1.0;
+
+      EngineOptions options;
+      EngineOptions single;
+      single.single_precision = true;
+      single.distance_error = &error;
+      single.anisotropy.angle = 20.0;
+      single.anisotropy.ratio = 0.8;
+      options.anisotropy = single.anisotropy;
+
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, options );
+      std::vector<Boomerang> B = Engine( x, y, z, 30.0, single );
+
+      bool flag = true;
+
+      flag &= CHECK( error >= 0.0 && error < 1e-4 );
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].cnt == B[k].cnt );
+         flag &= CHECK( fabs( A[k].zhat - B[k].zhat ) < 1e-3 );
+         flag &= CHECK( fabs( A[k].zeta - B[k].zeta ) < 1e-3 );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestMemoryPolicies
+   //
+   //    Huge pages and pinned threads must not change the results.
+   //--------------------------------------------------------------------------
+   bool TestMemoryPolicies()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<70; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+
+      EngineOptions options;
+      std::vector<Boomerang> A = Engine( x, y, z, 20.0, options );
+
+      bool flag = true;
+
+      const PagePolicy     pages[]    = { PAGES_TRANSPARENT, PAGES_EXPLICIT };
+      const AffinityPolicy affinity[] = { AFFINITY_COMPACT, AFFINITY_SCATTER };
+      for( int p=0; p<2; ++p )
+      {
+         EngineOptions pinned;
+         pinned.threads  = 3;
+         pinned.pages    = pages[p];
+         pinned.affinity = affinity[p];
+         std::vector<Boomerang> B = Engine( x, y, z, 20.0, pinned );
+
+         for( unsigned k=0; k<A.size(); ++k )
+            flag &= CHECK( A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestPreparedEngine
+   //
+   //    A prepared BoomerangEngine, run for several values and radii, must
+   //    match the Engine; with and without duplicates and neighbor lists.
+   //--------------------------------------------------------------------------
+   bool TestPreparedEngine()
+   {
+      std::vector<double> x, y, z1, z2;
+      for( int i=0; i<70; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z1.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+         z2.push_back( 20.0 - 0.2*y.back() + 3.0*cos(0.3*i) );
+      }
+      x[7] = x[3];
+      y[7] = y[3];
+
+      bool flag = true;
+
+      const double radii[] = { 10.0, 25.0 };
+      const DuplicatePolicy policies[] = { DUPLICATES_AVERAGE, DUPLICATES_GROUP };
+      for( int p=0; p<2; ++p )
+      {
+         EngineOptions options;
+         options.duplicates = policies[p];
+
+         BoomerangEngine engine;
+         engine.Prepare( x, y, options, ( p == 0 ? 0.0 : 30.0 ) );
+         flag &= CHECK( engine.IsPrepared() && engine.size() == 70 );
+
+         for( int r=0; r<2; ++r )
+         {
+            for( int v=0; v<2; ++v )
+            {
+               const std::vector<double>& z = ( v == 0 ? z1 : z2 );
+               std::vector<Boomerang> A = Engine( x, y, z, radii[r], options );
+               std::vector<Boomerang> B = engine.Run( z, radii[r], options );
+
+               for( unsigned k=0; k<A.size(); ++k )
+                  flag &= CHECK( A[k].cnt == B[k].cnt && A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta );
+            }
+         }
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // Locations
+   //
+   //    The number of distinct estimates; co-located observations share
+   //    one.
+   //--------------------------------------------------------------------------
+   int Locations( const std::vector<Boomerang>& results )
+   {
+      std::vector<double> zhat;
+      for( auto& r : results )
+         zhat.push_back( r.zhat );
+      std::sort( zhat.begin(), zhat.end() );
+      return std::unique( zhat.begin(), zhat.end() ) - zhat.begin();
+   }
+
+   //--------------------------------------------------------------------------
+   // TestDuplicateTolerance
+   //
+   //    The duplicate tolerance is a separation distance as the Engine
+   //    measures it: a neighbor 0.8 away along the minor axis, with
+   //    ratio = 0.5, is 1.6 away and not a duplicate at tolerance 1; one
+   //    0.8 away along the major axis is.  For geographic data the
+   //    tolerance is in kilometers, not degrees.
+   //--------------------------------------------------------------------------
+   bool TestDuplicateTolerance()
+   {
+      bool flag = true;
+
+      std::vector<double> x, y, z;
+      TestData( 70, 0, x, y, z );
+
+      EngineOptions options;
+      options.anisotropy.ratio = 0.5;
+      options.duplicate_tolerance = 1.0;
+
+      for( int axis=0; axis<2; ++axis )
+      {
+         std::vector<double> xx( x ), yy( y ), zz( z );
+         xx.push_back( x[3] + ( axis == 0 ? 0.8 : 0.0 ) );
+         yy.push_back( y[3] + ( axis == 0 ? 0.0 : 0.8 ) );
+         zz.push_back( z[3] + 1.0 );
+
+         std::vector<Boomerang> results = Engine( xx, yy, zz, 25.0, options );
+         flag &= CHECK( Locations( results ) == ( axis == 0 ? 70 : 71 ) );
+      }
+
+      // About 0.4 km apart at latitude 45; the whole set spans a degree.
+      std::vector<double> lon, lat;
+      for( int i=0; i<70; ++i )
+      {
+         lon.push_back( -93.0 + 0.5*sin(1.3*i) );
+         lat.push_back(  45.0 + 0.5*cos(2.1*i) );
+      }
+      lon.push_back( lon[3] + 0.005 );
+      lat.push_back( lat[3] );
+      z.push_back( z[3] + 1.0 );
+
+      EngineOptions geographic;
+      geographic.geographic = true;
+      geographic.duplicate_tolerance = 1.0;
+
+      std::vector<Boomerang> results = Engine( lon, lat, z, 10.0, geographic );
+      flag &= CHECK( Locations( results ) == 70 );
+
+      geographic.duplicate_tolerance = 0.1;
+      results = Engine( lon, lat, z, 10.0, geographic );
+      flag &= CHECK( Locations( results ) == 71 );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestAsync
+   //
+   //    The asynchronous Engine must match the Engine, and count all of the
+   //    observations.  A cancel before the start skips every observation.
+   //--------------------------------------------------------------------------
+   bool TestAsync()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<70; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+
+      EngineOptions options;
+      options.threads = 2;
+      std::vector<Boomerang> A = Engine( x, y, z, 20.0, options );
+
+      bool flag = true;
+
+      // Run twice, reusing the pooled threads.
+      for( int pass=0; pass<2; ++pass )
+      {
+         EngineJob job = EngineAsync( x, y, z, 20.0, options );
+         flag &= CHECK( job.Valid() );
+
+         std::vector<Boomerang> B = job.Get();
+         flag &= CHECK( job.Ready() );
+         flag &= CHECK( job.Completed() == 70 && job.Total() == 70 );
+         flag &= CHECK( job.SecondsRemaining() == 0.0 );
+         flag &= CHECK( !job.Cancelled() );
+
+         for( unsigned k=0; k<A.size(); ++k )
+            flag &= CHECK( A[k].zhat == B[k].zhat && A[k].zeta == B[k].zeta );
+      }
+
+      // Cancelled before the start.
+      EngineProgress progress;
+      progress.cancel = true;
+      options.progress = &progress;
+
+      std::vector<Boomerang> C = Engine( x, y, z, 20.0, options );
+      flag &= CHECK( progress.completed == 0 && progress.total == 70 );
+      for( unsigned k=0; k<C.size(); ++k )
+         flag &= CHECK( C[k].cnt == 0 && std::isnan( C[k].zhat ) );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestSimulatedNull
+   //
+   //    The empirical p-values must be valid probabilities, and must not
+   //    depend upon the number of threads.
+   //--------------------------------------------------------------------------
+   bool TestSimulatedNull()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<60; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+
+      EngineOptions one;
+      one.threads = 1;
+      one.simulations = 99;
+
+      EngineOptions many = one;
+      many.threads = 3;
+
+      std::vector<Boomerang> A = Engine( x, y, z, 10.0, one );
+      std::vector<Boomerang> B = Engine( x, y, z, 10.0, many );
+
+      bool flag = true;
+
+      for( unsigned k=0; k<A.size(); ++k )
+      {
+         flag &= CHECK( A[k].pvalue_mc > 0.0 && A[k].pvalue_mc <= 1.0 );
+         flag &= CHECK( A[k].pvalue_mc == B[k].pvalue_mc );
+         flag &= CHECK( A[k].zhat == B[k].zhat );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestNeighborLists
+   //
+   //    The pre-sorted neighbor lists must give exactly the same results as
+   //    scanning the distance matrix, for any radius up to their maximum.
+   //--------------------------------------------------------------------------
+   bool TestNeighborLists()
+   {
+      std::vector<double> x, y, z;
+      for( int i=0; i<80; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+
+      NeighborLists neighbors( x, y, 60.0, 2 );
+
+      EngineOptions scan;
+      EngineOptions lists;
+      lists.neighbors = &neighbors;
+
+      bool flag = true;
+
+      const double radii[] = { 5.0, 25.0, 60.0 };
+      for( double radius : radii )
+      {
+         std::vector<Boomerang> A = Engine( x, y, z, radius, scan );
+         std::vector<Boomerang> B = Engine( x, y, z, radius, lists );
+
+         for( unsigned k=0; k<A.size(); ++k )
+         {
+            flag &= CHECK( A[k].cnt == B[k].cnt );
+            flag &= CHECK( A[k].zhat == B[k].zhat );
+            flag &= CHECK( A[k].zeta == B[k].zeta );
+         }
+      }
+
+      return flag;
+   }
 }
 
 
@@ -110,6 +755,18 @@ std::pair<int,int> test_Engine()
    int nfail = 0;
 
    TALLY( TestEngine() );
+   TALLY( TestGridEngine() );
+   TALLY( TestVariogramModels() );
+   TALLY( TestAnisotropy() );
+   TALLY( TestVolumetric() );
+   TALLY( TestGeographic() );
+   TALLY( TestSinglePrecision() );
+   TALLY( TestMemoryPolicies() );
+   TALLY( TestPreparedEngine() );
+   TALLY( TestDuplicateTolerance() );
+   TALLY( TestAsync() );
+   TALLY( TestSimulatedNull() );
+   TALLY( TestNeighborLists() );
 
    return std::make_pair( nsucc, nfail );
 }
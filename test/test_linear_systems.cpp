@@ -79,6 +79,25 @@ namespace{
       return CHECK( isClose(X, C, TOLERANCE) );
    }
 
+   //--------------------------------------------------------------------------
+   // TestConjugateGradientSolve
+   //--------------------------------------------------------------------------
+   bool TestConjugateGradientSolve()
+   {
+      Matrix A("4,6,4,4; 6,10,9,7; 4,9,17,11; 4,7,11,18");
+      Matrix B("44; 81; 117; 123");
+      Matrix X;
+      bool converged = ConjugateGradientSolve( [&A](const Matrix& p, Matrix& Ap){ Multiply_MM(A,p,Ap); }, B, X, 1e-14, 100 );
+      Matrix Z("1;2;3;4");
+
+      bool flag = true;
+
+      flag &= CHECK( converged );
+      flag &= CHECK( isClose(X, Z, TOLERANCE) );
+
+      return flag;
+   }
+
    //--------------------------------------------------------------------------
    // TestAffineTransformation
    //--------------------------------------------------------------------------
@@ -108,6 +127,7 @@ std::pair<int,int> test_LinearSystems()
    TALLY( TestCholeskySolve() );
    TALLY( TestRSPDInv() );
    TALLY( TestLeastSquaresSolve() );
+   TALLY( TestConjugateGradientSolve() );
    TALLY( TestAffineTransformation() );
 
    return std::make_pair( nsucc, nfail );
@@ -11,10 +11,23 @@
 //=============================================================================
 #include <iostream>
 
+#include "test_aakozi.h"
+#include "test_bit_mask.h"
+#include "test_checkpoint.h"
+#include "test_cross_validation.h"
+#include "test_distance_cache.h"
+#include "test_duplicates.h"
 #include "test_engine.h"
 #include "test_linear_systems.h"
 #include "test_matrix.h"
+#include "test_parallel.h"
+#include "test_planner.h"
+#include "test_prediction.h"
+#include "test_random_stream.h"
+#include "test_shard.h"
 #include "test_special_functions.h"
+#include "test_unix_socket.h"
+#include "test_variogram.h"
 
 //-----------------------------------------------------------------------------
 //
@@ -26,6 +39,30 @@ int main()
 
    std::pair<int,int> counts;
 
+   counts = test_Aakozi();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_BitMask();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Checkpoint();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_CrossValidation();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_DistanceCache();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Duplicates();
+   nsucc += counts.first;
+   nfail += counts.second;
+
    counts = test_Engine();
    nsucc += counts.first;
    nfail += counts.second;
@@ -38,10 +75,38 @@ int main()
    nsucc += counts.first;
    nfail += counts.second;
 
+   counts = test_Parallel();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Planner();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Prediction();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_RandomStream();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Shard();
+   nsucc += counts.first;
+   nfail += counts.second;
+
    counts = test_SpecialFunctions();
    nsucc += counts.first;
    nfail += counts.second;
 
+   counts = test_UnixSocket();
+   nsucc += counts.first;
+   nfail += counts.second;
+
+   counts = test_Variogram();
+   nsucc += counts.first;
+   nfail += counts.second;
+
    if(nfail > 0)
    {
       std::cerr << "AAKOZI TESTS: nsucc = " << nsucc << '\t' << "nfail = " << nfail << std::endl;
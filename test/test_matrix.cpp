@@ -368,6 +368,26 @@ namespace{
       return CHECK( isClose(B, C, TOLERANCE) );
    }
 
+   //--------------------------------------------------------------------------
+   // TestMatrixSliceMask
+   //--------------------------------------------------------------------------
+   bool TestMatrixSliceMask()
+   {
+      Matrix A("1,2,3,4;5,6,7,8;9,10,11,12");
+      Matrix B;
+
+      BitMask col_mask(4), row_mask(3);
+      col_mask.Set(0);
+      col_mask.Set(2);
+      row_mask.Set(0);
+      row_mask.Set(2);
+
+      Slice( A, row_mask, col_mask, B );
+      Matrix C("1,3;9,11");
+
+      return CHECK( isClose(B, C, TOLERANCE) );
+   }
+
    //--------------------------------------------------------------------------
    // TestMatrixAdd_aM
    //--------------------------------------------------------------------------
@@ -658,6 +678,7 @@ std::pair<int,int> test_Matrix()
    TALLY( TestMatrixNegative() );
    TALLY( TestMatrixIdentity() );
    TALLY( TestMatrixSlice() );
+   TALLY( TestMatrixSliceMask() );
    TALLY( TestMatrixAdd_aM() );
    TALLY( TestMatrixSubtract_aM() );
    TALLY( TestMatrixMultiply_aM() );
@@ -0,0 +1,128 @@
+//=============================================================================
+// test_parallel.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_parallel.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\parallel.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const int NCPU = 8;
+
+   //--------------------------------------------------------------------------
+   // TestLoops
+   //
+   //    ParallelFor runs every iteration once; ParallelRun runs the body
+   //    once on each thread.
+   //--------------------------------------------------------------------------
+   bool TestLoops()
+   {
+      std::vector< std::atomic<int> > count( 100 );
+      for( auto& c : count )
+         c = 0;
+
+      ParallelFor( 100, 3, [&]( int k, int ){ ++count[k]; } );
+
+      bool flag = true;
+      for( auto& c : count )
+         flag &= CHECK( c == 1 );
+
+      std::vector< std::atomic<int> > runs( 3 );
+      for( auto& r : runs )
+         r = 0;
+
+      ParallelRun( 3, [&]( int thread ){ ++runs[thread]; } );
+      for( auto& r : runs )
+         flag &= CHECK( r == 1 );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestProcessors
+   //
+   //    The threads of one loop get distinct processors, and none without
+   //    an affinity policy.
+   //--------------------------------------------------------------------------
+   bool TestProcessors()
+   {
+      bool flag = true;
+      for( int t=0; t<4; ++t )
+      {
+         flag &= CHECK( Processor( t, 4, AFFINITY_NONE, NCPU ) == -1 );
+         flag &= CHECK( Processor( t, 4, AFFINITY_COMPACT, NCPU ) == t );
+         flag &= CHECK( Processor( t, 4, AFFINITY_SCATTER, NCPU ) == 2*t );
+      }
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestPackedJobs
+   //
+   //    Jobs of one thread each, running side by side on the threads of an
+   //    outer loop as the batch subcommand packs them, must not share a
+   //    processor.  Without the share, each would pin its thread 0 to
+   //    processor 0.
+   //--------------------------------------------------------------------------
+   bool TestPackedJobs()
+   {
+      const int T = 4;
+      bool flag = true;
+
+      const AffinityPolicy policies[] = { AFFINITY_COMPACT, AFFINITY_SCATTER };
+      for( AffinityPolicy affinity : policies )
+      {
+         std::vector<int> cpu( T, -1 );
+         ParallelRun( T, [&]( int thread )
+         {
+            ProcessorShare share( thread, T );
+            cpu[thread] = Processor( 0, 1, affinity, NCPU );
+         });
+
+         for( int i=0; i<T; ++i )
+            for( int j=i+1; j<T; ++j )
+               flag &= CHECK( cpu[i] != cpu[j] );
+      }
+
+      // The share ends with its scope.
+      flag &= CHECK( Processor( 0, 1, AFFINITY_COMPACT, NCPU ) == 0 );
+      {
+         ProcessorShare share( 3, 4 );
+         flag &= CHECK( Processor( 0, 1, AFFINITY_COMPACT, NCPU ) == 3 );
+      }
+      flag &= CHECK( Processor( 0, 1, AFFINITY_COMPACT, NCPU ) == 0 );
+
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Parallel
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Parallel()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestLoops() );
+   TALLY( TestProcessors() );
+   TALLY( TestPackedJobs() );
+
+   return std::make_pair( nsucc, nfail );
+}
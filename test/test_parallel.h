@@ -0,0 +1,21 @@
+//=============================================================================
+// test_parallel.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_PARALLEL_H
+#define TEST_PARALLEL_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Parallel();
+
+//=============================================================================
+#endif  // TEST_PARALLEL_H
@@ -0,0 +1,127 @@
+//=============================================================================
+// test_planner.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_planner.h"
+
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\engine.h"
+#include "..\src\planner.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   //--------------------------------------------------------------------------
+   // TestScattered
+   //
+   //    Scattered data: dense when it fits, single precision when only that
+   //    fits, and the smallest plan when nothing fits.
+   //--------------------------------------------------------------------------
+   bool TestScattered()
+   {
+      std::vector<double> x, y;
+      for( int i=0; i<200; ++i )
+      {
+         x.push_back( 100.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 100.0*cos(2.1*i) - 2.0*i );
+      }
+
+      EngineOptions options;
+      options.threads = 2;
+
+      bool flag = true;
+
+      Plan plan;
+      MakePlan( x, y, nullptr, 20.0, options, 0.0, true, plan );
+      flag &= CHECK( plan.N == 200 && plan.buffer >= 1.0 );
+      flag &= CHECK( plan.estimates[plan.chosen].strategy == STRATEGY_DENSE );
+      flag &= CHECK( plan.estimates[STRATEGY_SINGLE].viable );
+      flag &= CHECK( !plan.estimates[STRATEGY_GRID].viable );
+      flag &= CHECK( plan.estimates[STRATEGY_SINGLE].bytes < plan.estimates[STRATEGY_DENSE].bytes );
+
+      const double dense  = plan.estimates[STRATEGY_DENSE].bytes;
+      const double single = plan.estimates[STRATEGY_SINGLE].bytes;
+
+      MakePlan( x, y, nullptr, 20.0, options, 0.5*(dense + single), true, plan );
+      flag &= CHECK( plan.estimates[plan.chosen].strategy == STRATEGY_SINGLE );
+
+      ApplyPlan( plan, options );
+      flag &= CHECK( options.single_precision && options.grid_mode == GRID_OFF );
+
+      MakePlan( x, y, nullptr, 20.0, options, 0.5*single, true, plan );
+      flag &= CHECK( plan.estimates[plan.chosen].strategy == STRATEGY_SINGLE );
+      flag &= CHECK( !plan.estimates[plan.chosen].feasible );
+
+      // The options select the strategy.
+      EngineOptions forced;
+      forced.single_precision = true;
+      MakePlan( x, y, nullptr, 20.0, forced, 0.0, false, plan );
+      flag &= CHECK( plan.forced && plan.estimates[plan.chosen].strategy == STRATEGY_SINGLE );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestGridded
+   //
+   //    A large regular grid with a small buffer favors the FFT solver;
+   //    3-D data never use it.
+   //--------------------------------------------------------------------------
+   bool TestGridded()
+   {
+      std::vector<double> x, y, elev;
+      for( int i=0; i<40; ++i )
+      {
+         for( int j=0; j<40; ++j )
+         {
+            x.push_back( 10.0*j );
+            y.push_back( 10.0*i );
+            elev.push_back( 0.0 );
+         }
+      }
+
+      EngineOptions options;
+
+      bool flag = true;
+
+      Plan plan;
+      MakePlan( x, y, nullptr, 15.0, options, 0.0, true, plan );
+      flag &= CHECK( plan.estimates[STRATEGY_GRID].viable );
+      flag &= CHECK( plan.estimates[plan.chosen].strategy == STRATEGY_GRID );
+      flag &= CHECK( plan.buffer > 4.0 && plan.buffer <= 9.0 );
+
+      ApplyPlan( plan, options );
+      flag &= CHECK( options.grid_mode == GRID_ON && !options.single_precision );
+
+      MakePlan( x, y, &elev, 15.0, EngineOptions(), 0.0, true, plan );
+      flag &= CHECK( !plan.estimates[STRATEGY_GRID].viable && !plan.estimates[STRATEGY_SINGLE].viable );
+      flag &= CHECK( plan.estimates[plan.chosen].strategy == STRATEGY_DENSE );
+
+      return flag;
+   }
+}
+
+//-----------------------------------------------------------------------------
+// test_Planner
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Planner()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestScattered() );
+   TALLY( TestGridded() );
+
+   return std::make_pair( nsucc, nfail );
+}
@@ -0,0 +1,21 @@
+//=============================================================================
+// test_planner.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_PLANNER_H
+#define TEST_PLANNER_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Planner();
+
+//=============================================================================
+#endif  // TEST_PLANNER_H
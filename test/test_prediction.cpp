@@ -0,0 +1,207 @@
+//=============================================================================
+// test_prediction.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_prediction.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\linear_systems.h"
+#include "..\src\matrix.h"
+#include "..\src\prediction.h"
+#include "..\src\variogram_models.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const double TOLERANCE = 1e-6;
+
+   //--------------------------------------------------------------------------
+   // Example data: scattered, with observations on a few cell centers.
+   //--------------------------------------------------------------------------
+   void ExampleData( std::vector<double>& x, std::vector<double>& y, std::vector<double>& z )
+   {
+      for( int i=0; i<40; ++i )
+      {
+         x.push_back( 100.0 + 80.0*sin(1.3*i) );
+         y.push_back( 100.0 + 80.0*cos(2.1*i) );
+         z.push_back( 50.0 + 0.1*x.back() + 5.0*sin(0.7*i) );
+      }
+
+      x.push_back( 50.0 );   y.push_back( 60.0 );   z.push_back( 61.0 );
+      x.push_back( 150.0 );  y.push_back( 130.0 );  z.push_back( 59.0 );
+   }
+
+   //--------------------------------------------------------------------------
+   // TestKrigeGridAtData
+   //
+   //    Kriging is an exact interpolator: at an observation the kriged value
+   //    is the observed value, and the kriging variance is zero.
+   //--------------------------------------------------------------------------
+   bool TestKrigeGridAtData()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( x, y, z );
+
+      TargetGrid grid = { 20, 20, 0.0, 0.0, 10.0 };
+      std::vector<double> zhat, variance;
+      double slope = 0.0;
+
+      bool flag = true;
+
+      flag &= CHECK( KrigeGrid( x, y, z, grid, 2, slope, zhat, variance ) );
+      flag &= CHECK( slope > 0.0 );
+
+      // (50,60) is column 5, row 20-1-6 = 13 from the top.
+      flag &= CHECK( isClose( zhat[13*20 + 5], 61.0, TOLERANCE ) );
+      flag &= CHECK( isClose( variance[13*20 + 5], 0.0, TOLERANCE ) );
+
+      // (150,130) is column 15, row 20-1-13 = 6 from the top.
+      flag &= CHECK( isClose( zhat[6*20 + 15], 59.0, TOLERANCE ) );
+      flag &= CHECK( isClose( variance[6*20 + 15], 0.0, TOLERANCE ) );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestKrigeGridBlocks
+   //
+   //    Solving many targets as blocks of right-hand sides must give the same
+   //    answer as solving each target by itself.
+   //--------------------------------------------------------------------------
+   bool TestKrigeGridBlocks()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( x, y, z );
+
+      TargetGrid grid = { 20, 20, 0.0, 0.0, 10.0 };
+      std::vector<double> zhat, variance;
+      double slope = 2.0;
+      KrigeGrid( x, y, z, grid, 3, slope, zhat, variance );
+
+      bool flag = true;
+
+      const int cells[] = { 0, 7, 255, 256, 311, 399 };
+      for( int t : cells )
+      {
+         TargetGrid one = { 1, 1, grid.xll + (t%20)*grid.cellsize, grid.yll + (19 - t/20)*grid.cellsize, 1.0 };
+         std::vector<double> zhat1, variance1;
+         double slope1 = 2.0;
+         KrigeGrid( x, y, z, one, 1, slope1, zhat1, variance1 );
+
+         flag &= CHECK( isClose( zhat[t], zhat1[0], TOLERANCE ) );
+         flag &= CHECK( isClose( variance[t], variance1[0], TOLERANCE ) );
+      }
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // DirectKrige
+   //
+   //    Krige the target (xt,yt) by solving the bordered Ordinary Kriging
+   //    system [G 1; 1' 0][w; mu] = [g; 1] in the variogram itself.
+   //--------------------------------------------------------------------------
+   template<class Variogram>
+   void DirectKrige( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, const Variogram& model, double scale, double xt, double yt, double& zhat, double& variance )
+   {
+      const int N = x.size();
+
+      Matrix K(N+1, N+1, 0.0), b(N+1, 1, 1.0), w;
+      for( int i=0; i<N; ++i )
+      {
+         for( int j=0; j<N; ++j )
+            K(i,j) = model( hypot( x[i]-x[j], y[i]-y[j] ) );
+         K(i,N) = 1.0;
+         K(N,i) = 1.0;
+         b(i,0) = model( hypot( x[i]-xt, y[i]-yt ) );
+      }
+      LeastSquaresSolve( K, b, w );
+
+      zhat = 0.0;
+      variance = w(N,0);
+      for( int i=0; i<N; ++i )
+      {
+         zhat += w(i,0) * z[i];
+         variance += w(i,0) * b(i,0);
+      }
+      variance *= scale;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestKrigeGridModels
+   //
+   //    With a bounded model and a nugget, the grid must be the direct
+   //    solution in that model, not in the linear one.
+   //--------------------------------------------------------------------------
+   bool TestKrigeGridModels()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( x, y, z );
+
+      TargetGrid grid = { 20, 20, 0.0, 0.0, 10.0 };
+      const SphericalVariogram spherical( 60.0, 0.1 );
+      const PowerVariogram power( 1.5, 0.2 );
+
+      std::vector<double> zhat, variance, zhat_s, variance_s, zhat_p, variance_p;
+      double slope = 2.0;
+      double sill  = 2.0;
+      double scale = 2.0;
+
+      bool flag = true;
+
+      flag &= CHECK( KrigeGrid( x, y, z, grid, 2, slope, zhat, variance ) );
+      flag &= CHECK( KrigeGrid( x, y, z, grid, 2, spherical, sill, zhat_s, variance_s ) );
+      flag &= CHECK( KrigeGrid( x, y, z, grid, 2, power, scale, zhat_p, variance_p ) );
+
+      const int cells[] = { 0, 7, 255, 311, 399 };
+      for( int t : cells )
+      {
+         const double xt = grid.xll + (t%20)*grid.cellsize;
+         const double yt = grid.yll + (19 - t/20)*grid.cellsize;
+         double zd, vd;
+
+         DirectKrige( x, y, z, spherical, sill, xt, yt, zd, vd );
+         flag &= CHECK( isClose( zhat_s[t], zd, TOLERANCE ) );
+         flag &= CHECK( isClose( variance_s[t], vd, TOLERANCE ) );
+         flag &= CHECK( fabs( zhat_s[t] - zhat[t] ) > 1e-3 );
+
+         DirectKrige( x, y, z, power, scale, xt, yt, zd, vd );
+         flag &= CHECK( isClose( zhat_p[t], zd, TOLERANCE ) );
+         flag &= CHECK( isClose( variance_p[t], vd, TOLERANCE ) );
+      }
+
+      // The nugget does not spoil the exact interpolation at the data.
+      flag &= CHECK( isClose( zhat_s[13*20 + 5], 61.0, TOLERANCE ) );
+      flag &= CHECK( isClose( variance_s[13*20 + 5], 0.0, TOLERANCE ) );
+
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Prediction
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Prediction()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestKrigeGridAtData() );
+   TALLY( TestKrigeGridBlocks() );
+   TALLY( TestKrigeGridModels() );
+
+   return std::make_pair( nsucc, nfail );
+}
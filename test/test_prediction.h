@@ -0,0 +1,21 @@
+//=============================================================================
+// test_prediction.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_PREDICTION_H
+#define TEST_PREDICTION_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Prediction();
+
+//=============================================================================
+#endif  // TEST_PREDICTION_H
@@ -0,0 +1,118 @@
+//=============================================================================
+// test_random_stream.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_random_stream.h"
+
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\random_stream.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const int SAMPLES = 100001;      // deliberately not a multiple of the lanes
+
+   //--------------------------------------------------------------------------
+   // TestUniform
+   //--------------------------------------------------------------------------
+   bool TestUniform()
+   {
+      std::vector<double> u(SAMPLES);
+      RandomStream stream(1);
+      stream.Uniform( u.data(), SAMPLES );
+
+      double sum = 0.0;
+      double sum2 = 0.0;
+      bool inside = true;
+      for( double v : u )
+      {
+         inside &= ( v > 0.0 && v < 1.0 );
+         sum  += v;
+         sum2 += v*v;
+      }
+      double mean = sum/SAMPLES;
+      double var  = sum2/SAMPLES - mean*mean;
+
+      bool flag = true;
+
+      flag &= CHECK( inside );
+      flag &= CHECK( isClose(mean, 0.5, 0.01) );
+      flag &= CHECK( isClose(var, 1.0/12.0, 0.01) );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestGaussian
+   //--------------------------------------------------------------------------
+   bool TestGaussian()
+   {
+      std::vector<double> g(SAMPLES);
+      RandomStream stream(2);
+      stream.Gaussian( g.data(), SAMPLES );
+
+      double sum = 0.0;
+      double sum2 = 0.0;
+      for( double v : g )
+      {
+         sum  += v;
+         sum2 += v*v;
+      }
+      double mean = sum/SAMPLES;
+      double var  = sum2/SAMPLES - mean*mean;
+
+      bool flag = true;
+
+      flag &= CHECK( isClose(mean, 0.0, 0.02) );
+      flag &= CHECK( isClose(var, 1.0, 0.02) );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestRepeatable
+   //--------------------------------------------------------------------------
+   bool TestRepeatable()
+   {
+      std::vector<double> a(1000), b(1000), c(1000);
+
+      RandomStream s1(7), s2(7), s3(8);
+      s1.Gaussian( a.data(), 1000 );
+      s2.Gaussian( b.data(), 1000 );
+      s3.Gaussian( c.data(), 1000 );
+
+      bool flag = true;
+
+      flag &= CHECK( a == b );
+      flag &= CHECK( a != c );
+
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_RandomStream
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_RandomStream()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestUniform() );
+   TALLY( TestGaussian() );
+   TALLY( TestRepeatable() );
+
+   return std::make_pair( nsucc, nfail );
+}
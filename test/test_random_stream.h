@@ -0,0 +1,21 @@
+//=============================================================================
+// test_random_stream.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_RANDOM_STREAM_H
+#define TEST_RANDOM_STREAM_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_RandomStream();
+
+//=============================================================================
+#endif  // TEST_RANDOM_STREAM_H
@@ -0,0 +1,214 @@
+//=============================================================================
+// test_shard.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_shard.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "test_data.h"
+#include "unit_test.h"
+#include "..\src\engine.h"
+#include "..\src\shard.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const double TOLERANCE = 1e-9;
+
+   //--------------------------------------------------------------------------
+   // TestAssignShards
+   //
+   //    Every location is in one shard, and the shards differ in size by
+   //    at most one.  The left and right halves of the region are shared.
+   //--------------------------------------------------------------------------
+   bool TestAssignShards()
+   {
+      std::vector<double> x, y, z;
+      TestData( 90, 0, x, y, z );
+
+      std::vector<int> shard;
+      AssignShards( x, y, 4, shard );
+
+      const double xmid = 0.5*( *std::min_element(x.begin(), x.end()) + *std::max_element(x.begin(), x.end()) );
+
+      std::vector<int> size(4, 0), left(4, 0);
+      bool valid = ( shard.size() == x.size() );
+      for( size_t i=0; i<shard.size(); ++i )
+      {
+         valid &= ( 0 <= shard[i] && shard[i] < 4 );
+         if( valid )
+         {
+            ++size[ shard[i] ];
+            left[ shard[i] ] += ( x[i] < xmid );
+         }
+      }
+
+      bool flag = true;
+      flag &= CHECK( valid );
+      flag &= CHECK( *std::max_element(size.begin(), size.end()) - *std::min_element(size.begin(), size.end()) <= 1 );
+      for( int s=0; s<4; ++s )
+         flag &= CHECK( left[s] > 0 && left[s] < size[s] );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestMerge
+   //
+   //    Three shards, merged with the summed partial sums, give the results
+   //    of the unsharded Engine.
+   //--------------------------------------------------------------------------
+   bool TestMerge()
+   {
+      std::vector<double> x, y, z;
+      TestData( 90, 0, x, y, z );
+
+      XiSums whole;
+      EngineOptions options;
+      options.xi_sums = &whole;
+      std::vector<Boomerang> A = Engine( x, y, z, 30.0, options );
+
+      const int N = x.size();
+      std::vector<Boomerang> B( N );
+      std::vector<int> owners( N, 0 );
+      XiSums total;
+
+      for( int s=0; s<3; ++s )
+      {
+         XiSums part;
+         EngineOptions shard = options;
+         shard.shard   = s;
+         shard.nshards = 3;
+         shard.xi_sums = &part;
+
+         std::vector<Boomerang> S = Engine( x, y, z, 30.0, shard );
+         for( int k=0; k<N; ++k )
+         {
+            if( S[k].cnt > 0 )
+            {
+               B[k] = S[k];
+               ++owners[k];
+            }
+         }
+         total.sum   += part.sum;
+         total.count += part.count;
+      }
+      NormalizeXi( total, B );
+
+      bool flag = true;
+      flag &= CHECK( total.count == whole.count );
+      flag &= CHECK( isClose( total.sum, whole.sum, TOLERANCE ) );
+
+      bool same = true;
+      for( int k=0; k<N; ++k )
+      {
+         same &= ( owners[k] == 1 );
+         same &= ( B[k].cnt == A[k].cnt && B[k].zhat == A[k].zhat );
+         same &= isClose( B[k].zeta, A[k].zeta, TOLERANCE );
+         same &= isClose( B[k].pvalue, A[k].pvalue, TOLERANCE );
+      }
+      flag &= CHECK( same );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestRunKey
+   //
+   //    Two shard sets of the same data that differ only in the radius.
+   //    The headers read back as written, the shards of one set belong
+   //    together, and no shard of one set may be merged with the other.
+   //--------------------------------------------------------------------------
+   bool TestRunKey()
+   {
+      std::vector<double> x, y, z, elev;
+      TestData( 90, 0, x, y, z );
+
+      const double radii[] = { 30.0, 40.0 };
+      std::vector<ShardHeader> sets[2];
+
+      bool flag = true;
+      for( int r=0; r<2; ++r )
+      {
+         for( int s=0; s<3; ++s )
+         {
+            XiSums part;
+            EngineOptions options;
+            options.shard   = s;
+            options.nshards = 3;
+            options.xi_sums = &part;
+            Engine( x, y, z, radii[r], options );
+
+            ShardHeader header;
+            header.shard   = s+1;
+            header.nshards = 3;
+            header.N       = x.size();
+            header.data    = DataHash( x, y, elev, z );
+            header.key     = RunKey( header.data, radii[r], options, 0, 0.0, 1.0, 0.0 );
+            header.sums    = part;
+
+            std::ostringstream os;
+            WriteShardHeader( os, header );
+
+            ShardHeader back;
+            flag &= CHECK( ReadShardHeader( os.str(), back ) );
+            flag &= CHECK( back.shard == header.shard && back.data == header.data && back.key == header.key );
+            flag &= CHECK( back.sums.sum == header.sums.sum && back.sums.count == header.sums.count );
+            sets[r].push_back( back );
+         }
+      }
+
+      for( int i=0; i<3; ++i )
+      {
+         for( int j=0; j<3; ++j )
+         {
+            flag &= CHECK( SameRun( sets[0][i], sets[0][j] ) && SameRun( sets[1][i], sets[1][j] ) );
+            flag &= CHECK( !SameRun( sets[0][i], sets[1][j] ) );
+         }
+         flag &= CHECK( sets[0][i].data == sets[1][i].data );
+      }
+
+      // Other data, or another model, make another run.
+      std::vector<double> z2( z );
+      z2[5] += 1.0;
+      flag &= CHECK( DataHash( x, y, elev, z2 ) != sets[0][0].data );
+
+      EngineOptions options;
+      flag &= CHECK( RunKey( sets[0][0].data, 30.0, options, 0, 0.0, 1.0, 0.0 ) == sets[0][0].key );
+      flag &= CHECK( RunKey( sets[0][0].data, 30.0, options, 3, 150.0, 1.0, 0.0 ) != sets[0][0].key );
+      options.duplicate_tolerance = 0.5;
+      flag &= CHECK( RunKey( sets[0][0].data, 30.0, options, 0, 0.0, 1.0, 0.0 ) != sets[0][0].key );
+
+      flag &= CHECK( !ReadShardHeader( "AAKOZI-SHARD 1 3 90 1.0 2", sets[0][0] ) );
+      return flag;
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Shard
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Shard()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestAssignShards() );
+   TALLY( TestMerge() );
+   TALLY( TestRunKey() );
+
+   return std::make_pair( nsucc, nfail );
+}
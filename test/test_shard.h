@@ -0,0 +1,21 @@
+//=============================================================================
+// test_shard.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_SHARD_H
+#define TEST_SHARD_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Shard();
+
+//=============================================================================
+#endif  // TEST_SHARD_H
@@ -0,0 +1,186 @@
+//=============================================================================
+// test_unix_socket.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_unix_socket.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include "unit_test.h"
+#include "..\src\unix_socket.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define TEST_UNIX_SOCKET
+#endif
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+#ifdef TEST_UNIX_SOCKET
+   const char* PATH = "aakozi_test.sock";
+
+   //--------------------------------------------------------------------------
+   // Connect
+   //
+   //    A client socket connected to PATH, or -1, retrying while the server
+   //    starts.
+   //--------------------------------------------------------------------------
+   int Connect()
+   {
+      sockaddr_un address;
+      memset( &address, 0, sizeof(address) );
+      address.sun_family = AF_UNIX;
+      strncpy( address.sun_path, PATH, sizeof(address.sun_path) - 1 );
+
+      for( int attempt=0; attempt<100; ++attempt )
+      {
+         int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+         if( connect( fd, reinterpret_cast<sockaddr*>(&address), sizeof(address) ) == 0 )
+            return fd;
+         close( fd );
+         std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+      }
+      return -1;
+   }
+
+   std::string ReadAll( int fd )
+   {
+      std::string text;
+      char chunk[256];
+      ssize_t n;
+      while( ( n = recv( fd, chunk, sizeof(chunk), 0 ) ) > 0 )
+         text.append( chunk, size_t(n) );
+      return text;
+   }
+
+   bool Exists( const char* path )
+   {
+      struct stat info;
+      return lstat( path, &info ) == 0;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestRoundTrip
+   //
+   //    The lines reach the handler without their ends of line, including
+   //    a last line without one, and the replies reach the client.  The
+   //    socket file is removed when the server stops.
+   //--------------------------------------------------------------------------
+   bool TestRoundTrip()
+   {
+      std::atomic<bool> stop( false );
+      bool served = false;
+      std::thread server( [&]
+      {
+         served = ServeUnixSocket( PATH, []( Connection& connection )
+         {
+            std::string line;
+            while( connection.ReadLine( line ) )
+               connection.Write( "<" + line + ">\n" );
+         }, stop );
+      });
+
+      bool flag = true;
+      int fd = Connect();
+      flag &= CHECK( fd >= 0 );
+      if( fd >= 0 )
+      {
+         const std::string request = "radius 50\r\n\nrun";
+         flag &= CHECK( send( fd, request.data(), request.size(), 0 ) == ssize_t( request.size() ) );
+         shutdown( fd, SHUT_WR );
+         flag &= CHECK( ReadAll( fd ) == "<radius 50>\n<>\n<run>\n" );
+         close( fd );
+      }
+
+      stop = true;
+      server.join();
+
+      flag &= CHECK( served );
+      flag &= CHECK( !Exists( PATH ) );
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestStopIdle
+   //
+   //    A client that sends nothing does not keep the server from stopping.
+   //--------------------------------------------------------------------------
+   bool TestStopIdle()
+   {
+      std::atomic<bool> stop( false );
+      std::atomic<bool> started( false );
+      std::thread server( [&]
+      {
+         ServeUnixSocket( PATH, [&]( Connection& connection )
+         {
+            started = true;
+            std::string line;
+            while( connection.ReadLine( line ) )
+               ;
+         }, stop );
+      });
+
+      bool flag = true;
+      int fd = Connect();
+      flag &= CHECK( fd >= 0 );
+      for( int wait=0; wait<100 && !started; ++wait )
+         std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+      flag &= CHECK( started );
+
+      stop = true;
+      server.join();
+
+      if( fd >= 0 )
+      {
+         flag &= CHECK( ReadAll( fd ).empty() );
+         close( fd );
+      }
+      return flag;
+   }
+#else
+   //--------------------------------------------------------------------------
+   // TestUnsupported
+   //--------------------------------------------------------------------------
+   bool TestUnsupported()
+   {
+      std::atomic<bool> stop( true );
+      return CHECK( !ServeUnixSocket( "aakozi_test.sock", []( Connection& ){}, stop ) );
+   }
+#endif
+}
+
+
+//-----------------------------------------------------------------------------
+// test_UnixSocket
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_UnixSocket()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+#ifdef TEST_UNIX_SOCKET
+   TALLY( TestRoundTrip() );
+   TALLY( TestStopIdle() );
+#else
+   TALLY( TestUnsupported() );
+#endif
+
+   return std::make_pair( nsucc, nfail );
+}
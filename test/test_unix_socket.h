@@ -0,0 +1,21 @@
+//=============================================================================
+// test_unix_socket.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_UNIX_SOCKET_H
+#define TEST_UNIX_SOCKET_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_UnixSocket();
+
+//=============================================================================
+#endif  // TEST_UNIX_SOCKET_H
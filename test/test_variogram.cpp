@@ -0,0 +1,231 @@
+//=============================================================================
+// test_variogram.cpp
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#include "test_variogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "unit_test.h"
+#include "..\src\distance.h"
+#include "..\src\variogram.h"
+
+//-----------------------------------------------------------------------------
+// Hide all of the testing details inside an unnamed namespace. This allows me
+// to create many small unit tests with polluting the global namespace.
+//-----------------------------------------------------------------------------
+namespace{
+   const double TOLERANCE = 1e-9;
+
+   //--------------------------------------------------------------------------
+   // Example data.
+   //--------------------------------------------------------------------------
+   void ExampleData( int n, std::vector<double>& x, std::vector<double>& y, std::vector<double>& z )
+   {
+      for( int i=0; i<n; ++i )
+      {
+         x.push_back( 1000.0 + 500.0*sin(1.3*i) + 3.0*i );
+         y.push_back( 2000.0 + 400.0*cos(2.1*i) - 2.0*i );
+         z.push_back( 50.0 + 0.01*x.back() + 5.0*sin(0.7*i) );
+      }
+   }
+
+   //--------------------------------------------------------------------------
+   // BruteForce
+   //
+   //    The obvious double loop over all of the pairs.
+   //--------------------------------------------------------------------------
+   std::vector<VariogramBin> BruteForce( const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, int nbins, double maxlag )
+   {
+      const int N = x.size();
+      std::vector<double> lag(nbins, 0.0), gamma(nbins, 0.0);
+      std::vector<long long> count(nbins, 0);
+
+      for( int i=0; i<N; ++i )
+      {
+         for( int j=i+1; j<N; ++j )
+         {
+            double d = hypot( x[i]-x[j], y[i]-y[j] );
+            if( d > maxlag ) continue;
+
+            int b = std::min( int(d/(maxlag/nbins)), nbins-1 );
+            lag[b]   += d;
+            gamma[b] += 0.5*(z[i]-z[j])*(z[i]-z[j]);
+            ++count[b];
+         }
+      }
+
+      std::vector<VariogramBin> bins(nbins);
+      for( int b=0; b<nbins; ++b )
+      {
+         bins[b].count = count[b];
+         bins[b].lag   = count[b] > 0 ? lag[b]/count[b] : 0.0;
+         bins[b].gamma = count[b] > 0 ? gamma[b]/count[b] : 0.0;
+      }
+      return bins;
+   }
+
+   //--------------------------------------------------------------------------
+   // Same
+   //--------------------------------------------------------------------------
+   bool Same( const std::vector<VariogramBin>& A, const std::vector<VariogramBin>& B )
+   {
+      bool flag = CHECK( A.size() == B.size() );
+      for( unsigned b=0; flag && b<A.size(); ++b )
+      {
+         flag &= CHECK( A[b].count == B[b].count );
+         if( A[b].count > 0 )
+         {
+            flag &= CHECK( isClose(A[b].lag, B[b].lag, 1e-6) );
+            flag &= CHECK( isClose(A[b].gamma, B[b].gamma, 1e-6) );
+         }
+      }
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestDistances
+   //--------------------------------------------------------------------------
+   bool TestDistances()
+   {
+      const double x[] = { 3, 0, -1, 7, 2.5 };
+      const double y[] = { 4, 0, -1, 1, -3.5 };
+      double d[5];
+
+      Distances( 0.0, 0.0, x, y, 5, d );
+
+      bool flag = true;
+      for( int i=0; i<5; ++i )
+         flag &= CHECK( isClose(d[i], hypot(x[i], y[i]), TOLERANCE) );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestDistancesExact
+   //
+   //    Whichever instruction set is used, every distance, including those
+   //    in the tail, is bit for bit the scalar distance.
+   //--------------------------------------------------------------------------
+   bool TestDistancesExact()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( 40, x, y, z );
+
+      bool flag = true;
+      for( int n=0; n<=40; ++n )
+      {
+         std::vector<double> d( n+1, -1.0 );
+         Distances( x[0], y[0], x.data(), y.data(), n, d.data() );
+
+         bool same = ( d[n] == -1.0 );
+         for( int i=0; i<n; ++i )
+         {
+            double dx = x[i] - x[0];
+            double dy = y[i] - y[0];
+            same &= ( d[i] == sqrt( dx*dx + dy*dy ) );
+         }
+         flag &= CHECK( same );
+      }
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestFloatDistancesExact
+   //
+   //    The same for the single precision kernel.
+   //--------------------------------------------------------------------------
+   bool TestFloatDistancesExact()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( 40, x, y, z );
+
+      std::vector<float> xf( x.begin(), x.end() );
+      std::vector<float> yf( y.begin(), y.end() );
+
+      bool flag = true;
+      for( int n=0; n<=40; ++n )
+      {
+         std::vector<float> d( n+1, -1.0f );
+         Distances( xf[0], yf[0], xf.data(), yf.data(), n, d.data() );
+
+         bool same = ( d[n] == -1.0f );
+         for( int i=0; i<n; ++i )
+         {
+            float dx = xf[i] - xf[0];
+            float dy = yf[i] - yf[0];
+            same &= ( d[i] == std::sqrt( dx*dx + dy*dy ) );
+         }
+         flag &= CHECK( same );
+      }
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestAllPairs
+   //--------------------------------------------------------------------------
+   bool TestAllPairs()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( 300, x, y, z );
+
+      std::vector<VariogramBin> A = EmpiricalVariogram( x, y, z, 12, 0.0, 3 );
+
+      // The bins span the diagonal of the bounding box.
+      double Lx = *std::max_element(x.begin(), x.end()) - *std::min_element(x.begin(), x.end());
+      double Ly = *std::max_element(y.begin(), y.end()) - *std::min_element(y.begin(), y.end());
+      std::vector<VariogramBin> B = BruteForce( x, y, z, 12, hypot(Lx, Ly) );
+
+      long long total = 0;
+      for( auto& bin : A )
+         total += bin.count;
+
+      bool flag = true;
+
+      flag &= CHECK( total == 300*299/2 );
+      flag &= Same( A, B );
+
+      return flag;
+   }
+
+   //--------------------------------------------------------------------------
+   // TestMaxLag
+   //--------------------------------------------------------------------------
+   bool TestMaxLag()
+   {
+      std::vector<double> x, y, z;
+      ExampleData( 500, x, y, z );
+
+      std::vector<VariogramBin> A = EmpiricalVariogram( x, y, z, 10, 150.0, 2 );
+      std::vector<VariogramBin> B = BruteForce( x, y, z, 10, 150.0 );
+
+      return Same( A, B );
+   }
+}
+
+
+//-----------------------------------------------------------------------------
+// test_Variogram
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Variogram()
+{
+   int nsucc = 0;
+   int nfail = 0;
+
+   TALLY( TestDistances() );
+   TALLY( TestDistancesExact() );
+   TALLY( TestFloatDistancesExact() );
+   TALLY( TestAllPairs() );
+   TALLY( TestMaxLag() );
+
+   return std::make_pair( nsucc, nfail );
+}
@@ -0,0 +1,21 @@
+//=============================================================================
+// test_variogram.h
+//
+// author:
+//    Dr. Randal J. Barnes
+//    Department of Civil, Environmental, and Geo- Engineering
+//    University of Minnesota
+//
+// version:
+//    11 June 2017
+//=============================================================================
+#ifndef TEST_VARIOGRAM_H
+#define TEST_VARIOGRAM_H
+
+#include <utility>
+
+//-----------------------------------------------------------------------------
+std::pair<int,int> test_Variogram();
+
+//=============================================================================
+#endif  // TEST_VARIOGRAM_H